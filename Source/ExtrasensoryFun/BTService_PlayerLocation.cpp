@@ -5,6 +5,9 @@
 #include "BehaviorTree/BlackboardComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/Pawn.h"
+#include "ExtrasensoryFunStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Player Location Service"), STAT_PlayerLocationService, STATGROUP_ExtrasensoryFun);
 
 // Default constructor
 UBTService_PlayerLocation::UBTService_PlayerLocation() {
@@ -12,6 +15,7 @@ UBTService_PlayerLocation::UBTService_PlayerLocation() {
 }
 
 void UBTService_PlayerLocation::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) {
+	EF_SCOPE_CYCLE_COUNTER(STAT_PlayerLocationService);
 	Super::TickNode(OwnerComp, NodeMemory, DeltaSeconds);
 	// Get player pawn
 	if (APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(GetWorld(), 0)) {
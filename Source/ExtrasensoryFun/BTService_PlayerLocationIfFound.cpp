@@ -6,6 +6,9 @@
 #include "BehaviorTree/BlackboardComponent.h"
 #include "GameFramework/Pawn.h"
 #include "AIController.h"
+#include "ExtrasensoryFunStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Player Location If Found Service"), STAT_PlayerLocationIfFoundService, STATGROUP_ExtrasensoryFun);
 
 // Default constructor
 UBTService_PlayerLocationIfFound::UBTService_PlayerLocationIfFound() {
@@ -13,6 +16,7 @@ UBTService_PlayerLocationIfFound::UBTService_PlayerLocationIfFound() {
 }
 
 void UBTService_PlayerLocationIfFound::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) {
+	EF_SCOPE_CYCLE_COUNTER(STAT_PlayerLocationIfFoundService);
 	Super::TickNode(OwnerComp, NodeMemory, DeltaSeconds);
 	
 	if (OwnerComp.GetAIOwner()) {
@@ -20,6 +24,7 @@ void UBTService_PlayerLocationIfFound::TickNode(UBehaviorTreeComponent& OwnerCom
 		// Otherwise, clear blackboard value
 		if (APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(GetWorld(), 0)) {
 			// If the player pawn is within the AI's line of sight, set the location of the player for the AI to move to.
+			EF_INC_FRAME_COUNTER(STAT_LineOfSightTraces, LineOfSightTraces);
 			if (OwnerComp.GetAIOwner()->LineOfSightTo(PlayerPawn)) {
 				OwnerComp.GetBlackboardComponent()->SetValueAsObject(GetSelectedBlackboardKey(), PlayerPawn);
 			} else {
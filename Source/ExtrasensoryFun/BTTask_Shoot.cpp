@@ -4,6 +4,7 @@
 #include "BTTask_Shoot.h"
 #include "AIController.h"
 #include "ShooterCharacter.h"
+#include "FireTokenSubsystem.h"
 
 // Default constructor
 UBTTask_Shoot::UBTTask_Shoot() {
@@ -18,6 +19,11 @@ EBTNodeResult::Type UBTTask_Shoot::ExecuteTask(UBehaviorTreeComponent& OwnerComp
 	if (OwnerComp.GetAIOwner()) {
 		// Check if OwnerComp is a ShooterCharacter
 		if (AShooterCharacter* Character = Cast<AShooterCharacter>(OwnerComp.GetAIOwner()->GetPawn())) {
+			// Only shoot if the squad has a fire token left, otherwise fail and let the tree try again later
+			UFireTokenSubsystem* FireTokens = GetWorld()->GetSubsystem<UFireTokenSubsystem>();
+			if (FireTokens && !FireTokens->RequestFireToken(Character)) {
+				return EBTNodeResult::Failed;
+			}
 			// Shoot player after getting within the acceptable amount of distance.
 			Character->Shoot();
 			return EBTNodeResult::Succeeded;
@@ -11,6 +11,11 @@
 #include "Engine/StaticMeshActor.h"
 #include "Blueprint/UserWidget.h"
 #include <Kismet/GameplayStatics.h>
+#include "ExtrasensoryFunStats.h"
+#include "SoftAssets.h"
+
+DECLARE_CYCLE_STAT(TEXT("Base Character Tick"), STAT_BaseCharacterTick, STATGROUP_ExtrasensoryFun);
+DECLARE_CYCLE_STAT(TEXT("Target Lock-on"), STAT_TargetLockOn, STATGROUP_ExtrasensoryFun);
 
 // Default constructor
 ABaseCharacter::ABaseCharacter() {
@@ -46,6 +51,9 @@ ABaseCharacter::ABaseCharacter() {
 // Called when the game starts or when spawned
 void ABaseCharacter::BeginPlay() {
 	Super::BeginPlay();
+
+	// Sounds and FX load in the background if the menu didn't preload them
+	SoftAssets::RequestSoftReferences(this);
 }
 
 // Character jump
@@ -53,8 +61,8 @@ void ABaseCharacter::Jump() {
 	Super::Jump();
 
 	// Player sound fx
-	if (JumpingSound && !GetCharacterMovement()->IsFalling()) {
-		UGameplayStatics::PlaySoundAtLocation(this, JumpingSound, GetActorLocation());
+	if (!JumpingSound.IsNull() && !GetCharacterMovement()->IsFalling()) {
+		UGameplayStatics::PlaySoundAtLocation(this, SoftAssets::Get(JumpingSound), GetActorLocation());
 	}
 }
 
@@ -65,6 +73,7 @@ FVector ABaseCharacter::PositionFromChar(UPrimitiveComponent* Component) const {
 
 // Called every frame
 void ABaseCharacter::Tick(float DeltaTime) {
+	EF_SCOPE_CYCLE_COUNTER(STAT_BaseCharacterTick);
 	Super::Tick(DeltaTime);
 
 	/**
@@ -79,7 +88,8 @@ void ABaseCharacter::Tick(float DeltaTime) {
 		TargetArrow->SetActorLocation(Target.GetActor()->GetActorLocation() + FVector(0.f, 0.f, 90.f));
 		TargetArrow->AddActorLocalRotation(FRotator(0.f, 5.f, 0.f));
 	} else {
-		if (Target.GetActor()) {
+		// The hit stays blocking after its actor is destroyed, so those targets get reset too
+		if (Target.bBlockingHit) {
 			ResetTargeting();
 		}
 		SpringArm->SetRelativeLocation(FVector(0.f, 0.f, 90.f));
@@ -94,8 +104,8 @@ void ABaseCharacter::Tick(float DeltaTime) {
 		// Timer for FootstepSound changes depending on character's speed
 		FootstepTimer -= GetWorld()->GetDeltaSeconds() / MaxWalkSpeed * FMath::Clamp((FMath::Abs(RelativeVelocity.X) + FMath::Abs(RelativeVelocity.Y)), 0, MaxWalkSpeed);
 		// If there's a FootstepSound and FootstepTimer reaches 0, play FootstepSound and reset FootstepTimer
-		if (FootstepSound && (FootstepTimer <= 0)) {
-			UGameplayStatics::PlaySoundAtLocation(this, FootstepSound, GetActorLocation());
+		if (!FootstepSound.IsNull() && (FootstepTimer <= 0)) {
+			UGameplayStatics::PlaySoundAtLocation(this, SoftAssets::Get(FootstepSound), GetActorLocation());
 			FootstepTimer = FootstepTime;
 		}
 	} else {
@@ -130,15 +140,32 @@ void ABaseCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCompo
 // Handle character death
 void ABaseCharacter::HandleDeath() {
 	// Play death sound
-	if (DeathSound) {
-		UGameplayStatics::PlaySoundAtLocation(this, DeathSound, GetActorLocation());
+	if (!DeathSound.IsNull()) {
+		UGameplayStatics::PlaySoundAtLocation(this, SoftAssets::Get(DeathSound), GetActorLocation());
 	}
 	// Detach controller
-	DetachFromControllerPendingDestroy();
+	ReleaseControllerOnDeath();
 	// Remove collisions
 	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	// Set collision response to TelekinesisAttack tracing channel to ignore
-	GetMesh()->SetCollisionResponseToChannel(ECC_GameTraceChannel2, ECR_Ignore);
+	// Switch the mesh to the Corpse profile, which ignores the TelekinesisAttack tracing channel
+	LiveMeshCollision = CollisionProfiles::Save(GetMesh());
+	GetMesh()->SetCollisionProfileName(CollisionProfiles::Corpse);
+}
+
+// Undo HandleDeath so the character can be reused
+void ABaseCharacter::Revive() {
+	Health->ResetHealth();
+	// Restore collisions
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+	if (LiveMeshCollision.IsSet()) {
+		CollisionProfiles::Restore(GetMesh(), LiveMeshCollision.GetValue());
+		LiveMeshCollision.Reset();
+	}
+}
+
+// Detach controller when dying
+void ABaseCharacter::ReleaseControllerOnDeath() {
+	DetachFromControllerPendingDestroy();
 }
 
 // Reset character's targeting
@@ -235,16 +262,18 @@ void ABaseCharacter::CenterCameraBehindCharacter() {
 
 // Lock camera on a target that the character is facing
 void ABaseCharacter::TargetLockOn() {
+	EF_SCOPE_CYCLE_COUNTER(STAT_TargetLockOn);
 	// Start by centering the camera behind the character
 	// If no Target locked on, sphere sweep for one
 	// Otherwise, reset target and set camera back to normal
 	if (!Target.GetActor()) {
 		float CapsuleHalfHeight = this->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
 		// + the CapsuleHalfHeight in proportion to how far we aim the camera up or down.
-		FVector Start = GetActorLocation() + GetActorForwardVector() * (800.f + CapsuleHalfHeight);
+		FVector Start = GetActorLocation() + GetActorForwardVector() * (LockOnSweepRadius + CapsuleHalfHeight);
 		FVector End = GetActorLocation() + GetActorForwardVector() * (10000.f + CapsuleHalfHeight);
-		FCollisionShape Sphere = FCollisionShape::MakeSphere(800.f);
+		FCollisionShape Sphere = FCollisionShape::MakeSphere(LockOnSweepRadius);
 		// Sweep with sphere in the TelekinesisAttack channel
+		EF_INC_FRAME_COUNTER(STAT_Sweeps, Sweeps);
 		GetWorld()->SweepSingleByChannel(
 			Target,
 			Start, End,
@@ -262,7 +291,7 @@ void ABaseCharacter::TargetLockOn() {
 			TargetArrow->SetActorEnableCollision(ECollisionEnabled::NoCollision);
 			UStaticMeshComponent* MeshComponent = TargetArrow->GetStaticMeshComponent();
 			if (MeshComponent) {
-				MeshComponent->SetStaticMesh(TargetArrowMesh);
+				MeshComponent->SetStaticMesh(SoftAssets::Get(TargetArrowMesh));
 			}
 		} else {
 			ResetTargeting();
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "CollisionProfiles.h"
 #include "BaseCharacter.generated.h"
 
 class USpringArmComponent;
@@ -41,20 +42,25 @@ protected:
 	UHealthComponent* Health;
 	// Sound components
 	UPROPERTY(EditAnywhere, Category = "Sound FX")
-	class USoundBase* DeathSound;
+	TSoftObjectPtr<class USoundBase> DeathSound;
 	UPROPERTY(EditAnywhere, Category = "Sound FX")
-	USoundBase* FootstepSound;
+	TSoftObjectPtr<USoundBase> FootstepSound;
 	UPROPERTY(EditAnywhere, Category = "Sound FX")
 	float FootstepTime = 0.25f;
 	UPROPERTY(EditAnywhere, Category = "Sound FX")
-	USoundBase* JumpingSound;
+	TSoftObjectPtr<USoundBase> JumpingSound;
 
 	// ----Camera-----
 	FHitResult Target;
 	UPROPERTY(EditAnywhere, Category = "Camera")
 	float LockOnDistanceLimit = 2400.f;
+	// Radius of the lock-on sweep, which starts this far in front of the character
+	static constexpr float LockOnSweepRadius = 800.f;
 	FVector PositionFromChar(UPrimitiveComponent* Component) const;
 	virtual void TargetLockOn(); // virtual since Targetting will have difference effects depending on the character in use
+
+	// Let go of the controller when dying, virtual since pooled characters keep theirs
+	virtual void ReleaseControllerOnDeath();
 	
 public:
 	// Called every frame
@@ -63,18 +69,21 @@ public:
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
 	// Handle character death
-	void HandleDeath();
+	virtual void HandleDeath();
+	// Undo HandleDeath so the character can be reused
+	virtual void Revive();
 
-	// Reset targeting for player
-	void ResetTargeting();
+	// Reset targeting for player, virtual so characters can react to losing their target
+	virtual void ResetTargeting();
 
 	// -----Setter Methods-----
 	UFUNCTION(BlueprintCallable)
-	void SetFootstepSound(USoundBase* NewFootstepSound) { FootstepSound = NewFootstepSound; }
+	void SetFootstepSound(const TSoftObjectPtr<USoundBase>& NewFootstepSound) { FootstepSound = NewFootstepSound; }
 
 	// -----Getter methods-----
 	USpringArmComponent* GetSpringArm() const { return SpringArm; }
 	UCameraComponent* GetCamera() const { return Camera; }
+	UHealthComponent* GetHealthComponent() const { return Health; }
 	UFUNCTION(BlueprintPure)
 	FHitResult GetTarget() const { return Target; }
 
@@ -91,9 +100,12 @@ private:
 	void ZoomCameraRate(float AxisValue);
 	void CenterCameraBehindCharacter();
 	UPROPERTY(EditAnywhere)
-	UStaticMesh* TargetArrowMesh;
+	TSoftObjectPtr<UStaticMesh> TargetArrowMesh;
 	AStaticMeshActor* TargetArrow;
 
+	// Mesh collision settings from before death, for Revive
+	TOptional<CollisionProfiles::FSavedCollision> LiveMeshCollision;
+
 	// Footstep timer
 	float FootstepTimer = 0.f;
 };
\ No newline at end of file
@@ -0,0 +1,236 @@
+// by Jason Hilani
+
+
+#include "CellStreamingSubsystem.h"
+#include "StreamingCell.h"
+#include "ESPCharacter.h"
+#include "PhysicsActivitySubsystem.h"
+#include "PropNavigationSubsystem.h"
+#include "ThrownObjectSubsystem.h"
+#include "LevelResetSubsystem.h"
+#include "Engine/Level.h"
+#include "EngineUtils.h"
+#include "ExtrasensoryFunStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Cell Streaming Update"), STAT_CellStreamingUpdate, STATGROUP_ExtrasensoryFun);
+DECLARE_CYCLE_STAT(TEXT("Cell Register Actors"), STAT_CellRegisterActors, STATGROUP_ExtrasensoryFun);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Visible Cells"), STAT_VisibleCells, STATGROUP_ExtrasensoryFun);
+
+static TAutoConsoleVariable<int32> CVarCellStreaming(
+	TEXT("ef.Streaming.Enabled"),
+	1,
+	TEXT("Stream cells around the ESP characters. When 0, every cell is loaded and stays loaded, like a single persistent level."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarLoadDistance(
+	TEXT("ef.Streaming.LoadDistance"),
+	6000.f,
+	TEXT("Distance from an ESP character to a cell's bounds under which the cell gets loaded."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarUnloadDistance(
+	TEXT("ef.Streaming.UnloadDistance"),
+	8000.f,
+	TEXT("Distance from every ESP character to a cell's bounds past which the cell gets unloaded. Above LoadDistance so cells don't flicker."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarStreamingInterval(
+	TEXT("ef.Streaming.UpdateInterval"),
+	0.25f,
+	TEXT("Seconds between two streaming updates."),
+	ECVF_Default
+);
+
+// Gather the cells and follow their levels being shown and hidden
+void UCellStreamingSubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+	Super::OnWorldBeginPlay(InWorld);
+	for (TActorIterator<AStreamingCell> It(&InWorld); It; ++It) {
+		Cells.Add(*It);
+	}
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UCellStreamingSubsystem::OnLevelAdded);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UCellStreamingSubsystem::OnLevelRemoved);
+	// Load what's around the players right away
+	Update();
+}
+
+void UCellStreamingSubsystem::Deinitialize() {
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+	Super::Deinitialize();
+}
+
+void UCellStreamingSubsystem::Tick(float DeltaTime) {
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Cells.Num() > 0 && Now - LastUpdateTime >= CVarStreamingInterval.GetValueOnGameThread()) {
+		LastUpdateTime = Now;
+		Update();
+	}
+}
+
+/**
+* Load the cells near an ESP character and unload the ones far from all of them.
+* Clients only stream around their own character, the server and standalone games around everyone's.
+*/
+void UCellStreamingSubsystem::Update() {
+	EF_SCOPE_CYCLE_COUNTER(STAT_CellStreamingUpdate);
+	const bool bEnabled = CVarCellStreaming.GetValueOnGameThread() != 0;
+	const float LoadDistanceSquared = FMath::Square(CVarLoadDistance.GetValueOnGameThread());
+	const float UnloadDistanceSquared = FMath::Square(FMath::Max(CVarUnloadDistance.GetValueOnGameThread(), CVarLoadDistance.GetValueOnGameThread()));
+
+	TArray<FVector, TInlineAllocator<4>> ViewerLocations;
+	const bool bClient = GetWorld()->GetNetMode() == NM_Client;
+	for (TActorIterator<AESPCharacter> It(GetWorld()); It; ++It) {
+		if (!bClient || It->IsLocallyControlled()) {
+			ViewerLocations.Add(It->GetActorLocation());
+		}
+	}
+
+	for (int32 i = Cells.Num() - 1; i >= 0; i--) {
+		AStreamingCell* Cell = Cells[i].Get();
+		if (!Cell) {
+			Cells.RemoveAtSwap(i);
+			continue;
+		}
+		const FBox CellBounds = Cell->GetCellBounds();
+		float DistanceSquared = MAX_flt;
+		for (const FVector& ViewerLocation : ViewerLocations) {
+			DistanceSquared = FMath::Min(DistanceSquared, (float)CellBounds.ComputeSquaredDistanceToPoint(ViewerLocation));
+		}
+
+		if (!Cell->WantsLoaded() && (!bEnabled || DistanceSquared <= LoadDistanceSquared)) {
+			Cell->Load();
+			Loads++;
+		} else if (Cell->WantsLoaded() && bEnabled && DistanceSquared > UnloadDistanceSquared) {
+			if (IsPinned(Cell->GetLoadedLevel())) {
+				PinnedUnloads++;
+				continue;
+			}
+			Cell->Unload();
+			Unloads++;
+		}
+	}
+	const int32 VisibleCells = GetNumVisibleCells();
+	SET_DWORD_STAT(STAT_VisibleCells, VisibleCells);
+	CSV_CUSTOM_STAT(ExtrasensoryFun, VisibleCells, VisibleCells, ECsvCustomStatOp::Set);
+}
+
+// Whether one of the level's props is held or flying, unloading it would pull it out of a character's hands or out of the air
+bool UCellStreamingSubsystem::IsPinned(const ULevel* Level) const {
+	if (!Level) return false;
+	const UThrownObjectSubsystem* ThrownObjects = GetWorld()->GetSubsystem<UThrownObjectSubsystem>();
+	for (const AActor* Actor : Level->Actors) {
+		if (!Actor) continue;
+		if (Actor->ActorHasTag("Grabbed")) return true;
+		const UPrimitiveComponent* Component = Cast<UPrimitiveComponent>(Actor->GetRootComponent());
+		if (Component && ThrownObjects && ThrownObjects->IsTracked(Component)) return true;
+	}
+	return false;
+}
+
+int32 UCellStreamingSubsystem::GetNumVisibleCells() const {
+	int32 VisibleCells = 0;
+	for (const TWeakObjectPtr<AStreamingCell>& Cell : Cells) {
+		VisibleCells += Cell.IsValid() && Cell->IsVisible() ? 1 : 0;
+	}
+	return VisibleCells;
+}
+
+AStreamingCell* UCellStreamingSubsystem::FindCell(const ULevel* Level) const {
+	for (const TWeakObjectPtr<AStreamingCell>& Cell : Cells) {
+		if (Cell.IsValid() && Level && Cell->GetLoadedLevel() == Level) {
+			return Cell.Get();
+		}
+	}
+	return nullptr;
+}
+
+// A cell is visible, add its actors to the level reset snapshot
+void UCellStreamingSubsystem::OnLevelAdded(ULevel* Level, UWorld* World) {
+	if (World != GetWorld()) return;
+	AStreamingCell* Cell = FindCell(Level);
+	if (!Cell) return;
+	EF_SCOPE_CYCLE_COUNTER(STAT_CellRegisterActors);
+
+	const double LoadSeconds = FPlatformTime::Seconds() - Cell->GetLoadRequestTime();
+	TotalLoadSeconds += LoadSeconds;
+	WorstLoadSeconds = FMath::Max(WorstLoadSeconds, LoadSeconds);
+
+	ULevelResetSubsystem* LevelReset = World->GetSubsystem<ULevelResetSubsystem>();
+	if (LevelReset && LevelReset->HasSnapshot()) {
+		RegisteredActors += LevelReset->CaptureLevel(Level);
+	}
+}
+
+/**
+* A cell is hidden, take its actors out of every system that keeps track of props or characters.
+* The actors are still around until the level gets garbage collected, so they can still be looked up.
+*/
+void UCellStreamingSubsystem::OnLevelRemoved(ULevel* Level, UWorld* World) {
+	if (World != GetWorld() || !FindCell(Level)) return;
+	EF_SCOPE_CYCLE_COUNTER(STAT_CellRegisterActors);
+
+	UPhysicsActivitySubsystem* PhysicsActivity = World->GetSubsystem<UPhysicsActivitySubsystem>();
+	UPropNavigationSubsystem* PropNavigation = World->GetSubsystem<UPropNavigationSubsystem>();
+	UThrownObjectSubsystem* ThrownObjects = World->GetSubsystem<UThrownObjectSubsystem>();
+	for (AActor* Actor : Level->Actors) {
+		UPrimitiveComponent* Component = Actor ? Cast<UPrimitiveComponent>(Actor->GetRootComponent()) : nullptr;
+		if (!Component) continue;
+		if (PhysicsActivity) {
+			PhysicsActivity->UnregisterProp(Component);
+		}
+		if (PropNavigation) {
+			PropNavigation->UnregisterProp(Component);
+		}
+		if (ThrownObjects) {
+			ThrownObjects->StopTracking(Component);
+		}
+	}
+	if (ULevelResetSubsystem* LevelReset = World->GetSubsystem<ULevelResetSubsystem>()) {
+		UnregisteredActors += LevelReset->ForgetLevel(Level);
+	}
+}
+
+TStatId UCellStreamingSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCellStreamingSubsystem, STATGROUP_Tickables);
+}
+
+// Log the stats
+void UCellStreamingSubsystem::DumpStats() const {
+	const int32 Shown = FMath::Max(Loads, 1);
+	UE_LOG(LogTemp, Display, TEXT("Cell streaming: %d cells, %d visible. %d loads, %d unloads, %d unloads delayed by held props. Load to visible %.1f ms average, %.1f ms worst. %d actors registered, %d unregistered"),
+		Cells.Num(), GetNumVisibleCells(), Loads, Unloads, PinnedUnloads, TotalLoadSeconds * 1000.0 / Shown, WorstLoadSeconds * 1000.0, RegisteredActors, UnregisteredActors);
+}
+
+void UCellStreamingSubsystem::ResetStats() {
+	Loads = 0;
+	Unloads = 0;
+	PinnedUnloads = 0;
+	TotalLoadSeconds = 0.0;
+	WorstLoadSeconds = 0.0;
+	RegisteredActors = 0;
+	UnregisteredActors = 0;
+}
+
+// Console commands to read and reset the stats
+static FAutoConsoleCommandWithWorld CellStreamingStatsCommand(
+	TEXT("ef.Streaming.Stats"),
+	TEXT("Logs the cell loads and unloads, their load times and the actors registered and unregistered with them."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World) {
+		if (UCellStreamingSubsystem* CellStreaming = World->GetSubsystem<UCellStreamingSubsystem>()) {
+			CellStreaming->DumpStats();
+		}
+	})
+);
+
+static FAutoConsoleCommandWithWorld CellStreamingStatsResetCommand(
+	TEXT("ef.Streaming.StatsReset"),
+	TEXT("Resets the cell streaming stats."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World) {
+		if (UCellStreamingSubsystem* CellStreaming = World->GetSubsystem<UCellStreamingSubsystem>()) {
+			CellStreaming->ResetStats();
+		}
+	})
+);
@@ -0,0 +1,58 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CellStreamingSubsystem.generated.h"
+
+class AStreamingCell;
+
+/**
+ * Streams the level's cells in and out around the ESP characters.
+ * Cells within ef.Streaming.LoadDistance of a character are loaded asynchronously, and unloaded past ef.Streaming.UnloadDistance.
+ * A cell holding a grabbed or flying prop stays loaded until it's been dropped.
+ * When a cell's level is shown its props and characters are added to the level reset snapshot, and when it's hidden
+ * its actors are taken out of the game's other systems (physics activity, prop navigation, thrown objects, level reset)
+ * so none of them keep entries for unloaded actors.
+ * Also measures the time from load request to visible, for the perf harness.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API UCellStreamingSubsystem : public UTickableWorldSubsystem {
+	GENERATED_BODY()
+
+public:
+	const TArray<TWeakObjectPtr<AStreamingCell>>& GetCells() const { return Cells; }
+	int32 GetNumVisibleCells() const;
+
+	// Log and reset the stats
+	void DumpStats() const;
+	void ResetStats();
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	TArray<TWeakObjectPtr<AStreamingCell>> Cells;
+	double LastUpdateTime = 0.0;
+	void Update();
+	// Whether one of the level's props is held or flying
+	bool IsPinned(const ULevel* Level) const;
+
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+	void OnLevelAdded(ULevel* Level, UWorld* World);
+	void OnLevelRemoved(ULevel* Level, UWorld* World);
+	AStreamingCell* FindCell(const ULevel* Level) const;
+
+	// -----Stats-----
+	int32 Loads = 0;
+	int32 Unloads = 0;
+	int32 PinnedUnloads = 0;
+	double TotalLoadSeconds = 0.0;
+	double WorstLoadSeconds = 0.0;
+	int32 RegisteredActors = 0;
+	int32 UnregisteredActors = 0;
+};
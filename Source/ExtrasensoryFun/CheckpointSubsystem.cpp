@@ -0,0 +1,345 @@
+// by Jason Hilani
+
+
+#include "CheckpointSubsystem.h"
+#include "ESPCharacter.h"
+#include "ShooterCharacter.h"
+#include "ShooterHorde.h"
+#include "HealthComponent.h"
+#include "AIController.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Async/Async.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "EngineUtils.h"
+
+// On-disk layout of a checkpoint: a header, then the prop records, then the character records
+namespace CheckpointFormat {
+	constexpr uint32 Magic = 0x50434645; // "EFCP"
+	constexpr uint16 Version = 1;
+	// Positions are stored in eighths of a centimeter
+	constexpr double PositionScale = 8.0;
+
+	struct FHeader {
+		uint32 Magic;
+		uint16 Version;
+		uint16 Reserved;
+		uint32 NumProps;
+		uint32 NumCharacters;
+	};
+	static_assert(sizeof(FHeader) == 16, "Checkpoint header layout changed, bump the version");
+
+	enum EPropFlags : uint8 {
+		PropSimulating = 1 << 0,
+		PropGravity = 1 << 1,
+		PropGrabbed = 1 << 2
+	};
+
+	struct FPropRecord {
+		uint32 Id;
+		int32 Position[3];
+		// Normalized quaternion components
+		int16 Rotation[4];
+		// cm/s and degrees/s
+		int16 LinearVelocity[3];
+		int16 AngularVelocity[3];
+		uint8 Flags;
+		uint8 Padding[3];
+	};
+	static_assert(sizeof(FPropRecord) == 40, "Checkpoint prop layout changed, bump the version");
+
+	enum ECharacterFlags : uint8 {
+		CharacterDead = 1 << 0,
+		CharacterHasStartLocation = 1 << 1
+	};
+
+	struct FCharacterRecord {
+		uint32 Id;
+		int32 Position[3];
+		// Blackboard StartLocation for AI characters
+		int32 StartLocation[3];
+		// Yaw in 1/65536ths of a turn, health as a fraction of max health
+		uint16 Yaw;
+		uint16 Health;
+		uint8 Flags;
+		uint8 Padding[3];
+	};
+	static_assert(sizeof(FCharacterRecord) == 36, "Checkpoint character layout changed, bump the version");
+
+	static void QuantizePosition(const FVector& Position, int32 Out[3]) {
+		for (int32 i = 0; i < 3; i++) {
+			Out[i] = (int32)FMath::Clamp(FMath::RoundToDouble(Position[i] * PositionScale), (double)MIN_int32, (double)MAX_int32);
+		}
+	}
+	static FVector DequantizePosition(const int32 In[3]) {
+		return FVector(In[0], In[1], In[2]) / PositionScale;
+	}
+	static void QuantizeVelocity(const FVector& Velocity, int16 Out[3]) {
+		for (int32 i = 0; i < 3; i++) {
+			Out[i] = (int16)FMath::Clamp(FMath::RoundToInt(Velocity[i]), -MAX_int16, MAX_int16);
+		}
+	}
+	static FVector DequantizeVelocity(const int16 In[3]) {
+		return FVector(In[0], In[1], In[2]);
+	}
+	static void QuantizeRotation(const FQuat& Rotation, int16 Out[4]) {
+		const FQuat Normalized = Rotation.GetNormalized();
+		const double Components[4] = { Normalized.X, Normalized.Y, Normalized.Z, Normalized.W };
+		for (int32 i = 0; i < 4; i++) {
+			Out[i] = (int16)FMath::RoundToInt(FMath::Clamp(Components[i], -1.0, 1.0) * MAX_int16);
+		}
+	}
+	static FQuat DequantizeRotation(const int16 In[4]) {
+		return FQuat(In[0], In[1], In[2], In[3]).GetNormalized();
+	}
+
+	// Stable ID for an actor placed in a level, from its name and its level's name. IDs can collide, see SaveCheckpoint
+	static uint32 GetActorId(const AActor* Actor) {
+		return HashCombine(GetTypeHash(Actor->GetFName()), GetTypeHash(Actor->GetLevel()->GetOuter()->GetFName()));
+	}
+
+	// Characters and grabbable props are checkpointed, except for pooled and horde characters which are transient and owned by their spawners
+	static bool IsCheckpointed(const AActor* Actor) {
+		if (const ABaseCharacter* Character = Cast<ABaseCharacter>(Actor)) {
+			const AShooterCharacter* ShooterCharacter = Cast<AShooterCharacter>(Character);
+			return !ShooterCharacter || (!ShooterCharacter->GetSpawnDirector() && !Cast<AShooterHorde>(ShooterCharacter->GetOwner()));
+		}
+		return AESPCharacter::IsGrabbable(Cast<UPrimitiveComponent>(Actor->GetRootComponent()));
+	}
+}
+
+using namespace CheckpointFormat;
+
+// Gather the world state in one pass and write it asynchronously
+bool UCheckpointSubsystem::SaveCheckpoint(const FString& Name) {
+	const double StartTime = FPlatformTime::Seconds();
+	TArray<FPropRecord> PropRecords;
+	TArray<FCharacterRecord> CharacterRecords;
+	// IDs are 32-bit name hashes, two actors sharing one would restore onto the same actor
+	TMap<uint32, const AActor*> SavedIds;
+
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It) {
+		AActor* Actor = *It;
+		if (!IsCheckpointed(Actor)) continue;
+		const uint32 Id = GetActorId(Actor);
+		if (const AActor* const* Other = SavedIds.Find(Id)) {
+			UE_LOG(LogTemp, Error, TEXT("Checkpoint %s not saved: %s and %s share the ID %08x, rename one of them"), *Name, *(*Other)->GetName(), *Actor->GetName(), Id);
+			return false;
+		}
+		SavedIds.Add(Id, Actor);
+		if (ABaseCharacter* Character = Cast<ABaseCharacter>(Actor)) {
+			FCharacterRecord& Record = CharacterRecords.AddZeroed_GetRef();
+			Record.Id = Id;
+			QuantizePosition(Character->GetActorLocation(), Record.Position);
+			Record.Yaw = FRotator::CompressAxisToShort(Character->GetActorRotation().Yaw);
+			Record.Health = (uint16)FMath::RoundToInt(FMath::Clamp(Character->GetHealthComponent()->GetHealthPercent(), 0.f, 1.f) * MAX_uint16);
+			Record.Flags = Character->GetHealthComponent()->IsDead() ? CharacterDead : 0;
+			if (AAIController* AIController = Cast<AAIController>(Character->GetController())) {
+				if (UBlackboardComponent* Blackboard = AIController->GetBlackboardComponent()) {
+					QuantizePosition(Blackboard->GetValueAsVector(TEXT("StartLocation")), Record.StartLocation);
+					Record.Flags |= CharacterHasStartLocation;
+				}
+			}
+		} else {
+			UPrimitiveComponent* Component = CastChecked<UPrimitiveComponent>(Actor->GetRootComponent());
+			FPropRecord& Record = PropRecords.AddZeroed_GetRef();
+			Record.Id = Id;
+			QuantizePosition(Component->GetComponentLocation(), Record.Position);
+			QuantizeRotation(Component->GetComponentQuat(), Record.Rotation);
+			if (Component->IsSimulatingPhysics()) {
+				Record.Flags |= PropSimulating;
+				QuantizeVelocity(Component->GetPhysicsLinearVelocity(), Record.LinearVelocity);
+				QuantizeVelocity(Component->GetPhysicsAngularVelocityInDegrees(), Record.AngularVelocity);
+			}
+			Record.Flags |= Component->IsGravityEnabled() ? PropGravity : 0;
+			Record.Flags |= Actor->ActorHasTag("Grabbed") ? PropGrabbed : 0;
+		}
+	}
+
+	if (PropRecords.Num() + CharacterRecords.Num() == 0) {
+		UE_LOG(LogTemp, Warning, TEXT("Checkpoint %s not saved: nothing to save"), *Name);
+		return false;
+	}
+
+	FHeader Header;
+	Header.Magic = CheckpointFormat::Magic;
+	Header.Version = CheckpointFormat::Version;
+	Header.Reserved = 0;
+	Header.NumProps = PropRecords.Num();
+	Header.NumCharacters = CharacterRecords.Num();
+
+	const int32 PropBytes = PropRecords.Num() * sizeof(FPropRecord);
+	const int32 CharacterBytes = CharacterRecords.Num() * sizeof(FCharacterRecord);
+	TArray<uint8> Bytes;
+	Bytes.SetNumUninitialized(sizeof(FHeader) + PropBytes + CharacterBytes);
+	FMemory::Memcpy(Bytes.GetData(), &Header, sizeof(FHeader));
+	FMemory::Memcpy(Bytes.GetData() + sizeof(FHeader), PropRecords.GetData(), PropBytes);
+	FMemory::Memcpy(Bytes.GetData() + sizeof(FHeader) + PropBytes, CharacterRecords.GetData(), CharacterBytes);
+
+	// Only one write at a time, so a quick second save can't be overtaken by the first
+	if (PendingWrite.IsValid()) {
+		PendingWrite.Wait();
+	}
+	PendingWrite = Async(EAsyncExecution::ThreadPool, [Bytes = MoveTemp(Bytes), Path = GetCheckpointPath(Name)]() {
+		return FFileHelper::SaveArrayToFile(Bytes, *Path);
+	});
+
+	UE_LOG(LogTemp, Display, TEXT("Checkpoint %s: gathered %d props and %d characters (%d bytes) in %.2f ms"),
+		*Name, Header.NumProps, Header.NumCharacters, (int32)sizeof(FHeader) + PropBytes + CharacterBytes, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return true;
+}
+
+// Restore a checkpoint onto the current actors, without spawning any
+bool UCheckpointSubsystem::LoadCheckpoint(const FString& Name) {
+	const double StartTime = FPlatformTime::Seconds();
+	if (PendingWrite.IsValid()) {
+		PendingWrite.Wait();
+	}
+	const FString Path = GetCheckpointPath(Name);
+
+	// Map the file when the platform allows it, otherwise read it into memory
+	TUniquePtr<IMappedFileHandle> MappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TArray<uint8> FileBytes;
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+	if (MappedFile && MappedFile->GetFileSize() > 0) {
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	}
+	if (MappedRegion) {
+		Data = MappedRegion->GetMappedPtr();
+		Size = MappedRegion->GetMappedSize();
+	} else if (FFileHelper::LoadFileToArray(FileBytes, *Path)) {
+		Data = FileBytes.GetData();
+		Size = FileBytes.Num();
+	}
+
+	if (!Data || Size < (int64)sizeof(FHeader)) {
+		UE_LOG(LogTemp, Warning, TEXT("Checkpoint %s not found"), *Name);
+		return false;
+	}
+	FHeader Header;
+	FMemory::Memcpy(&Header, Data, sizeof(FHeader));
+	if (Header.Magic != CheckpointFormat::Magic || Header.Version != CheckpointFormat::Version
+		|| Size != (int64)sizeof(FHeader) + Header.NumProps * sizeof(FPropRecord) + Header.NumCharacters * sizeof(FCharacterRecord)) {
+		UE_LOG(LogTemp, Warning, TEXT("Checkpoint %s is invalid or from another version"), *Name);
+		return false;
+	}
+	const FPropRecord* PropRecords = reinterpret_cast<const FPropRecord*>(Data + sizeof(FHeader));
+	const FCharacterRecord* CharacterRecords = reinterpret_cast<const FCharacterRecord*>(PropRecords + Header.NumProps);
+
+	// Index the current actors in one pass, and drop whatever the player is holding.
+	// An ID shared by two actors (only possible if the world changed since the save) maps to null and isn't restored
+	TMap<uint32, AActor*> ActorsById;
+	ActorsById.Reserve(Header.NumProps + Header.NumCharacters);
+	int32 NumCollisions = 0;
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It) {
+		if (!IsCheckpointed(*It)) continue;
+		AActor*& Indexed = ActorsById.FindOrAdd(GetActorId(*It), *It);
+		if (Indexed != *It) {
+			UE_LOG(LogTemp, Warning, TEXT("Checkpoint %s: %s and %s share an ID, neither is restored"), *Name, Indexed ? *Indexed->GetName() : TEXT("another actor"), *It->GetName());
+			Indexed = nullptr;
+			NumCollisions++;
+		}
+	}
+	AESPCharacter* ESPCharacter = Cast<AESPCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+	if (ESPCharacter) {
+		ESPCharacter->Release();
+	}
+
+	int32 NumMissing = 0;
+	for (uint32 i = 0; i < Header.NumProps; i++) {
+		const FPropRecord& Record = PropRecords[i];
+		AActor* const* Actor = ActorsById.Find(Record.Id);
+		UPrimitiveComponent* Component = Actor && *Actor ? Cast<UPrimitiveComponent>((*Actor)->GetRootComponent()) : nullptr;
+		if (!Component) {
+			NumMissing++;
+			continue;
+		}
+		const bool bSimulating = (Record.Flags & PropSimulating) != 0;
+		Component->SetSimulatePhysics(bSimulating);
+		Component->SetEnableGravity((Record.Flags & PropGravity) != 0);
+		Component->SetWorldLocationAndRotation(DequantizePosition(Record.Position), DequantizeRotation(Record.Rotation), false, nullptr, ETeleportType::ResetPhysics);
+		if (bSimulating) {
+			Component->SetPhysicsLinearVelocity(DequantizeVelocity(Record.LinearVelocity));
+			Component->SetPhysicsAngularVelocityInDegrees(DequantizeVelocity(Record.AngularVelocity));
+		}
+		if ((Record.Flags & PropGrabbed) && ESPCharacter) {
+			ESPCharacter->GrabComponent(Component, Component->GetComponentLocation());
+		}
+	}
+
+	for (uint32 i = 0; i < Header.NumCharacters; i++) {
+		const FCharacterRecord& Record = CharacterRecords[i];
+		AActor* const* Actor = ActorsById.Find(Record.Id);
+		ABaseCharacter* Character = Actor ? Cast<ABaseCharacter>(*Actor) : nullptr;
+		if (!Character) {
+			NumMissing++;
+			continue;
+		}
+		Character->SetActorLocationAndRotation(DequantizePosition(Record.Position), FRotator(0.f, FRotator::DecompressAxisFromShort(Record.Yaw), 0.f), false, nullptr, ETeleportType::TeleportPhysics);
+		UHealthComponent* Health = Character->GetHealthComponent();
+		const bool bDead = (Record.Flags & CharacterDead) != 0;
+		if (bDead && !Health->IsDead() && !Character->IsPlayerControlled()) {
+			Health->SetHealth(0.f);
+			Character->HandleDeath();
+			continue;
+		}
+		if (!bDead) {
+			if (Health->IsDead()) {
+				Character->Revive();
+				if (!Character->GetController() && Cast<AShooterCharacter>(Character)) {
+					Character->SpawnDefaultController();
+				}
+			}
+			Health->SetHealth((float)Record.Health / MAX_uint16 * Health->GetMaxHealth());
+		}
+		if (Record.Flags & CharacterHasStartLocation) {
+			if (AAIController* AIController = Cast<AAIController>(Character->GetController())) {
+				if (UBlackboardComponent* Blackboard = AIController->GetBlackboardComponent()) {
+					Blackboard->SetValueAsVector(TEXT("StartLocation"), DequantizePosition(Record.StartLocation));
+				}
+			}
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Checkpoint %s: restored %d props and %d characters (%d missing, %d ID collisions) in %.2f ms"),
+		*Name, Header.NumProps, Header.NumCharacters, NumMissing, NumCollisions, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return true;
+}
+
+// Make sure the last write lands before the world goes away
+void UCheckpointSubsystem::Deinitialize() {
+	if (PendingWrite.IsValid()) {
+		PendingWrite.Wait();
+	}
+	Super::Deinitialize();
+}
+
+FString UCheckpointSubsystem::GetCheckpointPath(const FString& Name) {
+	return FPaths::ProjectSavedDir() / TEXT("Checkpoints") / Name + TEXT(".efcp");
+}
+
+// Console commands to save and restore checkpoints, both log their timings
+static FAutoConsoleCommandWithWorldAndArgs SaveCheckpointCommand(
+	TEXT("ef.Checkpoint.Save"),
+	TEXT("Saves a world-state checkpoint. Usage: ef.Checkpoint.Save [Name=Quick]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World) {
+		if (UCheckpointSubsystem* Checkpoints = World->GetSubsystem<UCheckpointSubsystem>()) {
+			Checkpoints->SaveCheckpoint(Args.Num() > 0 ? Args[0] : TEXT("Quick"));
+		}
+	})
+);
+
+static FAutoConsoleCommandWithWorldAndArgs LoadCheckpointCommand(
+	TEXT("ef.Checkpoint.Load"),
+	TEXT("Restores a world-state checkpoint. Usage: ef.Checkpoint.Load [Name=Quick]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World) {
+		if (UCheckpointSubsystem* Checkpoints = World->GetSubsystem<UCheckpointSubsystem>()) {
+			Checkpoints->LoadCheckpoint(Args.Num() > 0 ? Args[0] : TEXT("Quick"));
+		}
+	})
+);
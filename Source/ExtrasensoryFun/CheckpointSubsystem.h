@@ -0,0 +1,36 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Async/Future.h"
+#include "CheckpointSubsystem.generated.h"
+
+/**
+ * Saves and restores world-state checkpoints in a compact, versioned binary format.
+ * Grabbable props store quantized transforms, velocities and grab state, characters store position, health
+ * and their AI start location. Saving gathers everything in one pass and writes the file on a worker thread,
+ * restoring reads the file through a memory mapping and applies it to existing actors without spawning any.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API UCheckpointSubsystem : public UWorldSubsystem {
+	GENERATED_BODY()
+
+public:
+	// Gather the world state and write it asynchronously, returns false without writing if there was nothing to save or two actors share an ID
+	bool SaveCheckpoint(const FString& Name);
+	// Restore a checkpoint onto the current actors, returns false if the file is missing or invalid
+	bool LoadCheckpoint(const FString& Name);
+
+	// Whether a checkpoint is still being written
+	bool IsWriting() const { return PendingWrite.IsValid() && !PendingWrite.IsReady(); }
+
+	virtual void Deinitialize() override;
+
+	static FString GetCheckpointPath(const FString& Name);
+
+private:
+	// Write in progress, waited on before loading or shutting down
+	TFuture<bool> PendingWrite;
+};
@@ -0,0 +1,131 @@
+// by Jason Hilani
+
+
+#include "CheckpointSubsystem.h"
+#include "CollisionProfiles.h"
+#include "ShooterCharacter.h"
+#include "Engine/StaticMeshActor.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/AutomationCommon.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace {
+	constexpr int32 NumTestProps = 2000;
+	constexpr int32 NumTestEnemies = 100;
+	constexpr int32 NumTimedRuns = 3;
+	constexpr double BudgetMs = 10.0;
+	const TCHAR* CheckpointTestName = TEXT("AutomationTiming");
+
+	struct FCheckpointTimingData {
+		TArray<TWeakObjectPtr<AActor>> Spawned;
+		TArray<double> SaveMs;
+		TArray<double> LoadMs;
+		// Runs done, the first one is a warm-up and isn't timed
+		int32 Runs = 0;
+	};
+}
+
+// Spawn the props on a grid above the map and the enemies on a ring around them
+DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FSpawnCheckpointActors, FAutomationTestBase*, Test, TSharedRef<FCheckpointTimingData>, Data);
+bool FSpawnCheckpointActors::Update() {
+	UWorld* World = AutomationCommon::GetAnyGameWorld();
+	UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	UClass* EnemyClass = LoadClass<AShooterCharacter>(nullptr, TEXT("/Game/Characters/ShooterCharacter/BP_RocketShooterCharacter.BP_RocketShooterCharacter_C"));
+	if (!Test->TestNotNull(TEXT("Game world"), World) || !Test->TestNotNull(TEXT("Prop mesh"), Cube) || !Test->TestNotNull(TEXT("Enemy class"), EnemyClass)) {
+		return true;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	const int32 GridSize = FMath::CeilToInt(FMath::Sqrt((float)NumTestProps));
+	for (int32 i = 0; i < NumTestProps; i++) {
+		const FVector Location((i % GridSize) * 150.f, (i / GridSize) * 150.f, 2000.f);
+		AStaticMeshActor* Prop = World->SpawnActor<AStaticMeshActor>(Location, FRotator::ZeroRotator, SpawnParams);
+		UStaticMeshComponent* Mesh = Prop->GetStaticMeshComponent();
+		Mesh->SetMobility(EComponentMobility::Movable);
+		Mesh->SetStaticMesh(Cube);
+		Mesh->SetWorldScale3D(FVector(0.5f));
+		Mesh->SetCollisionProfileName(CollisionProfiles::Grabbable);
+		Mesh->SetSimulatePhysics(true);
+		Data->Spawned.Add(Prop);
+	}
+	for (int32 i = 0; i < NumTestEnemies; i++) {
+		const float Angle = 2.f * PI * i / NumTestEnemies;
+		const FVector Location = FVector(GridSize * 75.f, GridSize * 75.f, 300.f) + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * (GridSize * 100.f);
+		if (AShooterCharacter* Enemy = World->SpawnActor<AShooterCharacter>(EnemyClass, Location, FRotator::ZeroRotator, SpawnParams)) {
+			if (!Enemy->GetController()) {
+				Enemy->SpawnDefaultController();
+			}
+			Data->Spawned.Add(Enemy);
+		}
+	}
+	return true;
+}
+
+// Save, wait for the write to land, then restore, a few times over
+DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FTimeCheckpoints, FAutomationTestBase*, Test, TSharedRef<FCheckpointTimingData>, Data);
+bool FTimeCheckpoints::Update() {
+	UWorld* World = AutomationCommon::GetAnyGameWorld();
+	UCheckpointSubsystem* Checkpoints = World ? World->GetSubsystem<UCheckpointSubsystem>() : nullptr;
+	if (!Checkpoints) {
+		Test->AddError(TEXT("No checkpoint subsystem"));
+		return true;
+	}
+	// The write runs on a worker, restoring isn't meant to include waiting for it
+	if (Checkpoints->IsWriting()) return false;
+	if (Data->SaveMs.Num() > Data->LoadMs.Num()) {
+		const double StartTime = FPlatformTime::Seconds();
+		Test->TestTrue(TEXT("Checkpoint restored"), Checkpoints->LoadCheckpoint(CheckpointTestName));
+		Data->LoadMs.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+		Data->Runs++;
+		return Data->Runs > NumTimedRuns;
+	}
+	const double StartTime = FPlatformTime::Seconds();
+	Test->TestTrue(TEXT("Checkpoint saved"), Checkpoints->SaveCheckpoint(CheckpointTestName));
+	Data->SaveMs.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return false;
+}
+
+// Check the worst timed run against the budget, then clean up
+DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FCheckCheckpointTimings, FAutomationTestBase*, Test, TSharedRef<FCheckpointTimingData>, Data);
+bool FCheckCheckpointTimings::Update() {
+	double WorstSaveMs = 0.0;
+	double WorstLoadMs = 0.0;
+	for (int32 i = 1; i < Data->LoadMs.Num(); i++) {
+		WorstSaveMs = FMath::Max(WorstSaveMs, Data->SaveMs[i]);
+		WorstLoadMs = FMath::Max(WorstLoadMs, Data->LoadMs[i]);
+	}
+	Test->AddInfo(FString::Printf(TEXT("%d props and %d enemies: worst save %.2f ms, worst restore %.2f ms"), NumTestProps, NumTestEnemies, WorstSaveMs, WorstLoadMs));
+	Test->TestTrue(FString::Printf(TEXT("Save under %.0f ms"), BudgetMs), WorstSaveMs < BudgetMs);
+	Test->TestTrue(FString::Printf(TEXT("Restore under %.0f ms"), BudgetMs), WorstLoadMs < BudgetMs);
+
+	for (const TWeakObjectPtr<AActor>& Actor : Data->Spawned) {
+		if (Actor.IsValid()) {
+			Actor->Destroy();
+		}
+	}
+	IFileManager::Get().Delete(*UCheckpointSubsystem::GetCheckpointPath(CheckpointTestName));
+	return true;
+}
+
+/**
+ * Times a checkpoint save and restore with 2000 physics props and 100 enemies on Main, and fails past 10 ms.
+ * Meant for headless runs, e.g. ExtrasensoryFun -nullrhi -ExecCmds="Automation RunTests ExtrasensoryFun.Checkpoint;Quit"
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCheckpointTimingTest, "ExtrasensoryFun.Checkpoint.Timing",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+bool FCheckpointTimingTest::RunTest(const FString& Parameters) {
+	TSharedRef<FCheckpointTimingData> Data = MakeShared<FCheckpointTimingData>();
+	AutomationOpenMap(TEXT("/Game/Main"));
+	ADD_LATENT_AUTOMATION_COMMAND(FSpawnCheckpointActors(this, Data));
+	// Let the props land, so the checkpoint holds a mix of moving and sleeping bodies
+	ADD_LATENT_AUTOMATION_COMMAND(FEngineWaitLatentCommand(1.f));
+	ADD_LATENT_AUTOMATION_COMMAND(FTimeCheckpoints(this, Data));
+	ADD_LATENT_AUTOMATION_COMMAND(FCheckCheckpointTimings(this, Data));
+	return true;
+}
+
+#endif
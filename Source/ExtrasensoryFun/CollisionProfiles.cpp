@@ -0,0 +1,149 @@
+// by Jason Hilani
+
+
+#include "CollisionProfiles.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/CollisionProfile.h"
+#include "Kismet/GameplayStatics.h"
+
+namespace CollisionProfiles {
+	const FName Grabbable(TEXT("Grabbable"));
+	const FName Held(TEXT("Held"));
+	const FName Thrown(TEXT("Thrown"));
+	const FName Corpse(TEXT("Corpse"));
+
+	FPhysicsProfile GetHeldProfile() {
+		return { Held, true, false, true };
+	}
+
+	FPhysicsProfile GetThrownProfile() {
+		return { Thrown, true, false, true };
+	}
+
+	/**
+	* Hit events are part of the filter data, so they're set on the body instance directly and picked up by the profile switch.
+	* Gravity only touches the physics particle, and simulation is turned on last since it needs the profile's physics collision.
+	*/
+	void Apply(UPrimitiveComponent* Component, const FPhysicsProfile& Profile) {
+		FBodyInstance& Body = Component->BodyInstance;
+		if (Component->GetCollisionProfileName() != Profile.CollisionProfile) {
+			Body.bNotifyRigidBodyCollision = Profile.bNotifyRigidBodyCollision;
+			Component->SetCollisionProfileName(Profile.CollisionProfile);
+		} else if (Body.bNotifyRigidBodyCollision != Profile.bNotifyRigidBodyCollision) {
+			Component->SetNotifyRigidBodyCollision(Profile.bNotifyRigidBodyCollision);
+		}
+		Component->SetEnableGravity(Profile.bEnableGravity);
+		if (Component->IsSimulatingPhysics() != Profile.bSimulatePhysics) {
+			Component->SetSimulatePhysics(Profile.bSimulatePhysics);
+		}
+	}
+
+	FSavedCollision Save(const UPrimitiveComponent* Component) {
+		FSavedCollision Saved;
+		Saved.ProfileName = Component->GetCollisionProfileName();
+		Saved.CollisionEnabled = Component->GetCollisionEnabled();
+		Saved.ObjectType = Component->GetCollisionObjectType();
+		Saved.Responses = Component->GetCollisionResponseToChannels();
+		Saved.bNotifyRigidBodyCollision = Component->BodyInstance.bNotifyRigidBodyCollision;
+		return Saved;
+	}
+
+	// Go back to saved settings, in a single transition unless they were custom
+	void Restore(UPrimitiveComponent* Component, const FSavedCollision& Saved) {
+		Component->BodyInstance.bNotifyRigidBodyCollision = Saved.bNotifyRigidBodyCollision;
+		if (Saved.ProfileName != UCollisionProfile::CustomCollisionProfileName) {
+			Component->SetCollisionProfileName(Saved.ProfileName);
+			return;
+		}
+		Component->SetCollisionObjectType(Saved.ObjectType);
+		Component->SetCollisionResponseToChannels(Saved.Responses);
+		Component->SetCollisionEnabled(Saved.CollisionEnabled);
+	}
+}
+
+// -----Console commands-----
+
+/**
+* Time grabbing and releasing Count cubes, with the response edits the grab used to make one at a time and with the profiles.
+* Each cube starts from the same state for both paths: not simulating, BlockAllDynamic with a Telekinesis overlap.
+* Both paths release back to that state, except for simulation which stays on, so they do the same work.
+*/
+static void CollisionProfilesBench(const TArray<FString>& Args, UWorld* World) {
+	const int32 Count = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 200;
+	UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(World, 0);
+	if (!Cube) return;
+
+	// Spread them over a line above the player, away from each other
+	const FVector Origin = (PlayerPawn ? PlayerPawn->GetActorLocation() : FVector::ZeroVector) + FVector(0.f, 0.f, 2000.f);
+	TArray<UStaticMeshComponent*> Meshes;
+	for (int32 i = 0; i < Count; i++) {
+		AStaticMeshActor* Actor = World->SpawnActor<AStaticMeshActor>(Origin + FVector(i * 150.f, 0.f, 0.f), FRotator::ZeroRotator);
+		UStaticMeshComponent* Mesh = Actor->GetStaticMeshComponent();
+		Mesh->SetMobility(EComponentMobility::Movable);
+		Mesh->SetStaticMesh(Cube);
+		Meshes.Add(Mesh);
+	}
+	auto ResetMeshes = [&Meshes]() {
+		for (UStaticMeshComponent* Mesh : Meshes) {
+			Mesh->SetSimulatePhysics(false);
+			Mesh->SetEnableGravity(true);
+			Mesh->SetNotifyRigidBodyCollision(false);
+			Mesh->SetCollisionProfileName(UCollisionProfile::BlockAllDynamic_ProfileName);
+			Mesh->SetCollisionResponseToChannel(ECC_GameTraceChannel1, ECR_Overlap);
+		}
+	};
+
+	// Response edits one at a time, the whole sequence the grab used to make and the edits undoing it
+	ResetMeshes();
+	uint64 GrabCycles = 0;
+	uint64 ReleaseCycles = 0;
+	for (UStaticMeshComponent* Mesh : Meshes) {
+		const uint64 Start = FPlatformTime::Cycles64();
+		Mesh->SetSimulatePhysics(true);
+		Mesh->SetNotifyRigidBodyCollision(true);
+		Mesh->SetEnableGravity(false);
+		Mesh->SetCollisionResponseToChannel(ECC_Camera, ECR_Overlap);
+		const uint64 Grabbed = FPlatformTime::Cycles64();
+		Mesh->SetEnableGravity(true);
+		Mesh->SetNotifyRigidBodyCollision(false);
+		Mesh->SetCollisionResponseToChannel(ECC_Camera, ECR_Block);
+		ReleaseCycles += FPlatformTime::Cycles64() - Grabbed;
+		GrabCycles += Grabbed - Start;
+	}
+	const double EditGrabUs = FPlatformTime::ToMilliseconds64(GrabCycles) * 1000.0 / Count;
+	const double EditReleaseUs = FPlatformTime::ToMilliseconds64(ReleaseCycles) * 1000.0 / Count;
+
+	// Profiles, released objects go back to their original settings
+	ResetMeshes();
+	GrabCycles = 0;
+	ReleaseCycles = 0;
+	const CollisionProfiles::FPhysicsProfile HeldProfile = CollisionProfiles::GetHeldProfile();
+	for (UStaticMeshComponent* Mesh : Meshes) {
+		const uint64 Start = FPlatformTime::Cycles64();
+		const CollisionProfiles::FSavedCollision Saved = CollisionProfiles::Save(Mesh);
+		CollisionProfiles::Apply(Mesh, HeldProfile);
+		const uint64 Grabbed = FPlatformTime::Cycles64();
+		CollisionProfiles::Restore(Mesh, Saved);
+		Mesh->SetEnableGravity(true);
+		ReleaseCycles += FPlatformTime::Cycles64() - Grabbed;
+		GrabCycles += Grabbed - Start;
+	}
+	const double ProfileGrabUs = FPlatformTime::ToMilliseconds64(GrabCycles) * 1000.0 / Count;
+	const double ProfileReleaseUs = FPlatformTime::ToMilliseconds64(ReleaseCycles) * 1000.0 / Count;
+
+	for (UStaticMeshComponent* Mesh : Meshes) {
+		Mesh->GetOwner()->Destroy();
+	}
+	UE_LOG(LogTemp, Display, TEXT("Collision profiles bench: %d objects"), Count);
+	UE_LOG(LogTemp, Display, TEXT("  Response edits: %.2f us per grab, %.2f us per release, %.2f us total"), EditGrabUs, EditReleaseUs, EditGrabUs + EditReleaseUs);
+	UE_LOG(LogTemp, Display, TEXT("  Profiles:       %.2f us per grab, %.2f us per release, %.2f us total"), ProfileGrabUs, ProfileReleaseUs, ProfileGrabUs + ProfileReleaseUs);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CollisionProfilesBenchCommand(
+	TEXT("ef.Physics.ProfileBench"),
+	TEXT("Times grab and release state changes with per-channel response edits and with collision profiles. Usage: ef.Physics.ProfileBench [Count=200]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&CollisionProfilesBench)
+);
@@ -0,0 +1,51 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+
+class UPrimitiveComponent;
+
+/**
+ * Collision profiles of grabbable objects and corpses, defined in DefaultEngine.ini, and the physics settings that go with them.
+ * Setting channel responses, hit events and physics flags one at a time updates the body's filter data and overlaps for each call,
+ * so state changes go through Apply, which sets the flags first and switches the profile last, with a single update.
+ * Components keep their collision settings from before their first grab (see UPhysicsActivitySubsystem) to go back to them.
+ */
+namespace CollisionProfiles {
+	// Objects that can be grabbed, overlapping the Telekinesis and camera channels
+	extern EXTRASENSORYFUN_API const FName Grabbable;
+	// Objects held with telekinesis
+	extern EXTRASENSORYFUN_API const FName Held;
+	// Thrown objects, until they settle
+	extern EXTRASENSORYFUN_API const FName Thrown;
+	// Character meshes after death, ignored by TelekinesisAttack
+	extern EXTRASENSORYFUN_API const FName Corpse;
+
+	// A collision profile with the physics settings to apply along with it
+	struct FPhysicsProfile {
+		FName CollisionProfile;
+		bool bSimulatePhysics;
+		bool bEnableGravity;
+		bool bNotifyRigidBodyCollision;
+	};
+	// Held and thrown objects simulate without gravity and generate hit events
+	EXTRASENSORYFUN_API FPhysicsProfile GetHeldProfile();
+	EXTRASENSORYFUN_API FPhysicsProfile GetThrownProfile();
+
+	// Apply a profile in a single transition
+	EXTRASENSORYFUN_API void Apply(UPrimitiveComponent* Component, const FPhysicsProfile& Profile);
+
+	// A component's collision settings, profile or custom responses
+	struct FSavedCollision {
+		FName ProfileName;
+		TEnumAsByte<ECollisionEnabled::Type> CollisionEnabled;
+		TEnumAsByte<ECollisionChannel> ObjectType;
+		FCollisionResponseContainer Responses;
+		bool bNotifyRigidBodyCollision;
+	};
+	EXTRASENSORYFUN_API FSavedCollision Save(const UPrimitiveComponent* Component);
+	// Go back to saved settings, in a single transition unless they were custom
+	EXTRASENSORYFUN_API void Restore(UPrimitiveComponent* Component, const FSavedCollision& Saved);
+}
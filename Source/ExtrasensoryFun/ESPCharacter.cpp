@@ -14,12 +14,36 @@
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Blueprint/UserWidget.h"
+#include "GameplayEventLog.h"
+#include "ExtrasensoryFunStats.h"
+#include "ExtrasensoryFunLLM.h"
+#include "Net/UnrealNetwork.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "TimerManager.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerState.h"
+#include "ExtrasensoryFunReplicationGraph.h"
+#include "ThrownObjectSubsystem.h"
+#include "PhysicsActivitySubsystem.h"
+#include "CollisionProfiles.h"
+#include "PropNavigationSubsystem.h"
+#include "InstancedPropContainer.h"
+#include "SoftAssets.h"
+
+DECLARE_CYCLE_STAT(TEXT("ESP Character Tick"), STAT_ESPCharacterTick, STATGROUP_ExtrasensoryFun);
+DECLARE_CYCLE_STAT(TEXT("Grab"), STAT_Grab, STATGROUP_ExtrasensoryFun);
+DECLARE_CYCLE_STAT(TEXT("Grab Sweep"), STAT_GrabSweep, STATGROUP_ExtrasensoryFun);
+DECLARE_CYCLE_STAT(TEXT("Sort Hit Results"), STAT_SortHitResults, STATGROUP_ExtrasensoryFun);
+DECLARE_CYCLE_STAT(TEXT("Throw"), STAT_Throw, STATGROUP_ExtrasensoryFun);
+DECLARE_CYCLE_STAT(TEXT("Throw Aim Trace"), STAT_ThrowAimTrace, STATGROUP_ExtrasensoryFun);
 
 // Default constructor
 AESPCharacter::AESPCharacter() {
 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
+	LLM_SCOPE_BYTAG(ExtrasensoryFun_Telekinesis);
 	// Create physics handle components for the character according to ObjectGrabLimit and number them
 	for (int i = 0; i < TelekinesisConfig.ObjectGrabLimit; i++) {
 		CreateDefaultSubobject<UPhysicsHandleComponent>(FName("Physics Handle " + FString::FromInt(i + 1)));
@@ -30,6 +54,7 @@ AESPCharacter::AESPCharacter() {
 void AESPCharacter::BeginPlay() {
 	Super::BeginPlay();
 
+	LLM_SCOPE_BYTAG(ExtrasensoryFun_Telekinesis);
 	// Assign all physics handle components to the PhysicsHandles TArray
 	GetComponents(PhysicsHandles);
 	// For each physics handle, set its interpolation speed and add an element to the PositionsFromCharacter and TelekinesisDecals TArrays
@@ -37,9 +62,22 @@ void AESPCharacter::BeginPlay() {
 		PositionsFromChar.Add(FVector(0.f));
 		TelekinesisDecals.Add(nullptr);
 	}
+	// The emitters are spawned once their particle systems are loaded
+	SoftAssets::LoadThen(
+		{ MuzzleCast.ToSoftObjectPath(), MuzzleAim.ToSoftObjectPath(), MuzzleGlow.ToSoftObjectPath(), SecondJumpFX.ToSoftObjectPath(), ThirdJumpFX.ToSoftObjectPath() },
+		FStreamableDelegate::CreateUObject(this, &AESPCharacter::SpawnEmitters)
+	);
+}
+
+/**
+* Spawn the telekinesis and jump emitters attached to the character's mesh.
+* Called once their particle systems are loaded, missing ones are left null.
+*/
+void AESPCharacter::SpawnEmitters() {
+	LLM_SCOPE_BYTAG(ExtrasensoryFun_FX);
 	// Set emitter for character's right arm for telekinesis
 	CastEmitter = UGameplayStatics::SpawnEmitterAttached(
-		MuzzleCast,
+		MuzzleCast.Get(),
 		GetMesh(),
 		TEXT("Muzzle_01"),
 		FVector(ForceInit),
@@ -50,9 +88,11 @@ void AESPCharacter::BeginPlay() {
 		EPSCPoolMethod::None,
 		false
 	);
-	CastEmitter->SetTranslucentSortPriority(1);
+	if (CastEmitter) {
+		CastEmitter->SetTranslucentSortPriority(1);
+	}
 	AimEmitter = UGameplayStatics::SpawnEmitterAttached(
-		MuzzleAim,
+		MuzzleAim.Get(),
 		GetMesh(),
 		TEXT("Muzzle_01"),
 		FVector(ForceInit),
@@ -63,10 +103,12 @@ void AESPCharacter::BeginPlay() {
 		EPSCPoolMethod::None,
 		false
 	);
-	AimEmitter->SetTranslucentSortPriority(1);
+	if (AimEmitter) {
+		AimEmitter->SetTranslucentSortPriority(1);
+	}
 	// Set glow emitter for when character uses telekinesis
 	GlowEmitter = UGameplayStatics::SpawnEmitterAttached(
-		MuzzleGlow,
+		MuzzleGlow.Get(),
 		GetMesh(),
 		TEXT("Status"),
 		FVector(ForceInit),
@@ -77,10 +119,12 @@ void AESPCharacter::BeginPlay() {
 		EPSCPoolMethod::None,
 		false
 	);
-	GlowEmitter->SetTranslucentSortPriority(1);
+	if (GlowEmitter) {
+		GlowEmitter->SetTranslucentSortPriority(1);
+	}
 	// Set feet emitters for the 2nd and third jumps of the triple jump
 	JumpEmitterLeft1 = UGameplayStatics::SpawnEmitterAttached(
-		SecondJumpFX,
+		SecondJumpFX.Get(),
 		GetMesh(),
 		TEXT("Foot_L"),
 		FVector(ForceInit),
@@ -92,7 +136,7 @@ void AESPCharacter::BeginPlay() {
 		false
 	);
 	JumpEmitterRight1 = UGameplayStatics::SpawnEmitterAttached(
-		SecondJumpFX,
+		SecondJumpFX.Get(),
 		GetMesh(),
 		TEXT("Foot_R"),
 		FVector(ForceInit),
@@ -104,7 +148,7 @@ void AESPCharacter::BeginPlay() {
 		false
 	);
 	JumpEmitterLeft2 = UGameplayStatics::SpawnEmitterAttached(
-		ThirdJumpFX,
+		ThirdJumpFX.Get(),
 		GetMesh(),
 		TEXT("Foot_L"),
 		FVector(ForceInit),
@@ -116,7 +160,7 @@ void AESPCharacter::BeginPlay() {
 		false
 	);
 	JumpEmitterRight2 = UGameplayStatics::SpawnEmitterAttached(
-		ThirdJumpFX,
+		ThirdJumpFX.Get(),
 		GetMesh(),
 		TEXT("Foot_R"),
 		FVector(ForceInit),
@@ -131,64 +175,66 @@ void AESPCharacter::BeginPlay() {
 
 // Called every frame
 void AESPCharacter::Tick(float DeltaTime) {
+	EF_SCOPE_CYCLE_COUNTER(STAT_ESPCharacterTick);
 	Super::Tick(DeltaTime);
 
+	if (IsPredicting()) {
+		TickPrediction(DeltaTime);
+	}
+
 	/**
 	* Set the location and rotation of each grabbed object.
 	* TargetLocation is always set to the relative position from the character assigned during grabbing, except for the Z axis.
 	* Rotation is set to the TargetRotation of the spring arm.
+	* The math itself lives in TelekinesisMath, this gathers the grabbed objects into batches for it.
 	*/
+	TArray<int32, TInlineAllocator<10>> HandleIndices;
+	TArray<FVector, TInlineAllocator<10>> CurrentPositions;
+	TArray<FVector, TInlineAllocator<10>> GrabPositions;
 	for (int i = 0; i < PhysicsHandles.Num(); i++) {
 		if (UPrimitiveComponent* Component = PhysicsHandles[i]->GetGrabbedComponent()) {
 			// If, while grabbing the component, it gets destroyed by an incoming projectile, release the component.
 			if (Component->IsPendingKill()) {
-				PhysicsHandles[i]->ReleaseComponent();
-			}
-
-			FVector FwdVector;
-			FVector Location;
-			/**
-			* Get Location and ForwardVector to use in HandleTargetLocation.
-			* Location and ForwardVector change depending on if there's a Target or not.
-			*/
-			if (Target.GetActor()) {
-				// Component's relative position X from the character divided by the Target's
-				float PosFromCharXRatio = PositionFromChar(Component).X / PositionFromChar(Target.GetComponent()).X;
-				// Will become Location's Z axis
-				float CompPosZ = FMath::Clamp(PosFromCharXRatio, PosFromCharXRatio, 1.f) * PositionFromChar(Target.GetComponent()).Z;
-				// CompPosZ calculation changes depending on if it's negative or not
-				if (CompPosZ < 0) {
-					CompPosZ = GetActorLocation().Z + 90 - FMath::Clamp(-CompPosZ, PositionFromChar(Target.GetComponent()).Z, GetActorLocation().Z);
-				} else {
-					CompPosZ = FMath::Clamp(CompPosZ + 192.f, GetActorLocation().Z + 90.f, PositionFromChar(Target.GetComponent()).Z + 192.f);
+				DetachFromHandle(i, false);
+				if (HasAuthority()) {
+					RefreshHeldObjects();
 				}
-				// Location and FwdVector if there's a Target.
-				Location = FVector(GetActorLocation().X, GetActorLocation().Y, CompPosZ);
-				FwdVector = GetActorForwardVector();
-			} else {
-				// Location and FwdVector if there isn't a Target.
-				Location = GetActorLocation() + FVector(0.f, 0.f, 90.f);
-				FwdVector = FVector(GetActorForwardVector().X, GetActorForwardVector().Y, Camera->GetForwardVector().Z);
+				continue;
 			}
-			// Get the physics handle's target location
-			FVector HandleTargetLocation = Location
-				+ FwdVector * (FMath::Clamp(PositionsFromChar[i].X, 100, PositionsFromChar[i].X))
-				+ GetActorRightVector() * PositionsFromChar[i].Y;
+			HandleIndices.Add(i);
+			CurrentPositions.Add(PositionFromChar(Component));
+			GrabPositions.Add(PositionsFromChar[i]);
+		}
+	}
+	if (HandleIndices.Num() > 0) {
+		TArray<FVector, TInlineAllocator<10>> HandleTargets;
+		HandleTargets.SetNumUninitialized(HandleIndices.Num());
+		// The server and the owning client compute the targets, other clients get them replicated
+		if (HasAuthority() || IsLocallyControlled()) {
+			TelekinesisMath::ComputeHandleTargets(GetTelekinesisFrame(), CurrentPositions, GrabPositions, HandleTargets);
+		} else {
+			GetReplicatedHandleTargets(HandleIndices, HandleTargets);
+		}
+		if (HasAuthority() && GetNetMode() != NM_Standalone) {
+			UpdateHeldTargets(HandleIndices, HandleTargets);
+		}
+		const FRotator TargetRotation = SpringArm->GetTargetRotation();
+		for (int i = 0; i < HandleIndices.Num(); i++) {
 			// Set target location and rotation for the grabbed component's physics handle
-			PhysicsHandles[i]->SetTargetLocationAndRotation(HandleTargetLocation, SpringArm->GetTargetRotation());
+			PhysicsHandles[HandleIndices[i]]->SetTargetLocationAndRotation(HandleTargets[i], TargetRotation);
 		}
 	}
 
 	// Activate the emitter when grabbing at least 1 object, deactivate when not
 	if (CastEmitter) {
-		if (IsGrabbingObject() && !AimEmitter->IsActive()) {
+		if (IsGrabbingObject() && !(AimEmitter && AimEmitter->IsActive())) {
 			if (!CastEmitter->IsActive()) {
 				CastEmitter->Activate();
 			}
 		} else {
 			CastEmitter->Deactivate();
 		}
-	} else {
+	} else if (MuzzleCast.IsNull()) {
 		UE_LOG(LogTemp, Error, TEXT("No particle effect on MuzzleCast!"));
 	}
 
@@ -247,6 +293,7 @@ void AESPCharacter::Tick(float DeltaTime) {
 		CancelAim();
 		StopAiming();
 	}
+	SET_DWORD_STAT(STAT_HeldObjects, GetHeldObjectCount());
 }
 
 // Called to bind functionality to player input
@@ -274,17 +321,44 @@ void AESPCharacter::OnMovementModeChanged(EMovementMode PrevMovementMode, uint8
 		// Reset jumptimer
 		JumpTimer = JumpTime;
 		// Deactivate jump fx
-		if (SecondJumpFX) {
+		if (JumpEmitterLeft1) {
 			JumpEmitterLeft1->Deactivate();
 			JumpEmitterRight1->Deactivate();
 		}
-		if (ThirdJumpFX) {
+		if (JumpEmitterLeft2) {
 			JumpEmitterLeft2->Deactivate();
 			JumpEmitterRight2->Deactivate();
 		}
 	}
 }
 
+// Undo HandleDeath and reset telekinesis, aiming and jumping
+void AESPCharacter::Revive() {
+	Super::Revive();
+
+	Release();
+	StopGrabbing();
+	CancelAim();
+	ResetTargeting();
+	JumpCount = 0;
+	JumpTimer = 0.f;
+	AimTimer = 0.f;
+	AimByHolding = false;
+	UpdateAimReticle();
+}
+
+void AESPCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const {
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AESPCharacter, HeldObjects);
+	DOREPLIFETIME_CONDITION(AESPCharacter, HeldTargets, COND_SkipOwner);
+}
+
+// Grabbable objects are those that overlap with the Telekinesis collision trace channel
+bool AESPCharacter::IsGrabbable(const UPrimitiveComponent* Component) {
+	return Component && Component->Mobility == EComponentMobility::Movable && Component->GetCollisionResponseToChannel(ECC_GameTraceChannel1) == ECR_Overlap;
+}
+
 /**
 * Sphere sweep to find objects the character can grab.
 * We don't want the sweep to stop at the first blocking hit, so instead we
@@ -295,43 +369,30 @@ void AESPCharacter::OnMovementModeChanged(EMovementMode PrevMovementMode, uint8
 * Returns true if at least 1 object/overlap is found.
 */
 bool AESPCharacter::GetGrabbableObjectsInReach(TArray<FHitResult>& OutHitResults) const {
+	EF_SCOPE_CYCLE_COUNTER(STAT_GrabSweep);
 	/**
 	* Start from the character's location + the GrabRadius in the forward direction of the camera.
 	* This is so that the sphere always starts from the front of the character instead of within (if aiming forward).
 	* We also add the CapsuleHalfHeight in proportion to how far we aim the camera up or down. Like this,
 	* the sphere starts from the top of our head if we aim upwards, from the bottom of our feet if we aim downwards, and anything in-between.
 	*/
-	float CapsuleHalfHeight = this->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
-	FVector Start(0.f);
-	FVector End(0.f);
-	
 	// Start and end vectors depend on whether or not there's a target
-	if (Target.GetActor()) {
-		// GrabRadius divided by Target's Position's X axis
-		float XRatio = TelekinesisConfig.GrabRadius / PositionFromChar(Target.GetComponent()).X;
-		// Will become Location's Z axis
-		float PosZ = FMath::Clamp(XRatio, XRatio, 1.f) * PositionFromChar(Target.GetComponent()).Z;
-		// CompPosZ calculation changes depending on if it's negative or not
-		if (PosZ < 0) {
-			PosZ = GetActorLocation().Z - FMath::Clamp(-PosZ, PositionFromChar(Target.GetComponent()).Z, GetActorLocation().Z);
-		} else {
-			PosZ = FMath::Clamp(PosZ, GetActorLocation().Z, PositionFromChar(Target.GetComponent()).Z);
-		}
-		FVector Location = FVector(GetActorLocation().X, GetActorLocation().Y, PosZ);
-		Start = Location + GetActorForwardVector() * (TelekinesisConfig.GrabRadius + CapsuleHalfHeight * FMath::Abs(PositionFromChar(Target.GetComponent()).ForwardVector.Z));
-		End = Location + GetActorForwardVector() * (TelekinesisConfig.GrabRange + CapsuleHalfHeight * FMath::Abs(PositionFromChar(Target.GetComponent()).ForwardVector.Z));
-		FCollisionShape Sphere = FCollisionShape::MakeSphere(TelekinesisConfig.GrabRadius);
-	} else {
-		Start = GetActorLocation() + Camera->GetForwardVector() * (TelekinesisConfig.GrabRadius + CapsuleHalfHeight * FMath::Abs(Camera->GetForwardVector().Z));
-		End = GetActorLocation() + Camera->GetForwardVector() * (TelekinesisConfig.GrabRange + CapsuleHalfHeight * FMath::Abs(Camera->GetForwardVector().Z));
-	}
-	
+	const TelekinesisMath::FSweepSegment Segment = TelekinesisMath::ComputeGrabSweep(
+		GetTelekinesisFrame(),
+		GetCapsuleComponent()->GetScaledCapsuleHalfHeight(),
+		TelekinesisConfig.GrabRadius,
+		TelekinesisConfig.GrabRange
+	);
+	const FVector& Start = Segment.Start;
+	const FVector& End = Segment.End;
+
 	// These parameters will make the sphere sweep inclube overlaps.
 	FCollisionQueryParams Params = FCollisionQueryParams();
 	Params.bFindInitialOverlaps = true;
 	FCollisionShape Sphere = FCollisionShape::MakeSphere(TelekinesisConfig.GrabRadius);
 
 	// Sphere sweep
+	EF_INC_FRAME_COUNTER(STAT_Sweeps, Sweeps);
 	//DrawDebugSphere(GetWorld(), End, TelekinesisConfig.GrabRadius, 20, FColor::Red, false, 3.f); // For a visual on the sweep
 	GetWorld()->SweepMultiByChannel(
 		OutHitResults,
@@ -352,12 +413,14 @@ bool AESPCharacter::GetGrabbableObjectsInReach(TArray<FHitResult>& OutHitResults
 * This is so then the character always grabs the nearest objects first.
 */
 void AESPCharacter::SortHitResults(TArray<FHitResult>& OutHitResults) const {
+	EF_SCOPE_CYCLE_COUNTER(STAT_SortHitResults);
 	for (int i = 0; i < OutHitResults.Num(); i++) {
 		FHitResult Temp = OutHitResults[i];
-		FVector ComponentLocation = Temp.GetComponent()->GetComponentLocation();
+		// Instances share their container's component, so use the instance's location
+		FVector ComponentLocation = AInstancedPropContainer::GetHitObjectLocation(Temp);
 		float Distance = ComponentLocation.Distance(GetActorLocation(), ComponentLocation);
 		for (int y = 0; y < i; y++) {
-			FVector OtherComponentLocation = OutHitResults[y].GetComponent()->GetComponentLocation();
+			FVector OtherComponentLocation = AInstancedPropContainer::GetHitObjectLocation(OutHitResults[y]);
 			float OtherDistance = OtherComponentLocation.Distance(GetActorLocation(), OtherComponentLocation);
 			if (Distance < OtherDistance) {
 				OutHitResults[i] = OutHitResults[y];
@@ -368,12 +431,22 @@ void AESPCharacter::SortHitResults(TArray<FHitResult>& OutHitResults) const {
 	}
 }
 
+// Whether at least one physics handle isn't holding anything
+bool AESPCharacter::HasAvailableHandle() const {
+	return PhysicsHandles.ContainsByPredicate([](const UPhysicsHandleComponent* Handle) {
+		return !Handle->GetGrabbedComponent();
+	});
+}
+
 /*
 * Set IsGrabbing to true.
 * Center camera behind player.
 * Use controller rotation yaw and don't orient rotation to movement.
 */ 
 void AESPCharacter::StartGrabbing() {
+	if (!HasAuthority()) {
+		ServerStartGrabbing();
+	}
 	IsGrabbing = true;
 	if (!Target.GetActor()) {
 		GetController()->SetControlRotation(GetActorRotation());
@@ -388,6 +461,9 @@ void AESPCharacter::StartGrabbing() {
 * Orient rotation to movement and don't use controller rotation yaw.
 */
 void AESPCharacter::StopGrabbing() {
+	if (!HasAuthority()) {
+		ServerStopGrabbing();
+	}
 	IsGrabbing = false;
 	if (GlowEmitter) {
 		GlowEmitter->Deactivate();
@@ -400,79 +476,87 @@ void AESPCharacter::StopGrabbing() {
 * The character will grab the closest objects first.
 */
 void AESPCharacter::Grab() {
-	// Can't grab while throwing
-	if (!IsFrozen) {
+	EF_SCOPE_CYCLE_COUNTER(STAT_Grab);
+	// Can't grab while throwing.
+	// Owning clients predict their grabs and the server validates them instead of sweeping, simulated proxies never grab.
+	const bool bCanGrab = HasAuthority() ? !IsRemotelyPredicted() : IsLocallyControlled();
+	if (!IsFrozen && bCanGrab) {
 		TArray<FHitResult> HitResults;
 		// Sphere sweep on the Telekinesis channel for any overlap hits
 		if (GetGrabbableObjectsInReach(HitResults)) {
 			// Sort hit results in ascending distance from the character
 			SortHitResults(HitResults);
-			// Iterate through hit results and get the hit result, component and actor
+			if (IsPredicting()) {
+				PredictGrabs(HitResults);
+				return;
+			}
+			// Iterate through hit results and grab each object while there are physics handles available
 			for (int i = 0; i < HitResults.Num(); i++) {
-				FHitResult HitResult = HitResults[i];
-				UPrimitiveComponent* HitComponent = HitResult.GetComponent();
-				AActor* HitActor = HitResult.GetActor();
-
-				// For each hit result/object, iterate through the physics handle components
-				for (int y = 0; y < PhysicsHandles.Num(); y++) {
-					// Make sure that the physics handle is available and that the hit result/object is not already being grabbed
-					if (!HitActor->ActorHasTag("Grabbed") && !PhysicsHandles[y]->GetGrabbedComponent()) {
-						// Enable physics and wake up the object to make sure we can grab and manipulate it
-						HitComponent->SetSimulatePhysics(true);
-						HitComponent->SetNotifyRigidBodyCollision(true);
-						HitComponent->WakeAllRigidBodies();
-						// Detach it from any attached actor such as a trigger or an actor composed of many actors
-						HitActor->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
-						HitActor->Tags.Add("Grabbed"); // Useful for tracking the objects that are currently being grabbed
-						HitActor->SetOwner(this);
-						// Grab the component
-						PhysicsHandles[y]->GrabComponentAtLocationWithRotation(
-							HitComponent,
-							NAME_None,
-							HitResult.ImpactPoint,
-							Camera->GetComponentRotation()
-						);
-
-						// Remove TrailFX and hit events if it's a ShooterProjectile
-						if (AShooterProjectile* Projectile = Cast<AShooterProjectile>(HitActor)) {
-							if (UParticleSystemComponent* Particles = Projectile->GetTrailFX()) {
-								Particles->DestroyComponent();
-							}
-							Projectile->GetMesh()->SetNotifyRigidBodyCollision(false);
-						}
-						// Disable gravity
-						HitComponent->SetEnableGravity(false);
-						// Attach decal component
-						AttachTelekinesisDecal(HitComponent, y);
-						// Make the character ignore the collision of the object so the character doesn't get pushed around by the objects it's manipulating
-						this->MoveIgnoreActorAdd(HitActor);
-						// Make the grabbed objects overlap with the camera channel so the spring arm doesn't retract for grabbed objects that end up behind the character
-						HitComponent->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECR_Overlap);
-						// Record object positions relative to the character upon grabbing them
-						PositionsFromChar[i] = PositionFromChar(HitComponent);
-						break;
-					}
+				UPrimitiveComponent* HitComponent = HitResults[i].GetComponent();
+				// Instanced props are swapped for an actor first, as long as there's a handle left for it
+				if (AInstancedPropContainer* Container = Cast<AInstancedPropContainer>(HitResults[i].GetActor())) {
+					if (!HasAvailableHandle()) break;
+					HitComponent = Container->PromoteInstance(HitResults[i].Item);
+					if (!HitComponent) continue;
 				}
+				GrabComponent(HitComponent, HitResults[i].ImpactPoint);
 			}
 		}
 	}
 }
 
+/**
+* Grab a component with the first available physics handle.
+* Returns false if the component is already being grabbed or if all the physics handles are in use.
+*
+* @param HitComponent, the component to grab
+* @param GrabLocation, where to hold the component from
+*/
+bool AESPCharacter::GrabComponent(UPrimitiveComponent* HitComponent, const FVector& GrabLocation) {
+	AActor* HitActor = HitComponent->GetOwner();
+	// Make sure that the object is not already being grabbed
+	if (HitActor->ActorHasTag("Grabbed")) return false;
+
+	// Iterate through the physics handle components to find an available one
+	for (int y = 0; y < PhysicsHandles.Num(); y++) {
+		if (!PhysicsHandles[y]->GetGrabbedComponent()) {
+			GrabComponentInSlot(y, HitComponent, GrabLocation);
+			RefreshHeldObjects();
+			return true;
+		}
+	}
+	return false;
+}
+
+// Grab a component with a specific, available physics handle
+void AESPCharacter::GrabComponentInSlot(int32 Slot, UPrimitiveComponent* HitComponent, const FVector& GrabLocation) {
+	AttachToHandle(Slot, HitComponent, GrabLocation);
+	// Record object positions relative to the character upon grabbing them, indexed like the physics handles
+	PositionsFromChar[Slot] = PositionFromChar(HitComponent);
+	FGameplayEventLog::Get().Push(EGameplayEventType::Grab, this, HitComponent->GetOwner());
+}
+
 /**
 * Simply drops all the objects the character is currently manipulating.
 * Checks all physics handle components for grabbed objects and releases them.
 */
 void AESPCharacter::Release() {
+	if (IsPredicting()) {
+		PredictRelease();
+		return;
+	}
+	// Clients let go once the server's held set replicates, but stop aiming right away
+	if (!HasAuthority()) {
+		ServerRelease();
+		CancelAim();
+		return;
+	}
 	for (int i = 0; i < PhysicsHandles.Num(); i++) {
-		if (UPrimitiveComponent* GrabbedComponent = PhysicsHandles[i]->GetGrabbedComponent()) {
-			GrabbedComponent->WakeAllRigidBodies(); // In case the object is sleeping
-			GrabbedComponent->GetOwner()->Tags.Remove("Grabbed");
-			// Re-enable gravity
-			GrabbedComponent->SetEnableGravity(true);
-			PhysicsHandles[i]->ReleaseComponent();
-			TelekinesisDecals[i]->DestroyComponent();
+		if (PhysicsHandles[i]->GetGrabbedComponent()) {
+			DetachFromHandle(i, true);
 		}
 	}
+	RefreshHeldObjects();
 	CancelAim();
 }
 
@@ -485,6 +569,9 @@ void AESPCharacter::Release() {
 */ 
 void AESPCharacter::ThrowAim() {
 	if (IsGrabbingObject()) {
+		if (!HasAuthority()) {
+			ServerThrowAim();
+		}
 		if (!IsFrozen) {
 			// Start AimTimer and AimByHolding
 			AimTimer = AimTime;
@@ -496,12 +583,13 @@ void AESPCharacter::ThrowAim() {
 			}
 			// Freeze character movement
 			IsFrozen = true;
+			UpdateAimReticle();
 			// Deactivate jump fx
-			if (SecondJumpFX) {
+			if (JumpEmitterLeft1) {
 				JumpEmitterLeft1->Deactivate();
 				JumpEmitterRight1->Deactivate();
 			}
-			if (ThirdJumpFX) {
+			if (JumpEmitterLeft2) {
 				JumpEmitterLeft2->Deactivate();
 				JumpEmitterRight2->Deactivate();
 			}
@@ -527,6 +615,7 @@ void AESPCharacter::ThrowAim() {
 * The sweep is otherwise the same and goes much farther.
 */
 bool AESPCharacter::ThrowAimTrace(FHitResult& OutHitResult) const {
+	EF_SCOPE_CYCLE_COUNTER(STAT_ThrowAimTrace);
 	float CapsuleHalfHeight = this->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
 	FVector Start = GetActorLocation() + Camera->GetForwardVector() * (TelekinesisConfig.ThrowAimRadius + CapsuleHalfHeight * FMath::Abs(Camera->GetForwardVector().Z));
 	FVector End = GetActorLocation() + Camera->GetForwardVector() * (TelekinesisConfig.ThrowAimRange + CapsuleHalfHeight * FMath::Abs(Camera->GetForwardVector().Z));
@@ -534,6 +623,7 @@ bool AESPCharacter::ThrowAimTrace(FHitResult& OutHitResult) const {
 	//DrawDebugLine(GetWorld(), GetActorLocation(), End, FColor::Purple, false, 5.f);
 	//DrawDebugSphere(GetWorld(), Start, TelekinesisConfig.ThrowAimRadius, 30, FColor::Blue, false, 5.f);
 	//DrawDebugSphere(GetWorld(), End, TelekinesisConfig.ThrowAimRadius, 30, FColor::Blue, false, 5.f);
+	EF_INC_FRAME_COUNTER(STAT_Sweeps, Sweeps);
 	GetWorld()->SweepSingleByChannel(
 		OutHitResult,
 		Start, End,
@@ -545,41 +635,51 @@ bool AESPCharacter::ThrowAimTrace(FHitResult& OutHitResult) const {
 }
 
 // Get object that's closest to the target enemy the character is aiming at
-int AESPCharacter::GetClosestGrabbedObject(FHitResult* HitResult) const {
-	float Distance = NULL;
-	int Index = NULL;
-
+int AESPCharacter::GetClosestGrabbedObject(const FHitResult* HitResult) const {
+	TArray<int32, TInlineAllocator<10>> HandleIndices;
+	TArray<FVector, TInlineAllocator<10>> Locations;
 	// Iterate through each physics handle component and check all the objects currently being grabbed
 	for (int i = 0; i < PhysicsHandles.Num(); i++) {
 		if (UPrimitiveComponent* Component = PhysicsHandles[i]->GetGrabbedComponent()) {
-			// Eventually gets us the physics handle component that has the object that's closest to the target enemy the character is aiming at
-			if (FVector::Dist(HitResult->GetActor()->GetTargetLocation(), Component->GetComponentLocation()) < Distance || !Distance) {
-				Index = i;
-				Distance = FVector::Dist(HitResult->GetActor()->GetTargetLocation(), Component->GetComponentLocation());
-			}
+			HandleIndices.Add(i);
+			Locations.Add(Component->GetComponentLocation());
 		}
 	}
-	return Index;
+	// Falls back to the first physics handle if nothing is grabbed
+	const int32 Closest = TelekinesisMath::FindClosest(Locations, HitResult->GetActor()->GetTargetLocation());
+	return Closest != INDEX_NONE ? HandleIndices[Closest] : 0;
 }
 
 // Get grabbed object that's farthest forward from the Character
 int AESPCharacter::GetFarthestGrabbedObject() const {
-	float Distance = NULL;
-	int Index = NULL;
+	TArray<int32, TInlineAllocator<10>> HandleIndices;
+	TArray<FVector, TInlineAllocator<10>> CurrentPositions;
 	// Iterate through each physics handle component and check all the objects currently being grabbed
 	for (int i = 0; i < PhysicsHandles.Num(); i++) {
 		if (UPrimitiveComponent* Component = PhysicsHandles[i]->GetGrabbedComponent()) {
+			HandleIndices.Add(i);
 			// Get the grabbed object's *current* location relative to the character.
 			// Because the object may be in a different position from the one recorded in the TArray that we constantly move the object to in Tick
-			FVector CurrentPosFromChar = PositionFromChar(Component);
-			// Eventually gets us the physics handle component that has the object that's farthest frontwards from the character's aim
-			if (CurrentPosFromChar.X - FMath::Abs(CurrentPosFromChar.Y) > Distance || !Distance) {
-				Index = i;
-				Distance = CurrentPosFromChar.X - FMath::Abs(CurrentPosFromChar.Y);
-			}
+			CurrentPositions.Add(PositionFromChar(Component));
 		}
 	}
-	return Index;
+	// Falls back to the first physics handle if nothing is grabbed
+	const int32 Farthest = TelekinesisMath::FindFarthestForward(CurrentPositions);
+	return Farthest != INDEX_NONE ? HandleIndices[Farthest] : 0;
+}
+
+// Character state shared by the telekinesis math
+TelekinesisMath::FCharacterFrame AESPCharacter::GetTelekinesisFrame() const {
+	TelekinesisMath::FCharacterFrame Frame;
+	Frame.Location = GetActorLocation();
+	Frame.Forward = GetActorForwardVector();
+	Frame.Right = GetActorRightVector();
+	Frame.CameraForward = Camera->GetForwardVector();
+	if (Target.GetActor()) {
+		Frame.bHasTarget = true;
+		Frame.TargetPosFromChar = PositionFromChar(Target.GetComponent());
+	}
+	return Frame;
 }
 
 /**
@@ -588,50 +688,14 @@ int AESPCharacter::GetFarthestGrabbedObject() const {
 * The reason we do this is to prevent a grabbed object being thrown towards another grabbed object as much as possible.
 */
 void AESPCharacter::Throw() {
+	EF_SCOPE_CYCLE_COUNTER(STAT_Throw);
 	// Check if there's currently at least one object being grabbed and if we're aiming
 	// Otherwise, stop AimByHolding
 	if (IsGrabbingObject() && IsAiming) {
-		int ThrowIndex;
-		FHitResult HitResult;
-		// If there's a Target, get object closest to the target.
-		// If no Target, throw aim trace and get object closest to the HitResult.
-		// If no HitResult, throw object farthest from character.
-		if (Target.GetActor()) {
-			ThrowIndex = GetClosestGrabbedObject(&Target);
-		} else if (ThrowAimTrace(HitResult)) {
-			ThrowIndex = GetClosestGrabbedObject(&HitResult);
-		} else {
-			ThrowIndex = GetFarthestGrabbedObject();	
-		}
-
-		// If ShooterProjectile, re-enable generated hit events
-		UPrimitiveComponent* Component = PhysicsHandles[ThrowIndex]->GetGrabbedComponent();
-		if (AShooterProjectile* Projectile = Cast<AShooterProjectile>(Component->GetAttachmentRootActor())) {
-			Projectile->GetMesh()->SetNotifyRigidBodyCollision(true);
-		}
-		Component->WakeAllRigidBodies(); // In case the object is sleeping
-		Component->GetOwner()->Tags.Remove("Grabbed");
-		// Unlike in release, we only release one object and add an impulse
-		PhysicsHandles[ThrowIndex]->ReleaseComponent();
-		// remove telekinesis decal
-		TelekinesisDecals[ThrowIndex]->DestroyComponent();
-
-		// If there's a Target, throw at Target.
-		// If no target and there' was's a blocking hit from ThrowAimTrace, throw at HitResult.
-		// Otherwise, throw in the forward direction of the camera.
-		if (Target.GetActor()) {
-			FVector TargetDirection = Target.GetActor()->GetTargetLocation() - Component->GetComponentLocation();
-			Component->AddImpulse(TargetDirection.Rotation().Vector() * TelekinesisConfig.ThrowForce, NAME_None, true);
-		} else if (HitResult.bBlockingHit) {
-			FVector TargetDirection = HitResult.GetActor()->GetTargetLocation() - Component->GetComponentLocation();
-			Component->AddImpulse(TargetDirection.Rotation().Vector() * TelekinesisConfig.ThrowForce, NAME_None, true);
+		if (IsPredicting()) {
+			PredictThrow();
 		} else {
-			Component->AddImpulse(Camera->GetForwardVector() * TelekinesisConfig.ThrowForce, NAME_None, true);
-		}
-		if (!IsGrabbingObject()) {
-			// Unfreeze character
-			IsFrozen = false;
-			IsAiming = false;
+			ThrowGrabbedObject();
 		}
 		if (AimEmitter) {
 			AimEmitter->Deactivate();
@@ -642,24 +706,118 @@ void AESPCharacter::Throw() {
 	}
 }
 
+// Handle index of the object to throw, OutHitResult is the throw aim trace's result when it ran
+int AESPCharacter::SelectThrowIndex(FHitResult& OutHitResult) const {
+	// If there's a Target, get object closest to the target.
+	// If no Target, throw aim trace and get object closest to the HitResult.
+	// If no HitResult, throw object farthest from character.
+	if (Target.GetActor()) {
+		return GetClosestGrabbedObject(&Target);
+	} else if (ThrowAimTrace(OutHitResult)) {
+		return GetClosestGrabbedObject(&OutHitResult);
+	}
+	return GetFarthestGrabbedObject();
+}
+
+// If there's a Target, throw at Target.
+// If no target and there' was's a blocking hit from ThrowAimTrace, throw at HitResult.
+// Otherwise, throw in the forward direction of the camera.
+FVector AESPCharacter::GetThrowDirection(const UPrimitiveComponent* Component, const FHitResult& HitResult) const {
+	if (Target.GetActor()) {
+		return (Target.GetActor()->GetTargetLocation() - Component->GetComponentLocation()).Rotation().Vector();
+	} else if (HitResult.bBlockingHit) {
+		return (HitResult.GetActor()->GetTargetLocation() - Component->GetComponentLocation()).Rotation().Vector();
+	}
+	return Camera->GetForwardVector();
+}
+
+// Throw the selected object with the server's own aim
+void AESPCharacter::ThrowGrabbedObject() {
+	FHitResult HitResult;
+	const int ThrowIndex = SelectThrowIndex(HitResult);
+	ThrowComponent(ThrowIndex, GetThrowDirection(PhysicsHandles[ThrowIndex]->GetGrabbedComponent(), HitResult));
+}
+
+/**
+* Release a single object and add the throw impulse.
+* On the server, the object's resulting physics state is sent to clients.
+*/
+void AESPCharacter::ThrowComponent(int32 Slot, const FVector& Direction) {
+	UPrimitiveComponent* Component = PhysicsHandles[Slot]->GetGrabbedComponent();
+	// Unlike in release, we only release one object and add an impulse
+	DetachFromHandle(Slot, false);
+	// Hit events back on, including ShooterProjectiles'
+	CollisionProfiles::Apply(Component, CollisionProfiles::GetThrownProfile());
+
+	const FVector ThrowVelocity = Component->GetPhysicsLinearVelocity() + Direction * TelekinesisConfig.ThrowForce;
+	Component->AddImpulse(Direction * TelekinesisConfig.ThrowForce, NAME_None, true);
+	if (UThrownObjectSubsystem* ThrownObjects = GetWorld()->GetSubsystem<UThrownObjectSubsystem>()) {
+		ThrownObjects->TrackThrow(Component);
+	}
+	if (HasAuthority() && GetNetMode() != NM_Standalone) {
+		RefreshHeldObjects();
+		// The impulse is a velocity change, so clients can start from the resulting velocity
+		MulticastThrowState(Component, Component->GetComponentLocation(), Component->GetComponentRotation(), ThrowVelocity, Component->GetPhysicsAngularVelocityInDegrees());
+	}
+	FGameplayEventLog::Get().Push(EGameplayEventType::Throw, this, Component->GetOwner());
+	if (!IsGrabbingObject()) {
+		// Unfreeze character
+		IsFrozen = false;
+		IsAiming = false;
+		UpdateAimReticle();
+	}
+}
+
 // Stop freezing and aiming
 void AESPCharacter::CancelAim() {
 	if (IsFrozen) {
+		if (!HasAuthority() && IsLocallyControlled()) {
+			ServerCancelAim();
+		}
 		IsFrozen = false;
 		IsAiming = false;
 		if (AimEmitter) {
 			AimEmitter->Deactivate();
 		}
+		UpdateAimReticle();
 	}
 }
 
+// The base class drops targets that died or went out of range, which can bring the reticle back
+void AESPCharacter::ResetTargeting() {
+	Super::ResetTargeting();
+	UpdateAimReticle();
+}
+
 // Specific TargetLockOn functionality for ESPCharacter
 void AESPCharacter::TargetLockOn() {
 	Super::TargetLockOn();
+	if (!HasAuthority()) {
+		ServerSetLockOnTarget(Target.GetComponent());
+	}
 	// And no target and not aiming, cancel aim
 	if(!Target.GetActor() && !IsAiming) {
 		CancelAim();
 	}
+	UpdateAimReticle();
+}
+
+// The reticle is shown while frozen to aim without a target, listeners only hear about changes
+void AESPCharacter::UpdateAimReticle() {
+	const bool bVisible = IsFrozen && !Target.GetActor();
+	if (bVisible != bAimReticleVisible) {
+		bAimReticleVisible = bVisible;
+		OnAimReticleChanged.Broadcast(bVisible);
+	}
+}
+
+// Number of objects currently held with the physics handles
+int32 AESPCharacter::GetHeldObjectCount() const {
+	int32 HeldObjects = 0;
+	for (UPhysicsHandleComponent* PhysicsHandle : PhysicsHandles) {
+		HeldObjects += PhysicsHandle->GetGrabbedComponent() ? 1 : 0;
+	}
+	return HeldObjects;
 }
 
 // Returns true if character is grabbing at least 1 object
@@ -683,36 +841,21 @@ bool AESPCharacter::IsGrabbingObject() {
 */
 void AESPCharacter::Jumping() {
 	if (!GetCharacterMovement()->IsFalling()) {
-		FVector RelativeVelocity = GetActorRotation().UnrotateVector(GetVelocity());
-		/**
-		* - After the first jump (JumpCount == 1), if the character jumps before JumpTimer reaches 0,
-		* perform the second jump, which allows a higher JumpMaxHoldTime.
-		* - After the second jump (JumpCount == 2), if the character jumps before JumpTimer reaches 0 AND
-		* if the character has enough velocity, perform the third jump. For the third jump, there's no control for the height,
-		* but it allows for a much higher jump.
-		* - Second and third jumps activate their respective Jump FX
-		* - Otherwise, perform the first jump.
-		*/
-		if (JumpCount == 1 && JumpTimer > 0.f) {
-			if (SecondJumpFX) {
-				JumpEmitterLeft1->Activate();
-				JumpEmitterRight1->Activate();
-			}
-			JumpMaxHoldTime = 0.41f;
-		} else if (JumpCount == 2 && JumpTimer > 0.f && FMath::Abs(RelativeVelocity.X) + FMath::Abs(RelativeVelocity.Y) >= 600.f) {
-			if (ThirdJumpFX) {
-				JumpEmitterLeft2->Activate();
-				JumpEmitterRight2->Activate();
-			}
-			GetCharacterMovement()->JumpZVelocity = 4200.f;
-			JumpMaxHoldTime = 0.f;
-			JumpCount = -1;
-		} else {
-			GetCharacterMovement()->JumpZVelocity = 1260.f;
-			JumpMaxHoldTime = 0.3f;
-			JumpCount = 0;
+		// The rules themselves are in TelekinesisMath::ComputeJump
+		const TelekinesisMath::FJumpResult Jump = TelekinesisMath::ComputeJump({ JumpCount, JumpTimer, GetActorRotation().UnrotateVector(GetVelocity()) });
+		// Second and third jumps activate their respective Jump FX
+		if (Jump.Stage == TelekinesisMath::EJumpStage::Second && JumpEmitterLeft1) {
+			JumpEmitterLeft1->Activate();
+			JumpEmitterRight1->Activate();
+		} else if (Jump.Stage == TelekinesisMath::EJumpStage::Third && JumpEmitterLeft2) {
+			JumpEmitterLeft2->Activate();
+			JumpEmitterRight2->Activate();
 		}
-		JumpCount++;
+		if (Jump.bSetJumpZVelocity) {
+			GetCharacterMovement()->JumpZVelocity = Jump.JumpZVelocity;
+		}
+		JumpMaxHoldTime = Jump.JumpMaxHoldTime;
+		JumpCount = Jump.JumpCount;
 	}
 }
 
@@ -723,7 +866,9 @@ void AESPCharacter::Jumping() {
 * @param Index, index of TelekinesisDecals which corresponds to the index of PhysicsHandles
 */
 void AESPCharacter::AttachTelekinesisDecal(UPrimitiveComponent* HitComponent, int Index) {
-	if (TelekinesisDecalMaterial) {
+	LLM_SCOPE_BYTAG(ExtrasensoryFun_FX);
+	UMaterialInstance* DecalMaterial = SoftAssets::Get(TelekinesisDecalMaterial);
+	if (DecalMaterial) {
 		HitComponent->SetReceivesDecals(true); // Make sure the grabbed object can receive decals
 		// Get the placement extent's box of the component
 		// Unlike the collision box extent, it doesn't change even after the object is rotated and isn't affected by scale
@@ -732,18 +877,541 @@ void AESPCharacter::AttachTelekinesisDecal(UPrimitiveComponent* HitComponent, in
 		// Spawn, register and set the material instance for the decal component
 		TelekinesisDecals[Index] = NewObject<UDecalComponent>(HitComponent, UDecalComponent::StaticClass(), TEXT("Telekinesis Decal"));
 		TelekinesisDecals[Index]->RegisterComponent();
-		TelekinesisDecals[Index]->SetDecalMaterial(TelekinesisDecalMaterial);
+		TelekinesisDecals[Index]->SetDecalMaterial(DecalMaterial);
 		// Make the Decal a little bit bigger than the component box
 		// Divide the addition by the component's scale since DecalSize gets multiplied by it when attached to the component
 		// That way, we're aways adding 1.f to the decal's size no matter the component's scale
 		TelekinesisDecals[Index]->DecalSize = ComponentBox + FVector(1.f) / HitComponent->GetComponentScale();
 		// Attach decal component to the grabbed component
 		TelekinesisDecals[Index]->AttachToComponent(HitComponent, FAttachmentTransformRules::KeepRelativeTransform);
-	} else {
+	} else if (TelekinesisDecalMaterial.IsNull()) {
 		UE_LOG(LogTemp, Error, TEXT("No decal material set!"));
 	}
 }
 
+// -----Replication-----
+
+/**
+* Set up a component to be held by a physics handle.
+* Runs on the server when grabbing and on clients when the held set replicates.
+*
+* @param Slot, index of the physics handle to use
+* @param HitComponent, the component to grab
+* @param GrabLocation, where to hold the component from
+*/
+void AESPCharacter::AttachToHandle(int32 Slot, UPrimitiveComponent* HitComponent, const FVector& GrabLocation) {
+	LLM_SCOPE_BYTAG(ExtrasensoryFun_Telekinesis);
+	AActor* HitActor = HitComponent->GetOwner();
+	// Before enabling physics, so it can go back to not simulating once settled
+	if (UPhysicsActivitySubsystem* PhysicsActivity = GetWorld()->GetSubsystem<UPhysicsActivitySubsystem>()) {
+		PhysicsActivity->RegisterProp(HitComponent);
+	}
+	// Out of the navmesh until it settles, so moving it around doesn't dirty tiles
+	if (UPropNavigationSubsystem* PropNavigation = GetWorld()->GetSubsystem<UPropNavigationSubsystem>()) {
+		PropNavigation->ExcludeProp(HitComponent);
+	}
+	/**
+	* Enable physics without gravity and wake up the object to make sure we can grab and manipulate it.
+	* The Held profile also makes it overlap with the camera channel, so the spring arm doesn't retract for grabbed objects that end up behind the character.
+	* ShooterProjectiles don't generate hit events while held.
+	*/
+	CollisionProfiles::FPhysicsProfile HeldProfile = CollisionProfiles::GetHeldProfile();
+	HeldProfile.bNotifyRigidBodyCollision = !HitActor->IsA<AShooterProjectile>();
+	CollisionProfiles::Apply(HitComponent, HeldProfile);
+	HitComponent->WakeAllRigidBodies();
+	// Detach it from any attached actor such as a trigger or an actor composed of many actors
+	HitActor->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	HitActor->Tags.Add("Grabbed"); // Useful for tracking the objects that are currently being grabbed
+	HitActor->SetOwner(this);
+	// Caught again before it settled
+	if (UThrownObjectSubsystem* ThrownObjects = GetWorld()->GetSubsystem<UThrownObjectSubsystem>()) {
+		ThrownObjects->StopTracking(HitComponent);
+	}
+	// Grab the component
+	PhysicsHandles[Slot]->GrabComponentAtLocationWithRotation(
+		HitComponent,
+		NAME_None,
+		GrabLocation,
+		Camera->GetComponentRotation()
+	);
+
+	// Remove TrailFX if it's a ShooterProjectile
+	if (AShooterProjectile* Projectile = Cast<AShooterProjectile>(HitActor)) {
+		if (UParticleSystemComponent* Particles = Projectile->GetTrailFX()) {
+			Particles->DestroyComponent();
+		}
+	}
+	// Attach decal component
+	AttachTelekinesisDecal(HitComponent, Slot);
+	// Make the character ignore the collision of the object so the character doesn't get pushed around by the objects it's manipulating
+	this->MoveIgnoreActorAdd(HitActor);
+	// Keep it relevant to every connection while held, wherever it's carried
+	if (UExtrasensoryFunReplicationGraph* RepGraph = UExtrasensoryFunReplicationGraph::Get(GetWorld())) {
+		RepGraph->AddHeldObject(HitActor);
+	}
+}
+
+// Let go of a physics handle's component
+void AESPCharacter::DetachFromHandle(int32 Slot, bool bRestoreGravity) {
+	UPrimitiveComponent* GrabbedComponent = PhysicsHandles[Slot]->GetGrabbedComponent();
+	GrabbedComponent->WakeAllRigidBodies(); // In case the object is sleeping
+	GrabbedComponent->GetOwner()->Tags.Remove("Grabbed");
+	if (UExtrasensoryFunReplicationGraph* RepGraph = UExtrasensoryFunReplicationGraph::Get(GetWorld())) {
+		RepGraph->RemoveHeldObject(GrabbedComponent->GetOwner());
+	}
+	PhysicsHandles[Slot]->ReleaseComponent();
+	// Released objects go back to their collision settings from before their first grab, thrown ones once they settle
+	if (bRestoreGravity) {
+		if (UPhysicsActivitySubsystem* PhysicsActivity = GetWorld()->GetSubsystem<UPhysicsActivitySubsystem>()) {
+			if (const CollisionProfiles::FSavedCollision* Saved = PhysicsActivity->GetSavedCollision(GrabbedComponent)) {
+				CollisionProfiles::Restore(GrabbedComponent, *Saved);
+			}
+		}
+		GrabbedComponent->SetEnableGravity(true);
+	}
+	if (TelekinesisDecals[Slot]) {
+		TelekinesisDecals[Slot]->DestroyComponent();
+		TelekinesisDecals[Slot] = nullptr;
+	}
+}
+
+// Rebuild the replicated held set from the physics handles, ordered by slot
+void AESPCharacter::RefreshHeldObjects() {
+	if (GetNetMode() == NM_Standalone) return;
+	HeldObjects.Reset();
+	for (int i = 0; i < PhysicsHandles.Num(); i++) {
+		if (UPrimitiveComponent* Component = PhysicsHandles[i]->GetGrabbedComponent()) {
+			FTelekinesisHeldObject& HeldObject = HeldObjects.AddDefaulted_GetRef();
+			HeldObject.Component = Component;
+			HeldObject.Slot = i;
+			HeldObject.GrabPosFromChar = PositionsFromChar[i];
+		}
+	}
+	HeldTargets.SetNum(HeldObjects.Num());
+}
+
+/**
+* Write the handle targets to HeldTargets, relative to the character and rounded to the centimeter they replicate at.
+* Targets that haven't changed once quantized are left alone so they aren't sent again.
+*/
+void AESPCharacter::UpdateHeldTargets(TArrayView<const int32> HandleIndices, TArrayView<const FVector> HandleTargets) {
+	const FVector Location = GetActorLocation();
+	for (int i = 0; i < HeldObjects.Num(); i++) {
+		const int32 Index = HandleIndices.Find(HeldObjects[i].Slot);
+		if (Index == INDEX_NONE) continue;
+		const FVector Offset = HandleTargets[Index] - Location;
+		const FVector Quantized(FMath::RoundToDouble(Offset.X), FMath::RoundToDouble(Offset.Y), FMath::RoundToDouble(Offset.Z));
+		if (HeldTargets[i] != Quantized) {
+			HeldTargets[i] = Quantized;
+		}
+	}
+}
+
+// Handle targets from HeldTargets, objects without one yet stay where they are
+void AESPCharacter::GetReplicatedHandleTargets(TArrayView<const int32> HandleIndices, TArrayView<FVector> OutHandleTargets) const {
+	const FVector Location = GetActorLocation();
+	for (int i = 0; i < HandleIndices.Num(); i++) {
+		const int32 Index = HeldObjects.IndexOfByPredicate([Slot = HandleIndices[i]](const FTelekinesisHeldObject& HeldObject) {
+			return HeldObject.Slot == Slot;
+		});
+		if (HeldTargets.IsValidIndex(Index)) {
+			OutHandleTargets[i] = Location + HeldTargets[Index];
+		} else {
+			OutHandleTargets[i] = PhysicsHandles[HandleIndices[i]]->GetGrabbedComponent()->GetComponentLocation();
+		}
+	}
+}
+
+void AESPCharacter::OnRep_HeldObjects() {
+	SyncHeldObjects();
+}
+
+/**
+* Grab and release objects locally so the physics handles hold what the server says they do.
+* The owning client keeps its predictions until the server catches up with them, see TickPrediction.
+*/
+void AESPCharacter::SyncHeldObjects() {
+	// The server let go of what the owner released
+	for (int i = PredictedReleases.Num() - 1; i >= 0; i--) {
+		const UPrimitiveComponent* Component = PredictedReleases[i].Component.Get();
+		if (Component && HeldObjects.ContainsByPredicate([Component](const FTelekinesisHeldObject& Held) { return Held.Component == Component; })) {
+			PredictedReleases[i].bServerHeld = true;
+		} else if (!Component || PredictedReleases[i].bServerHeld) {
+			PredictedReleases.RemoveAtSwap(i);
+		}
+	}
+
+	for (int i = 0; i < PhysicsHandles.Num(); i++) {
+		const FTelekinesisHeldObject* HeldObject = HeldObjects.FindByPredicate([i](const FTelekinesisHeldObject& Held) {
+			return Held.Slot == i;
+		});
+		UPrimitiveComponent* Desired = HeldObject ? HeldObject->Component : nullptr;
+		UPrimitiveComponent* Current = PhysicsHandles[i]->GetGrabbedComponent();
+		const int32 PredictedIndex = PredictedGrabs.IndexOfByPredicate([i](const FPredictedGrab& Grab) {
+			return Grab.Slot == i;
+		});
+		if (Current == Desired) {
+			// The server confirmed the predicted grab
+			if (PredictedIndex != INDEX_NONE) {
+				PredictedGrabs.RemoveAtSwap(PredictedIndex);
+			}
+			continue;
+		}
+		// The server hasn't seen the predicted grab, throw or release yet
+		if ((PredictedIndex != INDEX_NONE && !Desired) || (Desired && (IsThrowPending(Desired) || IsReleasePending(Desired)))) continue;
+
+		if (Current) {
+			// The server put something else in the slot
+			if (PredictedIndex != INDEX_NONE) {
+				PredictionStats.RejectedGrabs++;
+				RecordCorrection(FVector::Dist(Current->GetComponentLocation(), PredictedGrabs[PredictedIndex].Location));
+				PredictedGrabs.RemoveAtSwap(PredictedIndex);
+			}
+			DetachFromHandle(i, true);
+		}
+		if (Desired) {
+			// The server holds it in another slot than the one predicted
+			for (int y = 0; y < PhysicsHandles.Num(); y++) {
+				if (y != i && PhysicsHandles[y]->GetGrabbedComponent() == Desired) {
+					PredictedGrabs.RemoveAll([y](const FPredictedGrab& Grab) { return Grab.Slot == y; });
+					DetachFromHandle(y, true);
+				}
+			}
+			AttachToHandle(i, Desired, Desired->GetComponentLocation());
+			PositionsFromChar[i] = HeldObject->GrabPosFromChar;
+		}
+	}
+}
+
+void AESPCharacter::ServerStartGrabbing_Implementation() {
+	StartGrabbing();
+}
+
+void AESPCharacter::ServerStopGrabbing_Implementation() {
+	StopGrabbing();
+}
+
+void AESPCharacter::ServerRelease_Implementation() {
+	Release();
+}
+
+void AESPCharacter::ServerThrowAim_Implementation() {
+	ThrowAim();
+}
+
+/**
+* Throw the object the client predicted, as long as it's actually held and the character aiming.
+* The client's direction is checked against the server's own aim, and throws further off than ThrowValidationAngle
+* are turned back within it and counted as corrections.
+*/
+void AESPCharacter::ServerThrowComponent_Implementation(UPrimitiveComponent* Component, FVector_NetQuantizeNormal Direction) {
+	if (!Component || !IsAiming) return;
+	for (int i = 0; i < PhysicsHandles.Num(); i++) {
+		if (PhysicsHandles[i]->GetGrabbedComponent() == Component) {
+			FHitResult HitResult;
+			if (!Target.GetActor()) {
+				ThrowAimTrace(HitResult);
+			}
+			const FVector ServerDirection = GetThrowDirection(Component, HitResult);
+			const FVector ClientDirection = FVector(Direction).GetSafeNormal();
+			const FVector ThrowDirection = ClampThrowDirection(ClientDirection, ServerDirection);
+			if (!ThrowDirection.Equals(ClientDirection)) {
+				// How far apart the client's and the server's object are by the time the client has blended most of the correction
+				RecordCorrection((ThrowDirection - ClientDirection).Size() * TelekinesisConfig.ThrowForce * CorrectionSmoothingTime);
+			}
+			ThrowComponent(i, ThrowDirection);
+			if (AimEmitter) {
+				AimEmitter->Deactivate();
+			}
+			return;
+		}
+	}
+}
+
+// Grab what the client predicted, skipping anything it couldn't have grabbed
+void AESPCharacter::ServerGrabComponents_Implementation(const TArray<FTelekinesisGrabRequest>& Requests) {
+	for (const FTelekinesisGrabRequest& Request : Requests) {
+		if (IsValidGrabRequest(Request)) {
+			GrabComponentInSlot(Request.Slot, Request.Component, Request.GrabLocation);
+		}
+	}
+	RefreshHeldObjects();
+	// Confirm or reject the predictions as soon as possible
+	ForceNetUpdate();
+}
+
+void AESPCharacter::ServerCancelAim_Implementation() {
+	CancelAim();
+}
+
+// Mirror the client's lock-on if the server could have locked on to it too, or clear it
+void AESPCharacter::ServerSetLockOnTarget_Implementation(UPrimitiveComponent* TargetComponent) {
+	if (IsValidLockOnTarget(TargetComponent)) {
+		Target = FHitResult(TargetComponent->GetOwner(), TargetComponent, TargetComponent->GetComponentLocation(), FVector::UpVector);
+	} else {
+		Target.Init();
+	}
+	UpdateAimReticle();
+}
+
+// Let go of the thrown object and start it from the server's state
+void AESPCharacter::MulticastThrowState_Implementation(UPrimitiveComponent* Component, FVector_NetQuantize Location, FRotator Rotation, FVector_NetQuantize10 LinearVelocity, FVector_NetQuantize10 AngularVelocity) {
+	if (HasAuthority() || !Component) return;
+
+	// Predicted throws blend towards the server's state instead of snapping to it
+	const int32 PredictedIndex = PredictedThrows.IndexOfByPredicate([Component](const FPredictedThrow& Throw) {
+		return Throw.Component == Component;
+	});
+	if (PredictedIndex != INDEX_NONE) {
+		// The client threw it earlier than the server did, so compare where the server's object would be after flying as long.
+		// Thrown objects fly without gravity.
+		const float FlightTime = GetWorld()->GetTimeSeconds() - PredictedThrows[PredictedIndex].Time;
+		PredictedThrows.RemoveAtSwap(PredictedIndex);
+		const FVector Expected = FVector(Location) + FVector(LinearVelocity) * FlightTime;
+		const FVector Error = Expected - Component->GetComponentLocation();
+		RecordCorrection(Error.Size());
+		if (Error.Size() > CorrectionSnapDistance) {
+			PredictionStats.Snaps++;
+			Component->SetWorldLocationAndRotation(Expected, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+		} else if (!Error.IsNearlyZero(1.f)) {
+			ThrowCorrections.Add({ Component, Error });
+		}
+		Component->SetPhysicsLinearVelocity(LinearVelocity);
+		Component->SetPhysicsAngularVelocityInDegrees(AngularVelocity);
+		return;
+	}
+	// The server threw something the owner didn't predict
+	if (IsPredicting()) {
+		RecordCorrection(FVector::Dist(Location, Component->GetComponentLocation()));
+	}
+
+	for (int i = 0; i < PhysicsHandles.Num(); i++) {
+		if (PhysicsHandles[i]->GetGrabbedComponent() == Component) {
+			DetachFromHandle(i, false);
+		}
+	}
+	// Thrown objects keep gravity off on the server too
+	CollisionProfiles::Apply(Component, CollisionProfiles::GetThrownProfile());
+	Component->SetWorldLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	Component->SetPhysicsLinearVelocity(LinearVelocity);
+	Component->SetPhysicsAngularVelocityInDegrees(AngularVelocity);
+	if (UThrownObjectSubsystem* ThrownObjects = GetWorld()->GetSubsystem<UThrownObjectSubsystem>()) {
+		ThrownObjects->TrackThrow(Component);
+	}
+}
+
+// -----Prediction-----
+
+// Round trip time to the server in seconds
+float AESPCharacter::GetRoundTripTime() const {
+	const APlayerState* State = GetPlayerState();
+	return State ? State->GetPingInMilliseconds() / 1000.f : 0.f;
+}
+
+/**
+* Grab the swept objects right away and send them to the server to validate.
+* Slots the server still fills with an object we predicted throwing are skipped, it would reject them.
+*/
+void AESPCharacter::PredictGrabs(const TArray<FHitResult>& HitResults) {
+	TArray<FTelekinesisGrabRequest> Requests;
+	const float Now = GetWorld()->GetTimeSeconds();
+	auto IsSlotAvailable = [this](int32 Slot) {
+		const FTelekinesisHeldObject* HeldObject = HeldObjects.FindByPredicate([Slot](const FTelekinesisHeldObject& Held) {
+			return Held.Slot == Slot;
+		});
+		return !PhysicsHandles[Slot]->GetGrabbedComponent() && !(HeldObject && IsThrowPending(HeldObject->Component));
+	};
+
+	int32 Slot = 0;
+	for (const FHitResult& HitResult : HitResults) {
+		UPrimitiveComponent* Component = HitResult.GetComponent();
+		if (!Component || Component->GetOwner()->ActorHasTag("Grabbed") || IsThrowPending(Component) || IsReleasePending(Component)) continue;
+		while (Slot < PhysicsHandles.Num() && !IsSlotAvailable(Slot)) {
+			Slot++;
+		}
+		if (Slot == PhysicsHandles.Num()) break;
+
+		GrabComponentInSlot(Slot, Component, HitResult.ImpactPoint);
+		PredictedGrabs.Add({ Component, Slot, Now, Component->GetComponentLocation() });
+		FTelekinesisGrabRequest& Request = Requests.AddDefaulted_GetRef();
+		Request.Component = Component;
+		Request.Slot = Slot;
+		Request.GrabLocation = HitResult.ImpactPoint;
+		PredictionStats.PredictedGrabs++;
+	}
+	if (Requests.Num() > 0) {
+		ServerGrabComponents(Requests);
+	}
+}
+
+// Throw right away with the client's aim and tell the server which object and where
+void AESPCharacter::PredictThrow() {
+	FHitResult HitResult;
+	const int ThrowIndex = SelectThrowIndex(HitResult);
+	UPrimitiveComponent* Component = PhysicsHandles[ThrowIndex]->GetGrabbedComponent();
+	const FVector Direction = GetThrowDirection(Component, HitResult);
+
+	// A predicted grab that gets thrown isn't waiting on its handle anymore
+	PredictedGrabs.RemoveAll([ThrowIndex](const FPredictedGrab& Grab) { return Grab.Slot == ThrowIndex; });
+	PredictedThrows.Add({ Component, GetWorld()->GetTimeSeconds(), Component->GetComponentLocation() });
+	PredictionStats.PredictedThrows++;
+	ServerThrowComponent(Component, Direction);
+	ThrowComponent(ThrowIndex, Direction);
+}
+
+/**
+* Let go of everything right away and tell the server.
+* The released objects stay out of the handles until the server's held set drops them too, see SyncHeldObjects.
+*/
+void AESPCharacter::PredictRelease() {
+	const float Now = GetWorld()->GetTimeSeconds();
+	for (int i = 0; i < PhysicsHandles.Num(); i++) {
+		if (UPrimitiveComponent* Component = PhysicsHandles[i]->GetGrabbedComponent()) {
+			const bool bServerHeld = HeldObjects.ContainsByPredicate([Component](const FTelekinesisHeldObject& Held) {
+				return Held.Component == Component;
+			});
+			PredictedReleases.Add({ Component, Now, Component->GetComponentLocation(), bServerHeld });
+			DetachFromHandle(i, true);
+		}
+	}
+	// Released predicted grabs aren't waiting on their handle anymore
+	PredictedGrabs.Empty();
+	PredictionStats.PredictedReleases++;
+	ServerRelease();
+	CancelAim();
+}
+
+// Whether the server should accept a client's predicted grab
+bool AESPCharacter::IsValidGrabRequest(const FTelekinesisGrabRequest& Request) const {
+	const UPrimitiveComponent* Component = Request.Component;
+	if (IsFrozen || !IsGrabbable(Component) || !Component->GetOwner() || Component->GetOwner()->ActorHasTag("Grabbed")) return false;
+	if (!PhysicsHandles.IsValidIndex(Request.Slot) || PhysicsHandles[Request.Slot]->GetGrabbedComponent()) return false;
+	// The client swept from where it was a while ago
+	const float MaxDistance = TelekinesisConfig.GrabRange + TelekinesisConfig.GrabRadius + GrabValidationSlack;
+	return FVector::Dist(Component->GetComponentLocation(), GetActorLocation()) <= MaxDistance;
+}
+
+/**
+* Whether the server accepts a client's lock-on target.
+* Checked the same way the local lock-on sweep finds one: a living character other than this one, in front of the character
+* within the sweep's radius, within LockOnDistanceLimit, and the first thing the sweep's channel hits on the way to it.
+* The client locked on from where it was a while ago, so distances get GrabValidationSlack.
+*/
+bool AESPCharacter::IsValidLockOnTarget(const UPrimitiveComponent* TargetComponent) const {
+	const ABaseCharacter* TargetCharacter = TargetComponent ? Cast<ABaseCharacter>(TargetComponent->GetOwner()) : nullptr;
+	if (!TargetCharacter || TargetCharacter == this || !TargetCharacter->GetController()) return false;
+	if (TargetComponent->GetCollisionResponseToChannel(ECC_GameTraceChannel2) != ECR_Block) return false;
+	if (TargetCharacter->GetHorizontalDistanceTo(this) > LockOnDistanceLimit + GrabValidationSlack) return false;
+
+	// In front of the character and within the sweep's radius of its forward line
+	const FVector ToTarget = TargetComponent->GetComponentLocation() - GetActorLocation();
+	const float Along = FVector::DotProduct(ToTarget, GetActorForwardVector());
+	if (Along < 0.f || (ToTarget - Along * GetActorForwardVector()).Size() > LockOnSweepRadius + GrabValidationSlack) return false;
+
+	// Nothing else the sweep would have stopped at is in between
+	FHitResult HitResult;
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(LockOnValidation), false, this);
+	EF_INC_FRAME_COUNTER(STAT_Sweeps, Sweeps);
+	if (GetWorld()->LineTraceSingleByChannel(HitResult, GetActorLocation(), TargetComponent->GetComponentLocation(), ECC_GameTraceChannel2, Params)) {
+		return HitResult.GetActor() == TargetCharacter;
+	}
+	return true;
+}
+
+// A client's throw direction, turned towards the server's own aim until it's within ThrowValidationAngle of it
+FVector AESPCharacter::ClampThrowDirection(const FVector& ClientDirection, const FVector& ServerDirection) const {
+	if (ClientDirection.IsNearlyZero()) return ServerDirection;
+	const float Angle = FMath::Acos(FMath::Clamp(FVector::DotProduct(ClientDirection, ServerDirection), -1.f, 1.f));
+	const float MaxAngle = FMath::DegreesToRadians(ThrowValidationAngle);
+	if (Angle <= MaxAngle) return ClientDirection;
+	const FQuat ToClient = FQuat::FindBetweenNormals(ServerDirection, ClientDirection);
+	return FQuat::Slerp(FQuat::Identity, ToClient, MaxAngle / Angle).RotateVector(ServerDirection).GetSafeNormal();
+}
+
+// Whether the owner released the component and the server hasn't confirmed it yet
+bool AESPCharacter::IsReleasePending(const UPrimitiveComponent* Component) const {
+	return Component && PredictedReleases.ContainsByPredicate([Component](const FPredictedRelease& Release) {
+		return Release.Component.Get() == Component;
+	});
+}
+
+// Whether the owner threw the component and the server hasn't confirmed it yet
+bool AESPCharacter::IsThrowPending(const UPrimitiveComponent* Component) const {
+	return Component && PredictedThrows.ContainsByPredicate([Component](const FPredictedThrow& Throw) {
+		return Throw.Component.Get() == Component;
+	});
+}
+
+/**
+* Undo the predictions the server didn't confirm in time, and blend thrown objects towards the server's state.
+* Corrections move the body with a teleport so it keeps its velocity.
+*/
+void AESPCharacter::TickPrediction(float DeltaTime) {
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float Timeout = GetPredictionTimeout();
+
+	// Grabs the server never confirmed are dropped
+	for (int i = PredictedGrabs.Num() - 1; i >= 0; i--) {
+		const FPredictedGrab Grab = PredictedGrabs[i];
+		if (Now - Grab.Time < Timeout) continue;
+		PredictedGrabs.RemoveAtSwap(i);
+		UPrimitiveComponent* Component = Grab.Component.Get();
+		if (Component && PhysicsHandles[Grab.Slot]->GetGrabbedComponent() == Component) {
+			PredictionStats.RejectedGrabs++;
+			RecordCorrection(FVector::Dist(Component->GetComponentLocation(), Grab.Location));
+			DetachFromHandle(Grab.Slot, true);
+		}
+	}
+
+	// Throws the server never confirmed go back to their handle if the server still holds them
+	bool bResync = false;
+	for (int i = PredictedThrows.Num() - 1; i >= 0; i--) {
+		const FPredictedThrow Throw = PredictedThrows[i];
+		if (Now - Throw.Time < Timeout) continue;
+		PredictedThrows.RemoveAtSwap(i);
+		if (UPrimitiveComponent* Component = Throw.Component.Get()) {
+			RecordCorrection(FVector::Dist(Component->GetComponentLocation(), Throw.Location));
+		}
+		bResync = true;
+	}
+	// Releases the server never confirmed go back to their handle if the server still holds them
+	for (int i = PredictedReleases.Num() - 1; i >= 0; i--) {
+		const FPredictedRelease Release = PredictedReleases[i];
+		if (Now - Release.Time < Timeout) continue;
+		PredictedReleases.RemoveAtSwap(i);
+		UPrimitiveComponent* Component = Release.Component.Get();
+		if (Component && HeldObjects.ContainsByPredicate([Component](const FTelekinesisHeldObject& Held) { return Held.Component == Component; })) {
+			RecordCorrection(FVector::Dist(Component->GetComponentLocation(), Release.Location));
+			bResync = true;
+		}
+	}
+	if (bResync) {
+		SyncHeldObjects();
+	}
+
+	const float Alpha = 1.f - FMath::Exp(-DeltaTime / FMath::Max(CorrectionSmoothingTime, KINDA_SMALL_NUMBER));
+	for (int i = ThrowCorrections.Num() - 1; i >= 0; i--) {
+		UPrimitiveComponent* Component = ThrowCorrections[i].Component.Get();
+		if (!Component || ThrowCorrections[i].RemainingError.IsNearlyZero(0.1f)) {
+			ThrowCorrections.RemoveAtSwap(i);
+			continue;
+		}
+		const FVector Step = ThrowCorrections[i].RemainingError * Alpha;
+		Component->SetWorldLocation(Component->GetComponentLocation() + Step, false, nullptr, ETeleportType::TeleportPhysics);
+		ThrowCorrections[i].RemainingError -= Step;
+	}
+}
+
+// Count a correction, errors under a centimeter are within the replicated state's quantization
+void AESPCharacter::RecordCorrection(float Magnitude) {
+	if (Magnitude < 1.f) return;
+	PredictionStats.Corrections++;
+	PredictionStats.TotalCorrection += Magnitude;
+	PredictionStats.MaxCorrection = FMath::Max(PredictionStats.MaxCorrection, Magnitude);
+	EF_INC_FRAME_COUNTER(STAT_PredictionCorrections, PredictionCorrections);
+	CSV_CUSTOM_STAT(ExtrasensoryFun, PredictionCorrectionMax, Magnitude, ECsvCustomStatOp::Max);
+}
+
 // Allows Blueprint implementation of these CPP functions
 void AESPCharacter::StartAiming_Implementation() {
 }
@@ -751,3 +1419,208 @@ void AESPCharacter::StartAiming_Implementation() {
 void AESPCharacter::StopAiming_Implementation() {
 	
 }
+
+// -----Console commands-----
+
+// Server to client bytes sent on each connection so far
+static TMap<UNetConnection*, int64> SampleOutBytes(UWorld* World) {
+	TMap<UNetConnection*, int64> Bytes;
+	for (UNetConnection* Connection : World->GetNetDriver()->ClientConnections) {
+		Bytes.Add(Connection, Connection->OutTotalBytes);
+	}
+	return Bytes;
+}
+
+/**
+* Measures the server to client bandwidth of telekinesis.
+* Meant for a listen server with clients in the same process, e.g. PIE with "Play As Listen Server" and a few clients.
+* Samples every connection while idle, then with each ESP character holding the closest grabbable objects
+* while the characters the server controls spin so the handle targets keep changing.
+*/
+static void TelekinesisBandwidthTest(const TArray<FString>& Args, UWorld* World) {
+	if (!World->GetNetDriver() || World->GetNetMode() == NM_Client || World->GetNetDriver()->ClientConnections.Num() == 0) {
+		UE_LOG(LogTemp, Error, TEXT("Telekinesis bandwidth test: run it on a server with clients connected"));
+		return;
+	}
+	const float Seconds = Args.Num() > 0 ? FMath::Max(FCString::Atof(*Args[0]), 1.f) : 5.f;
+	const int32 ObjectsPerCharacter = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 10;
+	TWeakObjectPtr<UWorld> WeakWorld(World);
+
+	// Idle baseline first
+	TMap<UNetConnection*, int64> IdleStart = SampleOutBytes(World);
+	FTimerHandle Unused;
+	World->GetTimerManager().SetTimer(Unused, [WeakWorld, IdleStart, Seconds, ObjectsPerCharacter]() {
+		UWorld* World = WeakWorld.Get();
+		if (!World) return;
+		TMap<UNetConnection*, int64> IdleEnd = SampleOutBytes(World);
+
+		// Every ESP character grabs the grabbable objects closest to it
+		TArray<UPrimitiveComponent*> Grabbables;
+		for (TActorIterator<AActor> It(World); It; ++It) {
+			TInlineComponentArray<UPrimitiveComponent*> Components(*It);
+			for (UPrimitiveComponent* Component : Components) {
+				if (AESPCharacter::IsGrabbable(Component)) {
+					Grabbables.Add(Component);
+				}
+			}
+		}
+		int32 TotalHeld = 0;
+		for (TActorIterator<AESPCharacter> It(World); It; ++It) {
+			const FVector Location = It->GetActorLocation();
+			Grabbables.Sort([&Location](const UPrimitiveComponent& A, const UPrimitiveComponent& B) {
+				return FVector::DistSquared(A.GetComponentLocation(), Location) < FVector::DistSquared(B.GetComponentLocation(), Location);
+			});
+			for (UPrimitiveComponent* Component : Grabbables) {
+				if (It->GetHeldObjectCount() >= ObjectsPerCharacter) break;
+				It->GrabComponent(Component, Component->GetComponentLocation());
+			}
+			TotalHeld += It->GetHeldObjectCount();
+		}
+
+		// Remotely controlled characters move with their client's input, the rest spin in place
+		TSharedRef<FTimerHandle> SpinHandle = MakeShared<FTimerHandle>();
+		World->GetTimerManager().SetTimer(*SpinHandle, [WeakWorld]() {
+			if (UWorld* World = WeakWorld.Get()) {
+				for (TActorIterator<AESPCharacter> It(World); It; ++It) {
+					if (It->IsLocallyControlled() || !It->IsPlayerControlled()) {
+						It->AddActorWorldRotation(FRotator(0.f, 3.f, 0.f));
+					}
+				}
+			}
+		}, 1.f / 30.f, true);
+
+		TMap<UNetConnection*, int64> HeldStart = SampleOutBytes(World);
+		FTimerHandle Unused;
+		World->GetTimerManager().SetTimer(Unused, [WeakWorld, IdleStart, IdleEnd, HeldStart, Seconds, TotalHeld, SpinHandle]() {
+			UWorld* World = WeakWorld.Get();
+			if (!World) return;
+			World->GetTimerManager().ClearTimer(*SpinHandle);
+			TMap<UNetConnection*, int64> HeldEnd = SampleOutBytes(World);
+			for (TActorIterator<AESPCharacter> It(World); It; ++It) {
+				It->Release();
+			}
+
+			UE_LOG(LogTemp, Display, TEXT("Telekinesis bandwidth test: %d objects held, %.0f s per phase"), TotalHeld, Seconds);
+			for (const TPair<UNetConnection*, int64>& Pair : HeldEnd) {
+				if (!IdleStart.Contains(Pair.Key) || !IdleEnd.Contains(Pair.Key) || !HeldStart.Contains(Pair.Key)) continue;
+				const double IdleRate = (IdleEnd[Pair.Key] - IdleStart[Pair.Key]) / Seconds;
+				const double HeldRate = (Pair.Value - HeldStart[Pair.Key]) / Seconds;
+				UE_LOG(LogTemp, Display, TEXT("  %s: idle %.0f B/s, holding %.0f B/s (+%.0f B/s)"),
+					*Pair.Key->LowLevelGetRemoteAddress(true), IdleRate, HeldRate, HeldRate - IdleRate);
+			}
+		}, Seconds, false);
+	}, Seconds, false);
+	UE_LOG(LogTemp, Display, TEXT("Telekinesis bandwidth test: sampling for %.0f s idle, then %.0f s holding"), Seconds, Seconds);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs TelekinesisBandwidthTestCommand(
+	TEXT("ef.Telekinesis.BandwidthTest"),
+	TEXT("Reports server to client bytes per second with every ESP character holding objects. Usage: ef.Telekinesis.BandwidthTest [Seconds=5] [ObjectsPerCharacter=10]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&TelekinesisBandwidthTest)
+);
+
+/**
+* Measures how often and how far the owning client's telekinesis predictions get corrected.
+* Run it on a client, it emulates latency and packet loss locally with the net driver's packet simulation in both directions,
+* then drives the local ESP character through grab, aim and throw cycles like the perf harness bot.
+*/
+static void TelekinesisPredictionTest(const TArray<FString>& Args, UWorld* World) {
+#if DO_ENABLE_NET_TEST
+	APlayerController* PlayerController = World->GetFirstPlayerController();
+	AESPCharacter* Character = PlayerController ? Cast<AESPCharacter>(PlayerController->GetPawn()) : nullptr;
+	UNetDriver* NetDriver = World->GetNetDriver();
+	if (World->GetNetMode() != NM_Client || !Character || !NetDriver) {
+		UE_LOG(LogTemp, Error, TEXT("Telekinesis prediction test: run it on a client controlling an ESP character"));
+		return;
+	}
+	const int32 LagMs = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 150;
+	const int32 LossPercent = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 5;
+	const float Seconds = Args.Num() > 2 ? FMath::Max(FCString::Atof(*Args[2]), 1.f) : 30.f;
+
+	// Half the round trip each way
+	const FPacketSimulationSettings PreviousSettings = NetDriver->PacketSimulationSettings;
+	FPacketSimulationSettings Settings;
+	Settings.PktLag = LagMs / 2;
+	Settings.PktIncomingLagMin = LagMs / 2;
+	Settings.PktIncomingLagMax = LagMs / 2;
+	Settings.PktLoss = LossPercent;
+	Settings.PktIncomingLoss = LossPercent;
+	NetDriver->SetPacketSimulationSettings(Settings);
+	Character->ResetPredictionStats();
+
+	struct FCycle {
+		float Elapsed = 0.f;
+		float CycleTimer = 0.f;
+		float ThrowTimer = 0.f;
+		bool bGrabbing = false;
+		bool bAimStarted = false;
+		FTimerHandle Handle;
+	};
+	TSharedRef<FCycle> Cycle = MakeShared<FCycle>();
+	constexpr float Interval = 1.f / 30.f;
+	constexpr float GrabTime = 1.5f;
+	constexpr float CycleTime = 4.f;
+	constexpr float ThrowInterval = 0.2f;
+	TWeakObjectPtr<AESPCharacter> WeakCharacter(Character);
+	TWeakObjectPtr<UNetDriver> WeakNetDriver(NetDriver);
+
+	World->GetTimerManager().SetTimer(Cycle->Handle, [Cycle, WeakCharacter, WeakNetDriver, PreviousSettings, Seconds, LagMs, LossPercent]() {
+		AESPCharacter* Character = WeakCharacter.Get();
+		if (!Character) return;
+		Cycle->Elapsed += Interval;
+		Cycle->CycleTimer += Interval;
+
+		if (Cycle->Elapsed >= Seconds) {
+			Character->GetWorldTimerManager().ClearTimer(Cycle->Handle);
+			Character->StopGrabbing();
+			Character->CancelAim();
+			if (UNetDriver* NetDriver = WeakNetDriver.Get()) {
+				NetDriver->SetPacketSimulationSettings(PreviousSettings);
+			}
+			const FTelekinesisPredictionStats& Stats = Character->GetPredictionStats();
+			UE_LOG(LogTemp, Display, TEXT("Telekinesis prediction test: %d ms round trip, %d%% loss, %.0f s"), LagMs, LossPercent, Seconds);
+			UE_LOG(LogTemp, Display, TEXT("  %d predicted grabs (%d rejected), %d predicted throws, %d predicted releases"), Stats.PredictedGrabs, Stats.RejectedGrabs, Stats.PredictedThrows, Stats.PredictedReleases);
+			UE_LOG(LogTemp, Display, TEXT("  %d corrections (%.2f/s, %d snapped), mean %.1f cm, max %.1f cm"),
+				Stats.Corrections, Stats.Corrections / Seconds, Stats.Snaps,
+				Stats.Corrections > 0 ? Stats.TotalCorrection / Stats.Corrections : 0.0, Stats.MaxCorrection);
+			return;
+		}
+
+		// Grab for GrabTime, freeze to aim, throw at ThrowInterval, then cancel whatever's left at the end of the cycle
+		if (Cycle->CycleTimer < GrabTime) {
+			if (!Cycle->bGrabbing) {
+				Character->StartGrabbing();
+				Cycle->bGrabbing = true;
+			}
+		} else if (Cycle->CycleTimer < CycleTime) {
+			if (Cycle->bGrabbing) {
+				Character->StopGrabbing();
+				Cycle->bGrabbing = false;
+			}
+			if (!Cycle->bAimStarted && Character->GetHeldObjectCount() > 0) {
+				Character->ThrowAim();
+				Cycle->bAimStarted = true;
+			}
+			Cycle->ThrowTimer -= Interval;
+			if (Cycle->bAimStarted && Character->GetIsAiming() && Cycle->ThrowTimer <= 0.f) {
+				Character->Throw();
+				Cycle->ThrowTimer = ThrowInterval;
+			}
+		} else {
+			Character->CancelAim();
+			Cycle->CycleTimer = 0.f;
+			Cycle->ThrowTimer = 0.f;
+			Cycle->bAimStarted = false;
+		}
+	}, Interval, true);
+	UE_LOG(LogTemp, Display, TEXT("Telekinesis prediction test: running for %.0f s"), Seconds);
+#else
+	UE_LOG(LogTemp, Error, TEXT("Telekinesis prediction test: packet simulation isn't compiled into this build"));
+#endif
+}
+
+static FAutoConsoleCommandWithWorldAndArgs TelekinesisPredictionTestCommand(
+	TEXT("ef.Telekinesis.PredictionTest"),
+	TEXT("Reports telekinesis prediction corrections under emulated latency and packet loss. Usage: ef.Telekinesis.PredictionTest [RoundTripMs=150] [LossPercent=5] [Seconds=30]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&TelekinesisPredictionTest)
+);
@@ -4,8 +4,56 @@
 
 #include "CoreMinimal.h"
 #include "BaseCharacter.h"
+#include "TelekinesisMath.h"
+#include "Engine/NetSerialization.h"
 #include "ESPCharacter.generated.h"
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAimReticleChanged, bool, bVisible);
+
+// An object held with telekinesis, as replicated to clients
+USTRUCT()
+struct FTelekinesisHeldObject {
+
+	GENERATED_USTRUCT_BODY()
+
+	// Replicates as the object's net ID, null on clients that can't resolve it
+	UPROPERTY()
+	UPrimitiveComponent* Component = nullptr;
+	// Physics handle index
+	UPROPERTY()
+	uint8 Slot = 0;
+	// Position relative to the character recorded when grabbing it, lets the owning client compute its own handle targets
+	UPROPERTY()
+	FVector_NetQuantize GrabPosFromChar;
+};
+
+// A grab the owning client predicted, for the server to validate
+USTRUCT()
+struct FTelekinesisGrabRequest {
+
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	UPrimitiveComponent* Component = nullptr;
+	UPROPERTY()
+	uint8 Slot = 0;
+	UPROPERTY()
+	FVector_NetQuantize GrabLocation;
+};
+
+// How often and how far the owning client's predictions had to be corrected
+struct FTelekinesisPredictionStats {
+	int32 PredictedGrabs = 0;
+	int32 RejectedGrabs = 0;
+	int32 PredictedThrows = 0;
+	int32 PredictedReleases = 0;
+	int32 Corrections = 0;
+	// Corrections too large to blend
+	int32 Snaps = 0;
+	double TotalCorrection = 0.0;
+	float MaxCorrection = 0.f;
+};
+
 // Struct for telekinesis properties
 USTRUCT()
 struct FTelekinesis {
@@ -61,13 +109,43 @@ public:
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 	// Called when movement mode changes
 	virtual void OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PrevCustomMode) override;
+	// Undo HandleDeath and drop everything the character was holding
+	virtual void Revive() override;
+	// Update the aim reticle as well, the target was hiding it
+	virtual void ResetTargeting() override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	// Returns true if the component can be grabbed with telekinesis
+	static bool IsGrabbable(const UPrimitiveComponent* Component);
+
+	// Grab a component with the first available physics handle
+	bool GrabComponent(UPrimitiveComponent* HitComponent, const FVector& GrabLocation);
+	// Release all grabbed objects at once
+	void Release();
+
+	// Telekinesis actions, bound to player input and also driven by bots
+	void StartGrabbing();
+	void StopGrabbing();
+	void ThrowAim();
+	void Throw();
+	void CancelAim();
+	// Number of objects currently held with the physics handles
+	int32 GetHeldObjectCount() const;
+
+	const FTelekinesisPredictionStats& GetPredictionStats() const { return PredictionStats; }
+	void ResetPredictionStats() { PredictionStats = FTelekinesisPredictionStats(); }
+
+	// Called when the aim reticle should be shown or hidden, i.e. when the character freezes to aim without a target
+	UPROPERTY(BlueprintAssignable)
+	FOnAimReticleChanged OnAimReticleChanged;
+	bool IsAimReticleVisible() const { return bAimReticleVisible; }
 
 	// Getter Methods
 	bool GetIsFrozen() { return IsFrozen; }
 	bool GetIsAiming() { return IsAiming; }
 
 	// Setter Methods
-	void SetIsFrozen(bool bIsFrozen) { IsFrozen = bIsFrozen; }
+	void SetIsFrozen(bool bIsFrozen) { IsFrozen = bIsFrozen; UpdateAimReticle(); }
 	void SetIsAiming(bool bIsAiming) { IsAiming = bIsAiming; }
 
 	// Blueprint functions to call from CPP
@@ -83,16 +161,12 @@ private:
 	// Functions and property for grabbing
 	bool GetGrabbableObjectsInReach(TArray<FHitResult>& OutHitResults) const;
 	void SortHitResults(TArray<FHitResult>& OutHitResults) const;
+	bool HasAvailableHandle() const;
 	bool IsGrabbing = false;
-	void StartGrabbing();
-	void StopGrabbing();
 	void Grab();
 	UFUNCTION(BlueprintCallable, BlueprintPure)
 	bool IsGrabbingObject();
-	// Release all grabbed objects at once
-	void Release();
 	// Functions and properties for throwing
-	void ThrowAim();
 	bool IsFrozen = false;
 	float AimTimer = 0.f;
 	float AimTime = 0.5f;
@@ -100,11 +174,23 @@ private:
 	bool IsAiming = false;
 	FVector FreezeLocation;
 	bool ThrowAimTrace(FHitResult& OutHitResult) const;
-	int GetClosestGrabbedObject(FHitResult* HitResult) const;
+	int GetClosestGrabbedObject(const FHitResult* HitResult) const;
 	int GetFarthestGrabbedObject() const;
-	void Throw();
-	void CancelAim();
+	// Character state shared by the telekinesis math
+	TelekinesisMath::FCharacterFrame GetTelekinesisFrame() const;
+	// Handle index of the object to throw, from GetClosestGrabbedObject or GetFarthestGrabbedObject
+	int SelectThrowIndex(FHitResult& OutHitResult) const;
+	FVector GetThrowDirection(const UPrimitiveComponent* Component, const FHitResult& HitResult) const;
+	// Throw the selected object, server only
+	void ThrowGrabbedObject();
+	// Release a physics handle's object with the throw impulse
+	void ThrowComponent(int32 Slot, const FVector& Direction);
+	// Grab a component with a specific physics handle
+	void GrabComponentInSlot(int32 Slot, UPrimitiveComponent* HitComponent, const FVector& GrabLocation);
 	virtual void TargetLockOn() override;
+	// Broadcast OnAimReticleChanged if the frozen/target state changed since the last call
+	void UpdateAimReticle();
+	bool bAimReticleVisible = false;
 	
 	
 	// -----Jumping-----
@@ -115,9 +201,9 @@ private:
 	float JumpTime = 0.2f;
 	// Jump VFX
 	UPROPERTY(EditAnywhere)
-	UParticleSystem* SecondJumpFX;
+	TSoftObjectPtr<UParticleSystem> SecondJumpFX;
 	UPROPERTY(EditAnywhere)
-	UParticleSystem* ThirdJumpFX;
+	TSoftObjectPtr<UParticleSystem> ThirdJumpFX;
 	UParticleSystemComponent* JumpEmitterLeft1;
 	UParticleSystemComponent* JumpEmitterRight1;
 	UParticleSystemComponent* JumpEmitterLeft2;
@@ -135,18 +221,135 @@ private:
 	// -----Telekinesis FX-----
 	// Particles for telekinesis casting effect
 	UPROPERTY(EditAnywhere, Category = "Telekinesis FX")
-	UParticleSystem* MuzzleCast;
+	TSoftObjectPtr<UParticleSystem> MuzzleCast;
 	UPROPERTY(EditAnywhere, Category = "Telekinesis FX")
-	UParticleSystem* MuzzleAim;
+	TSoftObjectPtr<UParticleSystem> MuzzleAim;
 	UPROPERTY(EditAnywhere, Category = "Telekinesis FX")
-	UParticleSystem* MuzzleGlow;
+	TSoftObjectPtr<UParticleSystem> MuzzleGlow;
+	// Spawns the emitters below, once the particle systems are loaded
+	void SpawnEmitters();
 	UParticleSystemComponent* CastEmitter;
 	UParticleSystemComponent* AimEmitter;
 	UParticleSystemComponent* GlowEmitter;
 	// Decals for objects being grabbed
 	TArray<UDecalComponent*> TelekinesisDecals;
 	UPROPERTY(EditAnywhere, Category = "Telekinesis FX")
-	UMaterialInstance* TelekinesisDecalMaterial;
+	TSoftObjectPtr<UMaterialInstance> TelekinesisDecalMaterial;
 	// Attaches a decal to an object being grabbed
 	void AttachTelekinesisDecal(UPrimitiveComponent* HitComponent, int Index);
+
+	// -----Replication-----
+	/**
+	* The server owns grabbing and throwing, clients ask for them through the Server RPCs below.
+	* Clients only get the held set and quantized handle targets, and simulate the held objects locally with their own physics handles.
+	* The objects' full physics state is only sent when they're thrown.
+	*/
+	UPROPERTY(ReplicatedUsing = OnRep_HeldObjects)
+	TArray<FTelekinesisHeldObject> HeldObjects;
+	// Handle targets relative to the character, indexed like HeldObjects. The owner computes its own.
+	UPROPERTY(Replicated)
+	TArray<FVector_NetQuantize> HeldTargets;
+	UFUNCTION()
+	void OnRep_HeldObjects();
+	// Grab and release objects on the handles to match HeldObjects
+	void SyncHeldObjects();
+	// Rebuild HeldObjects from the physics handles after grabbing or releasing, server only
+	void RefreshHeldObjects();
+	// Write the handle targets of the grabbed slots to HeldTargets, server only
+	void UpdateHeldTargets(TArrayView<const int32> HandleIndices, TArrayView<const FVector> HandleTargets);
+	// Handle targets of the grabbed slots from HeldTargets, for simulated proxies
+	void GetReplicatedHandleTargets(TArrayView<const int32> HandleIndices, TArrayView<FVector> OutHandleTargets) const;
+	// Set up a component to be held by a physics handle, on the server and clients alike
+	void AttachToHandle(int32 Slot, UPrimitiveComponent* HitComponent, const FVector& GrabLocation);
+	// Let go of a physics handle's component, thrown objects keep gravity off like they always have
+	void DetachFromHandle(int32 Slot, bool bRestoreGravity);
+
+	UFUNCTION(Server, Reliable)
+	void ServerStartGrabbing();
+	UFUNCTION(Server, Reliable)
+	void ServerStopGrabbing();
+	UFUNCTION(Server, Reliable)
+	void ServerRelease();
+	UFUNCTION(Server, Reliable)
+	void ServerThrowAim();
+	UFUNCTION(Server, Reliable)
+	void ServerThrowComponent(UPrimitiveComponent* Component, FVector_NetQuantizeNormal Direction);
+	UFUNCTION(Server, Reliable)
+	void ServerGrabComponents(const TArray<FTelekinesisGrabRequest>& Requests);
+	UFUNCTION(Server, Reliable)
+	void ServerCancelAim();
+	// Lock-on is local to the player, the server needs the target for grab sweeps and throws
+	UFUNCTION(Server, Reliable)
+	void ServerSetLockOnTarget(UPrimitiveComponent* TargetComponent);
+	// Full physics state of a thrown object, the only time clients get it
+	UFUNCTION(NetMulticast, Reliable)
+	void MulticastThrowState(UPrimitiveComponent* Component, FVector_NetQuantize Location, FRotator Rotation, FVector_NetQuantize10 LinearVelocity, FVector_NetQuantize10 AngularVelocity);
+
+	// -----Prediction-----
+	/**
+	* The owning client grabs, throws and releases right away instead of waiting a round trip.
+	* The server validates each predicted grab and throw, predictions it never confirms are undone once they time out,
+	* and thrown objects are blended towards the server's state instead of snapping to it.
+	*/
+	struct FPredictedGrab {
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		int32 Slot;
+		float Time;
+		FVector Location;
+	};
+	struct FPredictedThrow {
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		float Time;
+		FVector Location;
+	};
+	struct FPredictedRelease {
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		float Time;
+		FVector Location;
+		// Whether the server's held set has had it since, its release is confirmed once it's gone from it again
+		bool bServerHeld;
+	};
+	struct FThrowCorrection {
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		FVector RemainingError;
+	};
+	TArray<FPredictedGrab> PredictedGrabs;
+	TArray<FPredictedThrow> PredictedThrows;
+	TArray<FPredictedRelease> PredictedReleases;
+	TArray<FThrowCorrection> ThrowCorrections;
+	FTelekinesisPredictionStats PredictionStats;
+	// Minimum time to wait for the server to confirm a prediction, at least a round trip is always allowed
+	UPROPERTY(EditAnywhere, Category = "Prediction")
+	float PredictionTimeout = 0.5f;
+	// Time for thrown objects to cover most of their correction
+	UPROPERTY(EditAnywhere, Category = "Prediction")
+	float CorrectionSmoothingTime = 0.1f;
+	// Corrections larger than this snap instead of blending
+	UPROPERTY(EditAnywhere, Category = "Prediction")
+	float CorrectionSnapDistance = 500.f;
+	// Extra distance allowed when validating predicted grabs, since the client grabbed from where it was a while ago
+	UPROPERTY(EditAnywhere, Category = "Prediction")
+	float GrabValidationSlack = 300.f;
+	// Largest angle in degrees between a client's throw and the server's own aim, throws further off are turned back within it
+	UPROPERTY(EditAnywhere, Category = "Prediction")
+	float ThrowValidationAngle = 20.f;
+
+	// Owning client of a networked character
+	bool IsPredicting() const { return !HasAuthority() && IsLocallyControlled(); }
+	// Server copy of a character a client predicts for
+	bool IsRemotelyPredicted() const { return HasAuthority() && IsPlayerControlled() && !IsLocallyControlled(); }
+	float GetRoundTripTime() const;
+	float GetPredictionTimeout() const { return FMath::Max(PredictionTimeout, 2.f * GetRoundTripTime()); }
+	// Grab the swept objects locally and ask the server for them
+	void PredictGrabs(const TArray<FHitResult>& HitResults);
+	void PredictThrow();
+	void PredictRelease();
+	bool IsValidGrabRequest(const FTelekinesisGrabRequest& Request) const;
+	FVector ClampThrowDirection(const FVector& ClientDirection, const FVector& ServerDirection) const;
+	bool IsValidLockOnTarget(const UPrimitiveComponent* TargetComponent) const;
+	bool IsThrowPending(const UPrimitiveComponent* Component) const;
+	bool IsReleasePending(const UPrimitiveComponent* Component) const;
+	// Undo timed out predictions and blend thrown objects towards the server's state
+	void TickPrediction(float DeltaTime);
+	void RecordCorrection(float Magnitude);
 };
\ No newline at end of file
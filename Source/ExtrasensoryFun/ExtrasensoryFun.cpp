@@ -2,5 +2,27 @@
 
 #include "ExtrasensoryFun.h"
 #include "Modules/ModuleManager.h"
+#include "GameplayEventLog.h"
+#include "ExtrasensoryFunStats.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, ExtrasensoryFun, "ExtrasensoryFun" );
+// Counters shared between files, see ExtrasensoryFunStats.h
+DEFINE_STAT(STAT_HeldObjects);
+DEFINE_STAT(STAT_Sweeps);
+DEFINE_STAT(STAT_ProjectilesAlive);
+DEFINE_STAT(STAT_LineOfSightTraces);
+DEFINE_STAT(STAT_PredictionCorrections);
+CSV_DEFINE_CATEGORY_MODULE(EXTRASENSORYFUN_API, ExtrasensoryFun, true);
+
+// Game module, starts and stops the module-wide services
+class FExtrasensoryFunModule : public FDefaultGameModuleImpl {
+public:
+	virtual void StartupModule() override {
+		FGameplayEventLog::Get().Start();
+	}
+
+	virtual void ShutdownModule() override {
+		FGameplayEventLog::Get().Stop();
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FExtrasensoryFunModule, ExtrasensoryFun, "ExtrasensoryFun" );
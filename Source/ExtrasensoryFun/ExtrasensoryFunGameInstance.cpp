@@ -0,0 +1,184 @@
+// by Jason Hilani
+
+
+#include "ExtrasensoryFunGameInstance.h"
+#include "ESPCharacter.h"
+#include "SoftAssets.h"
+#include "ExtrasensoryFunLoadingScreen.h"
+#include "GameFramework/PlayerController.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/PackageName.h"
+#include "UObject/UObjectHash.h"
+
+static TAutoConsoleVariable<int32> CVarPreload(
+	TEXT("ef.Assets.Preload"),
+	1,
+	TEXT("Preload the manifest's soft references when the game starts. Turning it off still loads them through soft references, it isn't the hard-reference baseline."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<int32> CVarPrefetchMap(
+	TEXT("ef.Loading.Prefetch"),
+	1,
+	TEXT("Prefetch the main level's package dependencies once the menu is loaded. Use -dpcvars=ef.Loading.Prefetch=0 to compare transitions."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<int32> CVarLoadingScreen(
+	TEXT("ef.Loading.Screen"),
+	1,
+	TEXT("Show the loading screen during map loads."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarLoadingScreenMinTime(
+	TEXT("ef.Loading.MinDisplayTime"),
+	0.f,
+	TEXT("Minimum time the loading screen stays up, in seconds, so very short loads don't just flash it."),
+	ECVF_Default
+);
+
+void UExtrasensoryFunGameInstance::Init() {
+	Super::Init();
+
+	PreLoadMapHandle = FCoreUObjectDelegates::PreLoadMap.AddUObject(this, &UExtrasensoryFunGameInstance::OnPreLoadMap);
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddUObject(this, &UExtrasensoryFunGameInstance::OnEndFrame);
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UExtrasensoryFunGameInstance::OnPostLoadMap);
+	bWaitingForPlayableFrame = true;
+	if (CVarPreload.GetValueOnGameThread() != 0) {
+		StartPreload();
+	}
+}
+
+void UExtrasensoryFunGameInstance::Shutdown() {
+	FCoreUObjectDelegates::PreLoadMap.Remove(PreLoadMapHandle);
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+	Super::Shutdown();
+}
+
+// Load the manifest's classes in the background, their soft references follow once they're in
+void UExtrasensoryFunGameInstance::StartPreload() {
+	TArray<FSoftObjectPath> Paths;
+	for (const FSoftClassPath& Class : PreloadClasses) {
+		Paths.Add(Class);
+	}
+	PreloadStartTime = FPlatformTime::Seconds();
+	bPreloading = true;
+	SoftAssets::LoadThen(MoveTemp(Paths), FStreamableDelegate::CreateUObject(this, &UExtrasensoryFunGameInstance::OnPreloadClassesLoaded));
+}
+
+// Request the soft references of every manifest class
+void UExtrasensoryFunGameInstance::OnPreloadClassesLoaded() {
+	int32 NumClasses = 0;
+	for (const FSoftClassPath& ClassPath : PreloadClasses) {
+		if (const UClass* Class = ClassPath.ResolveClass()) {
+			SoftAssets::RequestSoftReferences(Class->GetDefaultObject());
+			NumClasses++;
+		} else {
+			UE_LOG(LogTemp, Warning, TEXT("Preload manifest: couldn't load %s"), *ClassPath.ToString());
+		}
+	}
+	UE_LOG(LogTemp, Display, TEXT("Preload manifest: %d classes loaded in %.1f ms"), NumClasses, (FPlatformTime::Seconds() - PreloadStartTime) * 1000.0);
+}
+
+/**
+* Start the prefetch of PrefetchMap's package dependencies.
+* Only the direct dependencies are requested, loading them pulls in their own imports. Soft references aren't dependencies
+* of the map, they're preloaded through the preload manifest.
+*/
+void UExtrasensoryFunGameInstance::StartPrefetch() {
+	bPrefetchStarted = true;
+	// The editor has everything loaded already, and its asset registry may still be scanning
+	if (GIsEditor || PrefetchMap.IsEmpty()) return;
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+	TArray<FName> Dependencies;
+	AssetRegistry.GetDependencies(FName(*PrefetchMap), Dependencies, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Hard);
+	if (Dependencies.Num() == 0) {
+		UE_LOG(LogTemp, Warning, TEXT("Map prefetch: no dependencies found for %s, is the asset registry cooked with its dependencies?"), *PrefetchMap);
+		return;
+	}
+
+	PrefetchStartTime = FPlatformTime::Seconds();
+	for (const FName& Dependency : Dependencies) {
+		const FString PackageName = Dependency.ToString();
+		// Native packages are always loaded
+		if (FPackageName::IsScriptPackage(PackageName)) continue;
+		PrefetchPending++;
+		LoadPackageAsync(PackageName, FLoadPackageAsyncDelegate::CreateUObject(this, &UExtrasensoryFunGameInstance::OnPrefetchPackageLoaded));
+	}
+	UE_LOG(LogTemp, Display, TEXT("Map prefetch: loading %d packages for %s"), PrefetchPending, *PrefetchMap);
+}
+
+// Keep the package's assets, nothing else references them until the map is loaded
+void UExtrasensoryFunGameInstance::OnPrefetchPackageLoaded(const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result) {
+	PrefetchPending--;
+	if (Package && Result == EAsyncLoadingResult::Succeeded) {
+		ForEachObjectWithPackage(Package, [this](UObject* Object) {
+			if (Object->IsAsset()) {
+				PrefetchedAssets.Add(Object);
+			}
+			return true;
+		}, false);
+	} else {
+		UE_LOG(LogTemp, Warning, TEXT("Map prefetch: couldn't load %s"), *PackageName.ToString());
+	}
+	if (PrefetchPending == 0) {
+		UE_LOG(LogTemp, Display, TEXT("Map prefetch: %d assets loaded in %.1f ms"), PrefetchedAssets.Num(), (FPlatformTime::Seconds() - PrefetchStartTime) * 1000.0);
+	}
+}
+
+// Show the loading screen and time the next map load until its first playable frame
+void UExtrasensoryFunGameInstance::OnPreLoadMap(const FString& MapName) {
+	MapLoadStartTime = FPlatformTime::Seconds();
+	MapLoadedTime = 0.0;
+	LoadingMapName = MapName;
+	bWaitingForPlayableFrame = true;
+	if (CVarLoadingScreen.GetValueOnGameThread() != 0) {
+		IExtrasensoryFunLoadingScreenModule& LoadingScreen = IExtrasensoryFunLoadingScreenModule::Get();
+		if (LoadingScreen.IsAvailable()) {
+			LoadingScreen.StartLoadingScreen(MapName, CVarLoadingScreenMinTime.GetValueOnGameThread());
+		}
+	}
+}
+
+// The map is loaded, start prefetching the main level if it's the first one
+void UExtrasensoryFunGameInstance::OnPostLoadMap(UWorld* World) {
+	MapLoadedTime = FPlatformTime::Seconds();
+	if (!bPrefetchStarted && CVarPrefetchMap.GetValueOnGameThread() != 0) {
+		StartPrefetch();
+	}
+}
+
+/**
+* Log once the preload is done, once the first map has begun play after launching,
+* and once the local player has an ESP character to play with after loading a map.
+* The cold start stops at the first map, usually the menu, so it doesn't include time spent in the menu.
+*/
+void UExtrasensoryFunGameInstance::OnEndFrame() {
+	const double Now = FPlatformTime::Seconds();
+	if (bPreloading && SoftAssets::GetNumPending() == 0) {
+		bPreloading = false;
+		UE_LOG(LogTemp, Display, TEXT("Preload manifest: done in %.1f ms"), (Now - PreloadStartTime) * 1000.0);
+	}
+	const UWorld* World = GetWorld();
+	if (!World || !World->HasBegunPlay()) return;
+	if (bColdStart) {
+		bColdStart = false;
+		UE_LOG(LogTemp, Display, TEXT("Cold start: first frame of %s %.2f s after launch, preload %s"),
+			*World->GetMapName(), Now - GStartTime, bPreloading ? TEXT("still running") : TEXT("done or off"));
+	}
+	if (!bWaitingForPlayableFrame) return;
+
+	const APlayerController* PlayerController = GetFirstLocalPlayerController();
+	if (!PlayerController || !PlayerController->GetPawn<AESPCharacter>()) return;
+	bWaitingForPlayableFrame = false;
+	if (MapLoadStartTime > 0.0) {
+		UE_LOG(LogTemp, Display, TEXT("%s: map loaded in %.2f s, first playable frame %.2f s after the map load started and %.2f s after launch, prefetch %s"),
+			*LoadingMapName, MapLoadedTime > 0.0 ? MapLoadedTime - MapLoadStartTime : 0.0, Now - MapLoadStartTime, Now - GStartTime,
+			!bPrefetchStarted ? TEXT("off") : PrefetchPending > 0 ? TEXT("still running") : TEXT("done"));
+	}
+	SoftAssets::DumpStats();
+}
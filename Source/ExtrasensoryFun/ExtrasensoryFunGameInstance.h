@@ -0,0 +1,65 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/GameInstance.h"
+#include "ExtrasensoryFunGameInstance.generated.h"
+
+/**
+ * Starts loading the game's FX, sounds and projectile classes in the background as soon as the game starts,
+ * so they're in by the time the player leaves the menu. The preload manifest is the list of PreloadClasses in DefaultGame.ini,
+ * whose soft references are requested through SoftAssets once the classes are loaded.
+ * Once a map is loaded, the package dependencies of PrefetchMap (the main level) are loaded in the background as well and kept
+ * for the rest of the session, so leaving the menu or restarting the level only has to load the map package itself.
+ * Map loads show the loading screen module's widget, drawn on the loading thread while the game thread loads.
+ * Also logs how long it takes from launch to the first frame of the first map (the menu, or the map given on the command line),
+ * and from launch and from the start of each map load to the first playable frame of the map.
+ * Launching with -ExecCmds="open Main" times launch to Main through the menu without waiting on anyone clicking through it.
+ * The baseline for those times is a build from before the soft references, run the same way, not ef.Assets.Preload=0.
+ * Uncooked runs only benefit once the Blueprints that referenced the FX, sounds and projectiles are resaved,
+ * until then their import tables still hard-load the VFX packs along with them.
+ */
+UCLASS(Config = Game)
+class EXTRASENSORYFUN_API UExtrasensoryFunGameInstance : public UGameInstance {
+	GENERATED_BODY()
+
+public:
+	virtual void Init() override;
+	virtual void Shutdown() override;
+
+private:
+	// Classes whose soft references are preloaded from the menu
+	UPROPERTY(Config)
+	TArray<FSoftClassPath> PreloadClasses;
+	double PreloadStartTime = 0.0;
+	bool bPreloading = false;
+	void StartPreload();
+	void OnPreloadClassesLoaded();
+
+	// -----Map prefetch-----
+	// Map whose package dependencies are prefetched from the menu
+	UPROPERTY(Config)
+	FString PrefetchMap;
+	// Assets of the prefetched packages, kept loaded so map loads and garbage collection between maps don't drop them
+	UPROPERTY()
+	TArray<UObject*> PrefetchedAssets;
+	int32 PrefetchPending = 0;
+	double PrefetchStartTime = 0.0;
+	bool bPrefetchStarted = false;
+	void StartPrefetch();
+	void OnPrefetchPackageLoaded(const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result);
+
+	// -----Startup timing-----
+	double MapLoadStartTime = 0.0;
+	double MapLoadedTime = 0.0;
+	FString LoadingMapName;
+	bool bWaitingForPlayableFrame = false;
+	bool bColdStart = true;
+	FDelegateHandle PreLoadMapHandle;
+	FDelegateHandle EndFrameHandle;
+	FDelegateHandle PostLoadMapHandle;
+	void OnPreLoadMap(const FString& MapName);
+	void OnPostLoadMap(UWorld* World);
+	void OnEndFrame();
+};
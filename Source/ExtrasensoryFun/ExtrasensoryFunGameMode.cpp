@@ -4,6 +4,17 @@
 #include "ExtrasensoryFunGameMode.h"
 #include "BaseCharacter.h"
 #include "ExtrasensoryFunPlayerController.h"
+#include "HealthComponent.h"
+#include "LevelResetSubsystem.h"
+
+// Called when the level's actors have begun play, snapshot the level for fast resets
+void AExtrasensoryFunGameMode::StartPlay() {
+	Super::StartPlay();
+
+	if (bFastReset) {
+		GetWorld()->GetSubsystem<ULevelResetSubsystem>()->CaptureSnapshot();
+	}
+}
 
 void AExtrasensoryFunGameMode::ActorDied(AActor* DeadActor) {
 	if (ABaseCharacter* DeadCharacter = Cast<ABaseCharacter>(DeadActor)) {
@@ -14,4 +25,24 @@ void AExtrasensoryFunGameMode::ActorDied(AActor* DeadActor) {
 	} else {
 		DeadActor->Destroy();
 	}
+}
+
+// Reset the level in place if fast reset is enabled, returns false if the level needs reloading instead
+bool AExtrasensoryFunGameMode::ResetLevelInPlace() {
+	ULevelResetSubsystem* LevelReset = GetWorld()->GetSubsystem<ULevelResetSubsystem>();
+	if (!bFastReset || !LevelReset->HasSnapshot()) {
+		return false;
+	}
+	LevelReset->ResetLevel();
+	return true;
+}
+
+// Subscribe to a health component's death
+void AExtrasensoryFunGameMode::RegisterHealthComponent(UHealthComponent* HealthComponent) {
+	HealthComponent->OnDeath.AddUniqueDynamic(this, &AExtrasensoryFunGameMode::OnActorDeath);
+}
+
+// Called when a registered health component's owner dies
+void AExtrasensoryFunGameMode::OnActorDeath(AActor* DeadActor, AActor* DamageCauser) {
+	ActorDied(DeadActor);
 }
\ No newline at end of file
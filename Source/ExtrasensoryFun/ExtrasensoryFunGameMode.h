@@ -6,6 +6,8 @@
 #include "GameFramework/GameModeBase.h"
 #include "ExtrasensoryFunGameMode.generated.h"
 
+class UHealthComponent;
+
 /**
  * 
  */
@@ -15,5 +17,22 @@ class EXTRASENSORYFUN_API AExtrasensoryFunGameMode : public AGameModeBase
 	GENERATED_BODY()
 	
 public:
+	// Called when the level's actors have begun play
+	virtual void StartPlay() override;
+
 	void ActorDied(AActor* DeadActor);
+
+	// Reset the level in place if fast reset is enabled, returns false if the level needs reloading instead
+	bool ResetLevelInPlace();
+
+	// Subscribe to a health component's death
+	void RegisterHealthComponent(UHealthComponent* HealthComponent);
+
+private:
+	// Restore the level's initial state in place on game over instead of reloading the map
+	UPROPERTY(EditAnywhere, Category = "Game Over")
+	bool bFastReset = true;
+
+	UFUNCTION()
+	void OnActorDeath(AActor* DeadActor, AActor* DamageCauser);
 };
@@ -0,0 +1,54 @@
+// by Jason Hilani
+
+
+#include "ExtrasensoryFunLLM.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+LLM_DEFINE_TAG(ExtrasensoryFun, TEXT("ExtrasensoryFun"));
+LLM_DEFINE_TAG(ExtrasensoryFun_Telekinesis, TEXT("Telekinesis"), TEXT("ExtrasensoryFun"));
+LLM_DEFINE_TAG(ExtrasensoryFun_Projectiles, TEXT("Projectiles"), TEXT("ExtrasensoryFun"));
+LLM_DEFINE_TAG(ExtrasensoryFun_AI, TEXT("AI"), TEXT("ExtrasensoryFun"));
+LLM_DEFINE_TAG(ExtrasensoryFun_FX, TEXT("FX"), TEXT("ExtrasensoryFun"));
+LLM_DEFINE_TAG(ExtrasensoryFun_UI, TEXT("UI"), TEXT("ExtrasensoryFun"));
+
+// Write the current and peak size of every game tag to a CSV file in the profiling directory
+static void DumpLLMTags(const TArray<FString>& Args) {
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	FLowLevelMemTracker& Tracker = FLowLevelMemTracker::Get();
+	if (!Tracker.IsEnabled()) {
+		UE_LOG(LogTemp, Warning, TEXT("LLM is disabled, run with -llm to track the game's tags"));
+		return;
+	}
+
+	const FName Tags[] = {
+		LLM_TAGNAME(ExtrasensoryFun),
+		LLM_TAGNAME(ExtrasensoryFun_Telekinesis),
+		LLM_TAGNAME(ExtrasensoryFun_Projectiles),
+		LLM_TAGNAME(ExtrasensoryFun_AI),
+		LLM_TAGNAME(ExtrasensoryFun_FX),
+		LLM_TAGNAME(ExtrasensoryFun_UI)
+	};
+	FString Csv = TEXT("Tag,CurrentBytes,PeakBytes\n");
+	for (const FName& Tag : Tags) {
+		const int64 Current = Tracker.GetTagAmountForTracker(ELLMTracker::Default, Tag, ELLMTagSet::None, UE::LLM::ESizeParams::ReportCurrent);
+		const int64 Peak = Tracker.GetTagAmountForTracker(ELLMTracker::Default, Tag, ELLMTagSet::None, UE::LLM::ESizeParams::ReportPeak);
+		Csv += FString::Printf(TEXT("%s,%lld,%lld\n"), *Tag.ToString(), Current, Peak);
+	}
+
+	const FString Filename = Args.Num() > 0 ? Args[0] : FPaths::ProfilingDir() / FString::Printf(TEXT("LLMTags-%s.csv"), *FDateTime::Now().ToString());
+	if (FFileHelper::SaveStringToFile(Csv, *Filename)) {
+		UE_LOG(LogTemp, Display, TEXT("Wrote LLM tags to %s"), *Filename);
+	} else {
+		UE_LOG(LogTemp, Error, TEXT("Couldn't write %s"), *Filename);
+	}
+#else
+	UE_LOG(LogTemp, Warning, TEXT("LLM isn't compiled into this build"));
+#endif
+}
+
+static FAutoConsoleCommandWithArgs DumpLLMTagsCommand(
+	TEXT("ef.LLM.DumpCSV"),
+	TEXT("Writes the current and peak size of the game's LLM tags to a CSV file. Usage: ef.LLM.DumpCSV [File]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&DumpLLMTags)
+);
@@ -0,0 +1,23 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+/**
+ * Low-level memory tracking tags of the game module, all grouped under ExtrasensoryFun.
+ * Use LLM_SCOPE_BYTAG(ExtrasensoryFun_<Name>) around allocation sites, and run with -llm to see them in "stat LLM".
+ * The macros compile out when LLM is disabled (Shipping by default).
+ */
+LLM_DECLARE_TAG_API(ExtrasensoryFun, EXTRASENSORYFUN_API);
+// Physics handles and grab state
+LLM_DECLARE_TAG_API(ExtrasensoryFun_Telekinesis, EXTRASENSORYFUN_API);
+// Projectile actors and their components
+LLM_DECLARE_TAG_API(ExtrasensoryFun_Projectiles, EXTRASENSORYFUN_API);
+// AI controllers, behavior trees and blackboards
+LLM_DECLARE_TAG_API(ExtrasensoryFun_AI, EXTRASENSORYFUN_API);
+// Emitters and decals
+LLM_DECLARE_TAG_API(ExtrasensoryFun_FX, EXTRASENSORYFUN_API);
+// Widgets
+LLM_DECLARE_TAG_API(ExtrasensoryFun_UI, EXTRASENSORYFUN_API);
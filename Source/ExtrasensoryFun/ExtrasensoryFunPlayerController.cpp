@@ -4,45 +4,260 @@
 #include "ExtrasensoryFunPlayerController.h"
 #include "Blueprint/UserWidget.h"
 #include "ESPCharacter.h"
+#include "PlayerHUDWidget.h"
+#include "ExtrasensoryFunGameMode.h"
+#include "InputReplaySubsystem.h"
+#include "ExtrasensoryFunLLM.h"
+#include "ExtrasensoryFunStats.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Debugging/SlateDebugging.h"
+#include "Containers/Ticker.h"
 
-// Called every frame
-void AExtrasensoryFunPlayerController::Tick(float DeltaTime) {
-	Super::Tick(DeltaTime);
-
-	if (Aiming) {
-		if (AESPCharacter* PlayerChar = Cast<AESPCharacter>(GetPawn())) {
-			// Add aiming UI when aiming, remove it when not
-			if (PlayerChar->GetIsFrozen() && !PlayerChar->GetTarget().GetActor()) {
-				if (!Aiming->IsInViewport()) {
-					Aiming->AddToViewport();
-				}
-			} else {
-				if (Aiming->IsInViewport()) {
-					Aiming->RemoveFromParent();
-				}
-			}
-		}
-	}
+// Default constructor, the HUD is driven by the pawn's events so the controller doesn't need to tick
+AExtrasensoryFunPlayerController::AExtrasensoryFunPlayerController() {
+	PrimaryActorTick.bCanEverTick = false;
 }
 
 // When the player dies
 void AExtrasensoryFunPlayerController::GameOver() {
-	HUD->RemoveFromParent();
-	if (UUserWidget* GameOverScreen = CreateWidget(this, GameOverScreenClass)) {
+	if (HUD) {
+		HUD->RemoveFromParent();
+	}
+	// Created in BeginPlay, only added here so its construct animations still play
+	if (GameOverScreen) {
 		GameOverScreen->AddToViewport();
 	}
-	GetWorldTimerManager().SetTimer(RestartTimer, this, &APlayerController::RestartLevel, RestartDelay);
+	DeadPawn = GetPawn();
+	GetWorldTimerManager().SetTimer(RestartTimer, this, &AExtrasensoryFunPlayerController::RestartAfterGameOver, RestartDelay);
+}
+
+// Reset the level in place and take control of the revived pawn, or reload the level if the game mode can't
+void AExtrasensoryFunPlayerController::RestartAfterGameOver() {
+	AExtrasensoryFunGameMode* GameMode = GetWorld()->GetAuthGameMode<AExtrasensoryFunGameMode>();
+	if (!GameMode || !DeadPawn || !GameMode->ResetLevelInPlace()) {
+		RestartLevel();
+		return;
+	}
+	Possess(DeadPawn);
+	DeadPawn = nullptr;
+	// Swap the game over screen back for the HUD
+	if (GameOverScreen) {
+		GameOverScreen->RemoveFromParent();
+	}
+	if (HUD) {
+		HUD->AddToViewport();
+	}
+}
+
+// Route input through the input recorder, and block live input during replays
+bool AExtrasensoryFunPlayerController::InputKey(const FInputKeyParams& Params) {
+	if (UInputReplaySubsystem* InputReplay = GetWorld()->GetSubsystem<UInputReplaySubsystem>()) {
+		if (InputReplay->IsReplaying() && !InputReplay->IsInjecting()) {
+			return true;
+		}
+		InputReplay->RecordInput(Params);
+	}
+	return Super::InputKey(Params);
 }
 
 // Called when the game starts or when spawned
 void AExtrasensoryFunPlayerController::BeginPlay() {
 	Super::BeginPlay();
 
+	LLM_SCOPE_BYTAG(ExtrasensoryFun_UI);
 	// Create and add the player's HUD
 	HUD = CreateWidget(this, HUDClass);
 	if (HUD) {
 		HUD->AddToViewport();
+		// A HUD that isn't a UPlayerHUDWidget can't be driven by events and still polls the health through its bindings
+		if (!HUD->IsA<UPlayerHUDWidget>()) {
+			UE_LOG(LogTemp, Warning, TEXT("HUD class %s doesn't derive from UPlayerHUDWidget, reparent it and replace its health binding with a HealthBar progress bar"), *HUD->GetClass()->GetName());
+		}
 	}
-	// Create aiming UI widget
+	// Create aiming UI widget and keep it in the viewport, hidden until the pawn starts aiming
 	Aiming = CreateWidget(this, AimingClass);
-}
\ No newline at end of file
+	if (Aiming) {
+		AimingVisibility = Aiming->GetVisibility();
+		Aiming->SetVisibility(ESlateVisibility::Collapsed);
+		Aiming->AddToViewport();
+	}
+	// Create the game over screen up front so dying doesn't hitch
+	GameOverScreen = CreateWidget(this, GameOverScreenClass);
+
+	// The pawn can be possessed before BeginPlay, in which case OnPossess couldn't update the widget yet
+	if (AESPCharacter* PlayerChar = Cast<AESPCharacter>(GetPawn())) {
+		OnAimReticleChanged(PlayerChar->IsAimReticleVisible());
+	}
+	BindHUDToPawn(GetPawn());
+}
+
+// Listen to the pawn's aim state
+void AExtrasensoryFunPlayerController::OnPossess(APawn* InPawn) {
+	Super::OnPossess(InPawn);
+
+	if (AESPCharacter* PlayerChar = Cast<AESPCharacter>(InPawn)) {
+		PlayerChar->OnAimReticleChanged.AddUniqueDynamic(this, &AExtrasensoryFunPlayerController::OnAimReticleChanged);
+		OnAimReticleChanged(PlayerChar->IsAimReticleVisible());
+	}
+	BindHUDToPawn(InPawn);
+}
+
+// Stop listening and hide the aiming UI
+void AExtrasensoryFunPlayerController::OnUnPossess() {
+	if (AESPCharacter* PlayerChar = Cast<AESPCharacter>(GetPawn())) {
+		PlayerChar->OnAimReticleChanged.RemoveDynamic(this, &AExtrasensoryFunPlayerController::OnAimReticleChanged);
+	}
+	OnAimReticleChanged(false);
+	BindHUDToPawn(nullptr);
+
+	Super::OnUnPossess();
+}
+
+// Point the HUD at the pawn's health, or at nothing
+void AExtrasensoryFunPlayerController::BindHUDToPawn(APawn* InPawn) {
+	if (UPlayerHUDWidget* PlayerHUD = Cast<UPlayerHUDWidget>(HUD)) {
+		const ABaseCharacter* Character = Cast<ABaseCharacter>(InPawn);
+		PlayerHUD->SetHealthComponent(Character ? Character->GetHealthComponent() : nullptr);
+	}
+}
+
+// Show the aiming UI when aiming without a target, hide it otherwise
+void AExtrasensoryFunPlayerController::OnAimReticleChanged(bool bVisible) {
+	if (Aiming) {
+		Aiming->SetVisibility(bVisible ? AimingVisibility : ESlateVisibility::Collapsed);
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+// -----Aiming widget benchmark-----
+
+// Show or hide the aiming widget by visibility, or by adding it to and removing it from the viewport
+void AExtrasensoryFunPlayerController::ShowAimingWidget(bool bShown, bool bByAddingToViewport) {
+	if (!Aiming) return;
+	if (bByAddingToViewport) {
+		Aiming->SetVisibility(AimingVisibility);
+		if (bShown && !Aiming->IsInViewport()) {
+			Aiming->AddToViewport();
+		} else if (!bShown && Aiming->IsInViewport()) {
+			Aiming->RemoveFromParent();
+		}
+		return;
+	}
+	if (!Aiming->IsInViewport()) {
+		Aiming->AddToViewport();
+	}
+	OnAimReticleChanged(bShown);
+}
+
+// Put the aiming widget back in the viewport, shown as the pawn's aim reticle says
+void AExtrasensoryFunPlayerController::RestoreAimingWidget() {
+	const AESPCharacter* PlayerChar = Cast<AESPCharacter>(GetPawn());
+	ShowAimingWidget(PlayerChar && PlayerChar->IsAimReticleVisible(), false);
+}
+
+#if WITH_SLATE_DEBUGGING
+// State of an aiming widget benchmark, run for each toggle method with global invalidation off and on
+struct FAimingWidgetBench {
+	TWeakObjectPtr<AExtrasensoryFunPlayerController> Controller;
+	int32 FramesPerRun;
+	// Bit 0 toggles by visibility instead of adding and removing, bit 1 turns global invalidation on
+	int32 Run = 0;
+	int32 Frames = 0;
+	// Widget invalidations Slate reported during the run, the layout ones and the ones that invalidated a whole root
+	int32 Invalidations = 0;
+	int32 LayoutInvalidations = 0;
+	int32 RootInvalidations = 0;
+	int32 PreviousGlobalInvalidation = 0;
+	FTSTicker::FDelegateHandle TickerHandle;
+	FDelegateHandle InvalidateHandle;
+};
+
+static IConsoleVariable* GetGlobalInvalidationVariable() {
+	return IConsoleManager::Get().FindConsoleVariable(TEXT("Slate.EnableGlobalInvalidation"));
+}
+
+// Stop counting, and put the invalidation setting and the widget back
+static void FinishAimingWidgetBench(TSharedRef<FAimingWidgetBench> Bench) {
+	FTSTicker::GetCoreTicker().RemoveTicker(Bench->TickerHandle);
+	FSlateDebugging::WidgetInvalidateEvent.Remove(Bench->InvalidateHandle);
+	if (IConsoleVariable* GlobalInvalidation = GetGlobalInvalidationVariable()) {
+		GlobalInvalidation->Set(Bench->PreviousGlobalInvalidation);
+	}
+	if (AExtrasensoryFunPlayerController* Controller = Bench->Controller.Get()) {
+		Controller->RestoreAimingWidget();
+	}
+}
+
+/**
+* Toggle the aiming widget every frame and count the widget invalidations Slate reports, for each combination of
+* adding and removing it against changing its visibility, and global invalidation off against on.
+* The invalidations per frame also go to CSV profiles as AimingWidgetInvalidations.
+*/
+static void AimingWidgetBench(const TArray<FString>& Args, UWorld* World) {
+	AExtrasensoryFunPlayerController* Controller = Cast<AExtrasensoryFunPlayerController>(World->GetFirstPlayerController());
+	IConsoleVariable* GlobalInvalidation = GetGlobalInvalidationVariable();
+	if (!Controller || !GlobalInvalidation || !FSlateApplication::IsInitialized()) {
+		UE_LOG(LogTemp, Error, TEXT("Aiming widget benchmark: needs a player controller and a Slate application, it can't run headless"));
+		return;
+	}
+	TSharedRef<FAimingWidgetBench> Bench = MakeShared<FAimingWidgetBench>();
+	Bench->Controller = Controller;
+	Bench->FramesPerRun = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 2) : 300;
+	Bench->PreviousGlobalInvalidation = GlobalInvalidation->GetInt();
+	GlobalInvalidation->Set(0);
+
+	Bench->InvalidateHandle = FSlateDebugging::WidgetInvalidateEvent.AddLambda([Bench](const FSlateDebuggingInvalidateArgs& InvalidateArgs) {
+		Bench->Invalidations++;
+		if (EnumHasAnyFlags(InvalidateArgs.InvalidateWidgetReason, EInvalidateWidgetReason::Layout | EInvalidateWidgetReason::ChildOrder)) {
+			Bench->LayoutInvalidations++;
+		}
+		if (InvalidateArgs.InvalidateInvalidationRootReason != ESlateDebuggingInvalidateRootReason::None) {
+			Bench->RootInvalidations++;
+		}
+		CSV_CUSTOM_STAT(ExtrasensoryFun, AimingWidgetInvalidations, 1, ECsvCustomStatOp::Accumulate);
+	});
+
+	// The core ticker runs before Slate, so each toggle gets invalidated and painted in the same frame
+	Bench->TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Bench](float DeltaTime) {
+		AExtrasensoryFunPlayerController* Controller = Bench->Controller.Get();
+		if (!Controller) {
+			FinishAimingWidgetBench(Bench);
+			return false;
+		}
+		if (Bench->Frames == Bench->FramesPerRun) {
+			UE_LOG(LogTemp, Display, TEXT("  %s, global invalidation %s: %.2f invalidations per frame (%.2f layout, %.2f whole root) over %d frames"),
+				Bench->Run & 1 ? TEXT("Visibility     ") : TEXT("Add and remove "), Bench->Run & 2 ? TEXT("on ") : TEXT("off"),
+				(float)Bench->Invalidations / Bench->Frames, (float)Bench->LayoutInvalidations / Bench->Frames,
+				(float)Bench->RootInvalidations / Bench->Frames, Bench->Frames);
+			Bench->Run++;
+			Bench->Frames = 0;
+			if (Bench->Run == 4) {
+				FinishAimingWidgetBench(Bench);
+				return false;
+			}
+			Controller->RestoreAimingWidget();
+			GetGlobalInvalidationVariable()->Set(Bench->Run & 2 ? 1 : 0);
+			// Counting starts over after putting the widget back, so each run only counts its own toggles
+			Bench->Invalidations = 0;
+			Bench->LayoutInvalidations = 0;
+			Bench->RootInvalidations = 0;
+		}
+		Controller->ShowAimingWidget(Bench->Frames % 2 == 0, (Bench->Run & 1) == 0);
+		Bench->Frames++;
+		return true;
+	}));
+	UE_LOG(LogTemp, Display, TEXT("Aiming widget benchmark: toggling the aiming widget every frame, %d frames per run"), Bench->FramesPerRun);
+}
+#else
+// Invalidations are only reported in builds with Slate debugging
+static void AimingWidgetBench(const TArray<FString>& Args, UWorld* World) {
+	UE_LOG(LogTemp, Error, TEXT("Aiming widget benchmark: needs a build with Slate debugging to count invalidations"));
+}
+#endif
+
+static FAutoConsoleCommandWithWorldAndArgs AimingWidgetBenchCommand(
+	TEXT("ef.UI.AimingWidgetBench"),
+	TEXT("Compares the Slate invalidations caused by toggling the aiming widget by adding and removing it against changing its visibility, with global invalidation off and on. Usage: ef.UI.AimingWidgetBench [Frames=300]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&AimingWidgetBench)
+);
+#endif
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
+#include "Components/SlateWrapperTypes.h"
 #include "ExtrasensoryFunPlayerController.generated.h"
 
 class UUserWidget;
@@ -16,37 +17,65 @@ class EXTRASENSORYFUN_API AExtrasensoryFunPlayerController : public APlayerContr
 {
 	GENERATED_BODY()
 public:
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	// Default constructor
+	AExtrasensoryFunPlayerController();
 
 	// Game over method
 	void GameOver();
+	// Bring the player back after game over, in place if possible
+	void RestartAfterGameOver();
+
+	// Route input through the input recorder, and block live input during replays
+	virtual bool InputKey(const FInputKeyParams& Params) override;
 
 	// Getter method
 	UFUNCTION(BlueprintCallable)
 	float GetRestartDelay() { return RestartDelay; }
 
+#if !UE_BUILD_SHIPPING
+	/**
+	 * Show or hide the aiming widget, by changing its visibility or by adding it to and removing it from the viewport
+	 * the way the controller used to. Only meant for the ef.UI.AimingWidgetBench comparison.
+	 */
+	void ShowAimingWidget(bool bShown, bool bByAddingToViewport);
+	// Put the aiming widget back in the viewport, shown as the pawn's aim reticle says
+	void RestoreAimingWidget();
+#endif
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	// Bind to and unbind from the pawn's aim state
+	virtual void OnPossess(APawn* InPawn) override;
+	virtual void OnUnPossess() override;
 
 private:
-	// Hud class and instance
+	// Hud class and instance, HUDs deriving from UPlayerHUDWidget follow the pawn's health through its events
 	UPROPERTY(EditAnywhere)
 	TSubclassOf<UUserWidget> HUDClass;
 	UPROPERTY()
 	UUserWidget* HUD;
+	void BindHUDToPawn(APawn* InPawn);
 
 	// Game over class
 	UPROPERTY(EditAnywhere)
 	TSubclassOf<UUserWidget> GameOverScreenClass;
+	UPROPERTY()
+	UUserWidget* GameOverScreen;
 	UPROPERTY(EditAnywhere)
 	float RestartDelay = 5;
 	FTimerHandle RestartTimer;
+	// Pawn to possess again after an in-place reset
+	UPROPERTY()
+	APawn* DeadPawn;
 
-	// Aiming class
+	// Aiming class, the widget stays in the viewport and only its visibility changes
 	UPROPERTY(EditAnywhere)
 	TSubclassOf<UUserWidget> AimingClass;
 	UPROPERTY()
 	UUserWidget* Aiming;
+	// Visibility the aiming widget was authored with, used when showing it
+	ESlateVisibility AimingVisibility;
+	UFUNCTION()
+	void OnAimReticleChanged(bool bVisible);
 };
@@ -0,0 +1,308 @@
+// by Jason Hilani
+
+
+#include "ExtrasensoryFunReplicationGraph.h"
+#include "ReplicationGraphTypes.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/Info.h"
+#include "GameFramework/Controller.h"
+#include "ESPCharacter.h"
+#include "ShooterCharacter.h"
+#include "ShooterWeapon.h"
+#include "ShooterProjectile.h"
+#include "ShooterSpawnDirector.h"
+#include "FireTokenSubsystem.h"
+#include "ExtrasensoryFunStats.h"
+#include "TimerManager.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerStart.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Server Replicate Actors"), STAT_ServerReplicateActors, STATGROUP_ExtrasensoryFun);
+
+// The world's replication graph, if it uses this one
+UExtrasensoryFunReplicationGraph* UExtrasensoryFunReplicationGraph::Get(const UWorld* World) {
+	UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+	return NetDriver ? Cast<UExtrasensoryFunReplicationGraph>(NetDriver->GetReplicationDriver()) : nullptr;
+}
+
+/**
+* Set the routing policies of the game's classes and their replication frequencies and cull distances.
+* Every replicated class falls back on the AActor settings.
+*/
+void UExtrasensoryFunReplicationGraph::InitGlobalActorClassSettings() {
+	Super::InitGlobalActorClassSettings();
+
+	ClassRepNodePolicies.Set(AShooterProjectile::StaticClass(), EClassRepNodeMapping::NotRouted);
+	ClassRepNodePolicies.Set(AShooterWeapon::StaticClass(), EClassRepNodeMapping::NotRouted);
+	ClassRepNodePolicies.Set(AESPCharacter::StaticClass(), EClassRepNodeMapping::RelevantAllConnections);
+	ClassRepNodePolicies.Set(AShooterCharacter::StaticClass(), EClassRepNodeMapping::Spatialize_Dynamic);
+	ClassRepNodePolicies.Set(AShooterSpawnDirector::StaticClass(), EClassRepNodeMapping::NotRouted);
+	// Game state, player states and the like
+	ClassRepNodePolicies.Set(AInfo::StaticClass(), EClassRepNodeMapping::RelevantAllConnections);
+	// Player controllers only go to their own connection, through the connection's always relevant node
+	ClassRepNodePolicies.Set(AController::StaticClass(), EClassRepNodeMapping::NotRouted);
+
+	auto SetClassInfo = [this](UClass* Class, float CullDistance) {
+		FClassReplicationInfo ClassInfo;
+		ClassInfo.SetCullDistanceSquared(CullDistance * CullDistance);
+		ClassInfo.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(Class->GetDefaultObject<AActor>()->NetUpdateFrequency);
+		GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+	};
+	SetClassInfo(AActor::StaticClass(), FMath::Sqrt(AActor::StaticClass()->GetDefaultObject<AActor>()->NetCullDistanceSquared));
+	SetClassInfo(AShooterCharacter::StaticClass(), EnemyCullDistance);
+}
+
+// Nodes shared by every connection
+void UExtrasensoryFunReplicationGraph::InitGlobalGraphNodes() {
+	Super::InitGlobalGraphNodes();
+
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = GridCellSize;
+	GridNode->SpatialBias = FVector2D(SpatialBiasX, SpatialBiasY);
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+
+	HeldObjectsNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(HeldObjectsNode);
+}
+
+// The connection's own player controller, pawn and view target
+void UExtrasensoryFunReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) {
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* AlwaysRelevantForConnection = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+	AddConnectionGraphNode(AlwaysRelevantForConnection, RepGraphConnection);
+}
+
+// Explicit policy, or one derived from the class defaults
+UExtrasensoryFunReplicationGraph::EClassRepNodeMapping UExtrasensoryFunReplicationGraph::GetMappingPolicy(UClass* Class) {
+	if (const EClassRepNodeMapping* Policy = ClassRepNodePolicies.Get(Class)) {
+		return *Policy;
+	}
+	const AActor* ActorCDO = Class->GetDefaultObject<AActor>();
+	EClassRepNodeMapping Policy = EClassRepNodeMapping::Spatialize_Dynamic;
+	if (ActorCDO->bAlwaysRelevant) {
+		Policy = EClassRepNodeMapping::RelevantAllConnections;
+	} else if (ActorCDO->bOnlyRelevantToOwner) {
+		Policy = EClassRepNodeMapping::NotRouted;
+	} else if (ActorCDO->GetRootComponent() && ActorCDO->GetRootComponent()->Mobility == EComponentMobility::Static) {
+		Policy = EClassRepNodeMapping::Spatialize_Static;
+	}
+	ClassRepNodePolicies.Set(Class, Policy);
+	return Policy;
+}
+
+void UExtrasensoryFunReplicationGraph::AddToGrid(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo, EClassRepNodeMapping Policy) {
+	if (Policy == EClassRepNodeMapping::Spatialize_Static) {
+		GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+	} else if (Policy == EClassRepNodeMapping::Spatialize_Dynamic) {
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+	}
+}
+
+void UExtrasensoryFunReplicationGraph::RemoveFromGrid(const FNewReplicatedActorInfo& ActorInfo, EClassRepNodeMapping Policy) {
+	if (Policy == EClassRepNodeMapping::Spatialize_Static) {
+		GridNode->RemoveActor_Static(ActorInfo);
+	} else if (Policy == EClassRepNodeMapping::Spatialize_Dynamic) {
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+	}
+}
+
+void UExtrasensoryFunReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) {
+	const EClassRepNodeMapping Policy = GetMappingPolicy(ActorInfo.Class);
+	if (Policy == EClassRepNodeMapping::RelevantAllConnections) {
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+	} else {
+		AddToGrid(ActorInfo, GlobalInfo, Policy);
+	}
+}
+
+void UExtrasensoryFunReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) {
+	// Held objects were already taken out of the grid
+	if (HeldActors.Remove(ActorInfo.Actor) > 0) {
+		HeldObjectsNode->NotifyRemoveNetworkActor(ActorInfo);
+		return;
+	}
+	const EClassRepNodeMapping Policy = GetMappingPolicy(ActorInfo.Class);
+	if (Policy == EClassRepNodeMapping::RelevantAllConnections) {
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+	} else {
+		RemoveFromGrid(ActorInfo, Policy);
+	}
+}
+
+// Move a replicated held object from the grid to the always relevant list, so it can't drop out mid-throw
+void UExtrasensoryFunReplicationGraph::AddHeldObject(AActor* Actor) {
+	if (!Actor || !Actor->GetIsReplicated() || HeldActors.Contains(Actor)) return;
+	const FNewReplicatedActorInfo ActorInfo(Actor);
+	const EClassRepNodeMapping Policy = GetMappingPolicy(ActorInfo.Class);
+	// Objects relevant everywhere or nowhere don't need to move
+	if (Policy == EClassRepNodeMapping::RelevantAllConnections || Policy == EClassRepNodeMapping::NotRouted) return;
+
+	RemoveFromGrid(ActorInfo, Policy);
+	HeldObjectsNode->NotifyAddNetworkActor(ActorInfo);
+	HeldActors.Add(Actor);
+}
+
+// Put a released object back in the grid, in the cell it ended up in
+void UExtrasensoryFunReplicationGraph::RemoveHeldObject(AActor* Actor) {
+	if (!Actor || HeldActors.Remove(Actor) == 0) return;
+	const FNewReplicatedActorInfo ActorInfo(Actor);
+	HeldObjectsNode->NotifyRemoveNetworkActor(ActorInfo);
+	AddToGrid(ActorInfo, GlobalActorReplicationInfoMap.Get(Actor), GetMappingPolicy(ActorInfo.Class));
+}
+
+// Time the net tick for the stress test
+int32 UExtrasensoryFunReplicationGraph::ServerReplicateActors(float DeltaSeconds) {
+	EF_SCOPE_CYCLE_COUNTER(STAT_ServerReplicateActors);
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 Replicated = Super::ServerReplicateActors(DeltaSeconds);
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+	ReplicateSeconds += Seconds;
+	ReplicateFrames++;
+	CSV_CUSTOM_STAT(ExtrasensoryFun, ServerReplicateActorsMs, Seconds * 1000.0, ECsvCustomStatOp::Set);
+	return Replicated;
+}
+
+// -----Console commands-----
+
+/**
+* Net stress test, run on a server with clients in local processes, e.g.
+* ExtrasensoryFunServer /Game/Main -log, then a few ExtrasensoryFun 127.0.0.1 -nosound -windowed clients.
+* Spawns Enemies shooters on a grid around the player start, keeps Projectiles alive by firing their weapons,
+* then reports the average net tick flush time and each connection's bandwidth over Seconds.
+* The tick flush is timed with either replication driver, so running once as configured and once with ReplicationDriverClassName cleared
+* compares the two. Each run appends a row to NetStressTest.csv in the profiling directory, for the runs to sit side by side.
+*/
+static void NetStressTest(const TArray<FString>& Args, UWorld* World) {
+	UNetDriver* NetDriver = World->GetNetDriver();
+	if (!NetDriver || World->GetNetMode() == NM_Client) {
+		UE_LOG(LogTemp, Error, TEXT("Net stress test: run it on a server"));
+		return;
+	}
+	const int32 NumEnemies = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 200;
+	const int32 NumProjectiles = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 500;
+	const float Seconds = Args.Num() > 2 ? FMath::Max(FCString::Atof(*Args[2]), 1.f) : 10.f;
+
+	UClass* ShooterClass = TSoftClassPtr<AShooterCharacter>(FSoftObjectPath(TEXT("/Game/Characters/ShooterCharacter/BP_RocketShooterCharacter.BP_RocketShooterCharacter_C"))).LoadSynchronous();
+	if (!ShooterClass) {
+		UE_LOG(LogTemp, Error, TEXT("Net stress test: shooter class not found"));
+		return;
+	}
+	AActor* Start = UGameplayStatics::GetActorOfClass(World, APlayerStart::StaticClass());
+	const FVector Origin = Start ? Start->GetActorLocation() : FVector::ZeroVector;
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	// A square grid of shooters, 500 units apart
+	TArray<TWeakObjectPtr<AShooterCharacter>> Shooters;
+	const int32 Side = FMath::CeilToInt(FMath::Sqrt((float)NumEnemies));
+	for (int32 i = 0; i < NumEnemies; i++) {
+		const FVector Location = Origin + FVector((i % Side - Side / 2) * 500.f, (i / Side - Side / 2) * 500.f, 0.f);
+		if (AShooterCharacter* Shooter = World->SpawnActor<AShooterCharacter>(ShooterClass, Location, FRotator(0.f, FMath::FRandRange(0.f, 360.f), 0.f), SpawnParams)) {
+			// Their controller gives the weapon its aim
+			Shooter->SpawnDefaultController();
+			Shooters.Add(Shooter);
+		}
+	}
+
+	TMap<UNetConnection*, int64> StartBytes;
+	for (UNetConnection* Connection : NetDriver->ClientConnections) {
+		StartBytes.Add(Connection, Connection->OutTotalBytes);
+	}
+	if (UExtrasensoryFunReplicationGraph* Graph = UExtrasensoryFunReplicationGraph::Get(World)) {
+		Graph->ResetReplicateTiming();
+	}
+
+	// The world's tick flush ticks the net driver, whichever replication driver it uses.
+	// Multicast delegates broadcast the latest binding first, so this one starts the clock before the net driver's TickFlush runs.
+	struct FTickFlushTiming {
+		double StartTime = 0.0;
+		double Seconds = 0.0;
+		int32 Frames = 0;
+		FDelegateHandle TickFlushHandle;
+		FDelegateHandle PostTickFlushHandle;
+	};
+	TSharedRef<FTickFlushTiming> TickFlush = MakeShared<FTickFlushTiming>();
+	TickFlush->TickFlushHandle = World->OnTickFlush().AddLambda([TickFlush](float DeltaSeconds) {
+		TickFlush->StartTime = FPlatformTime::Seconds();
+	});
+	TickFlush->PostTickFlushHandle = World->OnPostTickFlush().AddLambda([TickFlush](float DeltaSeconds) {
+		if (TickFlush->StartTime <= 0.0) return;
+		TickFlush->Seconds += FPlatformTime::Seconds() - TickFlush->StartTime;
+		TickFlush->Frames++;
+		TickFlush->StartTime = 0.0;
+	});
+
+	// Keep the live projectile count up
+	TSharedRef<FTimerHandle> FireHandle = MakeShared<FTimerHandle>();
+	TWeakObjectPtr<UWorld> WeakWorld(World);
+	World->GetTimerManager().SetTimer(*FireHandle, [WeakWorld, Shooters, NumProjectiles]() {
+		UWorld* World = WeakWorld.Get();
+		UFireTokenSubsystem* FireTokens = World ? World->GetSubsystem<UFireTokenSubsystem>() : nullptr;
+		if (!FireTokens || Shooters.Num() == 0) return;
+		for (int32 Live = FireTokens->GetLiveProjectiles(); Live < NumProjectiles; Live++) {
+			if (AShooterCharacter* Shooter = Shooters[FMath::RandHelper(Shooters.Num())].Get()) {
+				if (AShooterWeapon* Weapon = Shooter->GetShooterWeapon()) {
+					Weapon->FireWeapon();
+				}
+			}
+		}
+	}, 0.1f, true);
+
+	FTimerHandle Unused;
+	World->GetTimerManager().SetTimer(Unused, [WeakWorld, Shooters, StartBytes, Seconds, FireHandle, TickFlush]() {
+		UWorld* World = WeakWorld.Get();
+		if (!World) return;
+		World->GetTimerManager().ClearTimer(*FireHandle);
+		World->OnTickFlush().Remove(TickFlush->TickFlushHandle);
+		World->OnPostTickFlush().Remove(TickFlush->PostTickFlushHandle);
+
+		UNetDriver* NetDriver = World->GetNetDriver();
+		const UExtrasensoryFunReplicationGraph* Graph = UExtrasensoryFunReplicationGraph::Get(World);
+		const FString DriverName = NetDriver && NetDriver->GetReplicationDriver() ? NetDriver->GetReplicationDriver()->GetClass()->GetName() : FString(TEXT("Default"));
+		const double TickFlushMs = TickFlush->Frames > 0 ? TickFlush->Seconds * 1000.0 / TickFlush->Frames : 0.0;
+		// Only the replication graph times its own ServerReplicateActors
+		const double ReplicateMs = Graph ? Graph->GetAverageReplicateMs() : -1.0;
+
+		UE_LOG(LogTemp, Display, TEXT("Net stress test: %d enemies over %.0f s"), Shooters.Num(), Seconds);
+		UE_LOG(LogTemp, Display, TEXT("  %s replication driver: net tick flush %.3f ms average over %d frames, ServerReplicateActors %s"),
+			*DriverName, TickFlushMs, TickFlush->Frames, Graph ? *FString::Printf(TEXT("%.3f ms average"), ReplicateMs) : TEXT("not timed"));
+		int64 TotalBytes = 0;
+		if (NetDriver) {
+			for (UNetConnection* Connection : NetDriver->ClientConnections) {
+				if (const int64* Bytes = StartBytes.Find(Connection)) {
+					UE_LOG(LogTemp, Display, TEXT("  %s: %.0f B/s"), *Connection->LowLevelGetRemoteAddress(true), (Connection->OutTotalBytes - *Bytes) / Seconds);
+					TotalBytes += Connection->OutTotalBytes - *Bytes;
+				}
+			}
+		}
+
+		// One row per run, the header is only written to a new file
+		const FString CsvPath = FPaths::ProfilingDir() / TEXT("NetStressTest.csv");
+		if (!IFileManager::Get().FileExists(*CsvPath)) {
+			FFileHelper::SaveStringToFile(TEXT("Driver,Enemies,Seconds,TickFlushMs,ServerReplicateActorsMs,BytesPerSecond\n"), *CsvPath);
+		}
+		FFileHelper::SaveStringToFile(FString::Printf(TEXT("%s,%d,%.0f,%.3f,%.3f,%.0f\n"), *DriverName, Shooters.Num(), Seconds, TickFlushMs, ReplicateMs, TotalBytes / Seconds),
+			*CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+		for (const TWeakObjectPtr<AShooterCharacter>& Shooter : Shooters) {
+			if (Shooter.IsValid()) {
+				Shooter->Destroy();
+			}
+		}
+	}, Seconds, false);
+	UE_LOG(LogTemp, Display, TEXT("Net stress test: running for %.0f s"), Seconds);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs NetStressTestCommand(
+	TEXT("ef.Net.StressTest"),
+	TEXT("Reports server net tick flush time and bandwidth with many enemies and projectiles. Usage: ef.Net.StressTest [Enemies=200] [Projectiles=500] [Seconds=10]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&NetStressTest)
+);
@@ -0,0 +1,76 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "ExtrasensoryFunReplicationGraph.generated.h"
+
+class UReplicationGraphNode_GridSpatialization2D;
+class UReplicationGraphNode_ActorList;
+
+/**
+ * Replication graph of the game, set as the net driver's replication driver in DefaultEngine.ini.
+ * - Enemies and other moving actors go in a 2D spatial grid, so distant ones aren't considered for relevancy every net tick.
+ * - ESP characters are relevant to every connection, since their held set drives everyone's telekinesis.
+ * - Replicated actors held with telekinesis leave the grid for an always relevant list while held.
+ * - Projectiles and weapons are never routed: shooters multicast the spawn parameters and clients simulate their own projectiles.
+ */
+UCLASS(Transient, Config = Engine)
+class EXTRASENSORYFUN_API UExtrasensoryFunReplicationGraph : public UReplicationGraph {
+	GENERATED_BODY()
+
+public:
+	// The world's replication graph, null without a net driver or with another replication driver
+	static UExtrasensoryFunReplicationGraph* Get(const UWorld* World);
+
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+
+	// Keep a held object relevant to every connection until it's released
+	void AddHeldObject(AActor* Actor);
+	void RemoveHeldObject(AActor* Actor);
+
+	// Average ServerReplicateActors time since the last reset
+	double GetAverageReplicateMs() const { return ReplicateFrames > 0 ? ReplicateSeconds * 1000.0 / ReplicateFrames : 0.0; }
+	void ResetReplicateTiming() { ReplicateSeconds = 0.0; ReplicateFrames = 0; }
+
+private:
+	// Grid settings, the bias moves the grid's origin so the whole level is on positive cells
+	UPROPERTY(Config)
+	float GridCellSize = 10000.f;
+	UPROPERTY(Config)
+	float SpatialBiasX = -150000.f;
+	UPROPERTY(Config)
+	float SpatialBiasY = -200000.f;
+	// Enemies farther than this from a viewer aren't replicated to it
+	UPROPERTY(Config)
+	float EnemyCullDistance = 15000.f;
+
+	enum class EClassRepNodeMapping : uint8 {
+		NotRouted,
+		RelevantAllConnections,
+		Spatialize_Static,
+		Spatialize_Dynamic
+	};
+	// Explicit policies set in InitGlobalActorClassSettings, the others are derived from the class defaults and cached
+	TClassMap<EClassRepNodeMapping> ClassRepNodePolicies;
+	EClassRepNodeMapping GetMappingPolicy(UClass* Class);
+	void AddToGrid(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo, EClassRepNodeMapping Policy);
+	void RemoveFromGrid(const FNewReplicatedActorInfo& ActorInfo, EClassRepNodeMapping Policy);
+
+	UPROPERTY()
+	UReplicationGraphNode_GridSpatialization2D* GridNode;
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* AlwaysRelevantNode;
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* HeldObjectsNode;
+	TSet<AActor*> HeldActors;
+
+	double ReplicateSeconds = 0.0;
+	int32 ReplicateFrames = 0;
+};
@@ -0,0 +1,47 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+/**
+ * Stat group of the game module, shown with "stat ExtrasensoryFun".
+ * Cycle counters are declared next to the code they measure, counters shared between files are declared here.
+ * Stats compile out when STATS is 0 and trace scopes when CPUPROFILERTRACE_ENABLED is 0, so none of this exists in Shipping.
+ */
+DECLARE_STATS_GROUP(TEXT("ExtrasensoryFun"), STATGROUP_ExtrasensoryFun, STATCAT_Advanced);
+
+// Objects currently held with telekinesis
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Held Objects"), STAT_HeldObjects, STATGROUP_ExtrasensoryFun, EXTRASENSORYFUN_API);
+// Telekinesis and lock-on sweeps this frame
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sweeps"), STAT_Sweeps, STATGROUP_ExtrasensoryFun, EXTRASENSORYFUN_API);
+// Shooter projectiles currently in the world
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Projectiles Alive"), STAT_ProjectilesAlive, STATGROUP_ExtrasensoryFun, EXTRASENSORYFUN_API);
+// AI line of sight traces this frame
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("LOS Traces"), STAT_LineOfSightTraces, STATGROUP_ExtrasensoryFun, EXTRASENSORYFUN_API);
+// Telekinesis predictions the owning client had to correct this frame
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Prediction Corrections"), STAT_PredictionCorrections, STATGROUP_ExtrasensoryFun, EXTRASENSORYFUN_API);
+
+// Category for the game's counters in CSV profiles, see the perf harness
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(EXTRASENSORYFUN_API, ExtrasensoryFun);
+
+// Count something once this frame, in both the stats system and CSV profiles. A single statement, so it's safe in an unbraced if
+#define EF_INC_FRAME_COUNTER(Stat, CsvName) \
+	do { \
+		INC_DWORD_STAT(Stat); \
+		CSV_CUSTOM_STAT(ExtrasensoryFun, CsvName, 1, ECsvCustomStatOp::Accumulate); \
+	} while (0)
+
+/**
+ * Scope a cycle counter that also shows up in Insights CPU captures.
+ * Cycle counters already emit CPU trace events when stats are compiled in,
+ * builds without stats (Test) fall back to a named trace scope.
+ */
+#if STATS
+#define EF_SCOPE_CYCLE_COUNTER(Stat) SCOPE_CYCLE_COUNTER(Stat)
+#else
+#define EF_SCOPE_CYCLE_COUNTER(Stat) TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
+#endif
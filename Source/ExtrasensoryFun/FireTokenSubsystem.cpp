@@ -0,0 +1,116 @@
+// by Jason Hilani
+
+
+#include "FireTokenSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "Scalability.h"
+
+static TAutoConsoleVariable<int32> CVarFireTokenBudget(
+	TEXT("ef.AI.FireTokenBudget"),
+	8,
+	TEXT("Maximum number of enemies allowed to shoot at the same time, before distance and quality scaling."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarFireTokenHoldTime(
+	TEXT("ef.AI.FireTokenHoldTime"),
+	1.f,
+	TEXT("Seconds a fire token stays taken after an enemy shoots."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarFireTokenFarDistance(
+	TEXT("ef.AI.FireTokenFarDistance"),
+	3000.f,
+	TEXT("Distance from the player at which shooters only get FireTokenFarFraction of the budget."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarFireTokenFarFraction(
+	TEXT("ef.AI.FireTokenFarFraction"),
+	0.25f,
+	TEXT("Fraction of the fire token budget available to shooters at FireTokenFarDistance or farther."),
+	ECVF_Default
+);
+
+// Returns true and takes a token if Shooter is allowed to shoot now
+bool UFireTokenSubsystem::RequestFireToken(const AActor* Shooter) {
+	const double Now = GetWorld()->GetTimeSeconds();
+	ExpireTokens(Now);
+
+	// Far shooters only get the first tokens, so the closest ones keep some available
+	if (TokenExpiryTimes.Num() >= GetBudgetFor(Shooter)) {
+		DeniedRequests++;
+		return false;
+	}
+	TokenExpiryTimes.Add(Now + CVarFireTokenHoldTime.GetValueOnGameThread());
+	PeakTokens = FMath::Max(PeakTokens, TokenExpiryTimes.Num());
+	GrantedRequests++;
+	return true;
+}
+
+// Projectile bookkeeping for the stats
+void UFireTokenSubsystem::OnProjectileSpawned() {
+	LiveProjectiles++;
+	PeakLiveProjectiles = FMath::Max(PeakLiveProjectiles, LiveProjectiles);
+}
+
+void UFireTokenSubsystem::OnProjectileDestroyed() {
+	LiveProjectiles--;
+}
+
+// Log the stats
+void UFireTokenSubsystem::DumpStats() const {
+	UE_LOG(LogTemp, Display, TEXT("Fire tokens: budget %d, held %d, peak held %d, granted %d, denied %d. Projectiles: live %d, peak %d"),
+		CVarFireTokenBudget.GetValueOnGameThread(), TokenExpiryTimes.Num(), PeakTokens, GrantedRequests, DeniedRequests, LiveProjectiles, PeakLiveProjectiles);
+}
+
+// Reset the stats, except for the live projectile count
+void UFireTokenSubsystem::ResetStats() {
+	PeakLiveProjectiles = LiveProjectiles;
+	PeakTokens = TokenExpiryTimes.Num();
+	GrantedRequests = 0;
+	DeniedRequests = 0;
+}
+
+// Remove the tokens whose hold time ran out
+void UFireTokenSubsystem::ExpireTokens(double Now) {
+	TokenExpiryTimes.RemoveAllSwap([Now](double ExpiryTime) { return ExpiryTime <= Now; });
+}
+
+/**
+* Number of tokens Shooter can compete for.
+* The budget gets scaled by the effects quality level, then linearly down to FireTokenFarFraction with distance.
+* At least one token is always available.
+*/
+int32 UFireTokenSubsystem::GetBudgetFor(const AActor* Shooter) const {
+	const int32 EffectsQuality = Scalability::GetQualityLevels().EffectsQuality;
+	float Budget = CVarFireTokenBudget.GetValueOnGameThread() * (FMath::Clamp(EffectsQuality, 0, 3) + 1) / 4.f;
+
+	if (APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(this, 0)) {
+		const float DistanceRatio = FMath::Clamp(Shooter->GetDistanceTo(PlayerPawn) / CVarFireTokenFarDistance.GetValueOnGameThread(), 0.f, 1.f);
+		Budget *= FMath::Lerp(1.f, CVarFireTokenFarFraction.GetValueOnGameThread(), DistanceRatio);
+	}
+	return FMath::Max(1, FMath::RoundToInt(Budget));
+}
+
+// Console commands to read and reset the stats while benchmarking
+static FAutoConsoleCommandWithWorld FireTokenStatsCommand(
+	TEXT("ef.AI.FireTokenStats"),
+	TEXT("Logs fire token and projectile counts."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World) {
+		if (UFireTokenSubsystem* FireTokens = World->GetSubsystem<UFireTokenSubsystem>()) {
+			FireTokens->DumpStats();
+		}
+	})
+);
+
+static FAutoConsoleCommandWithWorld FireTokenStatsResetCommand(
+	TEXT("ef.AI.FireTokenStatsReset"),
+	TEXT("Resets the fire token and peak projectile stats."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World) {
+		if (UFireTokenSubsystem* FireTokens = World->GetSubsystem<UFireTokenSubsystem>()) {
+			FireTokens->ResetStats();
+		}
+	})
+);
@@ -0,0 +1,45 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FireTokenSubsystem.generated.h"
+
+/**
+ * Squad-level coordinator that bounds how many enemies can shoot at the same time.
+ * Enemies request a fire token before shooting, and a granted token is held for a short while.
+ * The number of tokens scales down with the shooter's distance to the player and with the effects quality level,
+ * which in turn bounds the number of live projectiles and muzzle flashes.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API UFireTokenSubsystem : public UWorldSubsystem {
+	GENERATED_BODY()
+
+public:
+	// Returns true and takes a token if Shooter is allowed to shoot now
+	bool RequestFireToken(const AActor* Shooter);
+
+	// Projectile bookkeeping for the stats
+	void OnProjectileSpawned();
+	void OnProjectileDestroyed();
+	int32 GetLiveProjectiles() const { return LiveProjectiles; }
+	int32 GetPeakLiveProjectiles() const { return PeakLiveProjectiles; }
+
+	// Log and reset the stats
+	void DumpStats() const;
+	void ResetStats();
+
+private:
+	// Expiry time of each token currently held
+	TArray<double> TokenExpiryTimes;
+	void ExpireTokens(double Now);
+	int32 GetBudgetFor(const AActor* Shooter) const;
+
+	// -----Stats-----
+	int32 LiveProjectiles = 0;
+	int32 PeakLiveProjectiles = 0;
+	int32 PeakTokens = 0;
+	int32 GrantedRequests = 0;
+	int32 DeniedRequests = 0;
+};
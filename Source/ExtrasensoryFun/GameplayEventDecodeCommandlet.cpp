@@ -0,0 +1,52 @@
+// by Jason Hilani
+
+
+#include "GameplayEventDecodeCommandlet.h"
+#include "GameplayEventLog.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+// Default constructor
+UGameplayEventDecodeCommandlet::UGameplayEventDecodeCommandlet() {
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+// Read the event file and write one CSV row per event, along with a summary per event type
+int32 UGameplayEventDecodeCommandlet::Main(const FString& Params) {
+	FString Filename;
+	if (!FParse::Value(*Params, TEXT("File="), Filename)) {
+		UE_LOG(LogTemp, Error, TEXT("Missing -File=<path.gevt>"));
+		return 1;
+	}
+	FString OutFilename = FPaths::ChangeExtension(Filename, TEXT("csv"));
+	FParse::Value(*Params, TEXT("Out="), OutFilename);
+
+	TArray<FGameplayEventRecord> Records;
+	if (!FGameplayEventLog::ReadEventFile(Filename, Records)) {
+		UE_LOG(LogTemp, Error, TEXT("%s is not a valid gameplay event file"), *Filename);
+		return 1;
+	}
+
+	int32 TypeCounts[(uint8)EGameplayEventType::Count] = {};
+	FString Csv = TEXT("Frame,Time,Type,ActorId,OtherId,Value\n");
+	for (const FGameplayEventRecord& Record : Records) {
+		Csv += FString::Printf(TEXT("%u,%.4f,%s,%u,%u,%.2f\n"),
+			Record.Frame, Record.Time, FGameplayEventLog::GetTypeName(Record.Type), Record.ActorId, Record.OtherId, Record.Value);
+		if ((uint8)Record.Type < (uint8)EGameplayEventType::Count) {
+			TypeCounts[(uint8)Record.Type]++;
+		}
+	}
+	if (!FFileHelper::SaveStringToFile(Csv, *OutFilename)) {
+		UE_LOG(LogTemp, Error, TEXT("Couldn't write %s"), *OutFilename);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Decoded %d events to %s"), Records.Num(), *OutFilename);
+	for (uint8 Type = 0; Type < (uint8)EGameplayEventType::Count; Type++) {
+		UE_LOG(LogTemp, Display, TEXT("  %s: %d"), FGameplayEventLog::GetTypeName((EGameplayEventType)Type), TypeCounts[Type]);
+	}
+	return 0;
+}
@@ -0,0 +1,23 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "GameplayEventDecodeCommandlet.generated.h"
+
+/**
+ * Decodes a binary gameplay event file into CSV, offline.
+ * Usage: -run=GameplayEventDecode -File=<path.gevt> [-Out=<path.csv>]
+ * Without -Out, the CSV gets written next to the event file.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API UGameplayEventDecodeCommandlet : public UCommandlet {
+	GENERATED_BODY()
+
+public:
+	// Default constructor
+	UGameplayEventDecodeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,184 @@
+// by Jason Hilani
+
+
+#include "GameplayEventLog.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+static TAutoConsoleVariable<bool> CVarEventLogFile(
+	TEXT("ef.EventLog.File"),
+	false,
+	TEXT("Write gameplay events to a binary file in the profiling directory. Decode it with the GameplayEventDecode commandlet."),
+	ECVF_Default
+);
+
+FGameplayEventLog::FGameplayEventLog(uint32 Capacity)
+	: Queue(Capacity)
+	, DroppedCount(0)
+	, bStopping(false)
+	, bStarted(false) {
+	for (std::atomic<uint64>& EventCount : EventCounts) {
+		EventCount.store(0, std::memory_order_relaxed);
+	}
+}
+
+FGameplayEventLog::~FGameplayEventLog() {
+	Stop();
+}
+
+// Global log, started and stopped with the game module
+FGameplayEventLog& FGameplayEventLog::Get() {
+	static FGameplayEventLog EventLog(4096);
+	return EventLog;
+}
+
+// Start the background consumer
+void FGameplayEventLog::Start() {
+	if (Thread) return;
+	bStopping = false;
+	bStarted = true;
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, TEXT("GameplayEventLog"), 0, TPri_BelowNormal);
+}
+
+// Stop the background consumer, it drains whatever is left before exiting
+void FGameplayEventLog::Stop() {
+	if (!Thread) return;
+	bStopping = true;
+	WakeEvent->Trigger();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+	bStarted = false;
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+// Push an event, from the game thread only. Never allocates.
+void FGameplayEventLog::Push(EGameplayEventType Type, const UObject* Actor, const UObject* Other, float Value) {
+	FGameplayEventRecord Record;
+	Record.Frame = (uint32)GFrameCounter;
+	Record.Time = (float)(FPlatformTime::Seconds() - GStartTime);
+	Record.ActorId = Actor ? Actor->GetUniqueID() : 0;
+	Record.OtherId = Other ? Other->GetUniqueID() : 0;
+	Record.Value = Value;
+	Record.Type = Type;
+	FMemory::Memzero(Record.Padding);
+	if (!Queue.Enqueue(Record)) {
+		DroppedCount.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+// Drain the ring buffer on the calling thread, which must be the only consumer
+int32 FGameplayEventLog::Drain() {
+	int32 NumDrained = 0;
+	FGameplayEventRecord Record;
+	while (Queue.Dequeue(Record)) {
+		EventCounts[(uint8)Record.Type].fetch_add(1, std::memory_order_relaxed);
+		WriteRecord(Record);
+		NumDrained++;
+	}
+	return NumDrained;
+}
+
+// Consumer loop, wakes up a few times per second to drain the ring buffer
+uint32 FGameplayEventLog::Run() {
+	while (!bStopping) {
+		WakeEvent->Wait(100);
+		Drain();
+	}
+	Drain();
+	return 0;
+}
+
+// Close the event file when the consumer exits
+void FGameplayEventLog::Exit() {
+	if (FileWriter) {
+		FileWriter->Close();
+		delete FileWriter;
+		FileWriter = nullptr;
+	}
+}
+
+// Write a record to the event file, opening it on the first write
+void FGameplayEventLog::WriteRecord(const FGameplayEventRecord& Record) {
+	if (!CVarEventLogFile.GetValueOnAnyThread() || !bStarted) return;
+
+	if (!FileWriter) {
+		const FString Filename = FPaths::ProfilingDir() / FString::Printf(TEXT("GameplayEvents-%s.gevt"), *FDateTime::Now().ToString());
+		FileWriter = IFileManager::Get().CreateFileWriter(*Filename);
+		if (!FileWriter) return;
+		FGameplayEventFileHeader Header;
+		Header.Magic = FGameplayEventFileHeader::ExpectedMagic;
+		Header.Version = FGameplayEventFileHeader::CurrentVersion;
+		Header.RecordSize = sizeof(FGameplayEventRecord);
+		FileWriter->Serialize(&Header, sizeof(Header));
+	}
+	FileWriter->Serialize(const_cast<FGameplayEventRecord*>(&Record), sizeof(Record));
+}
+
+// Decode an event file written by the log, returns false if the file isn't a valid event file
+bool FGameplayEventLog::ReadEventFile(const FString& Filename, TArray<FGameplayEventRecord>& OutRecords) {
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Filename) || Bytes.Num() < sizeof(FGameplayEventFileHeader)) {
+		return false;
+	}
+	FGameplayEventFileHeader Header;
+	FMemory::Memcpy(&Header, Bytes.GetData(), sizeof(Header));
+	if (Header.Magic != FGameplayEventFileHeader::ExpectedMagic || Header.Version != FGameplayEventFileHeader::CurrentVersion || Header.RecordSize != sizeof(FGameplayEventRecord)) {
+		return false;
+	}
+	// Ignore a partially written record at the end of the file
+	const int32 NumRecords = (Bytes.Num() - sizeof(Header)) / sizeof(FGameplayEventRecord);
+	OutRecords.SetNumUninitialized(NumRecords);
+	FMemory::Memcpy(OutRecords.GetData(), Bytes.GetData() + sizeof(Header), NumRecords * sizeof(FGameplayEventRecord));
+	return true;
+}
+
+const TCHAR* FGameplayEventLog::GetTypeName(EGameplayEventType Type) {
+	switch (Type) {
+	case EGameplayEventType::Damage: return TEXT("Damage");
+	case EGameplayEventType::Death: return TEXT("Death");
+	case EGameplayEventType::Grab: return TEXT("Grab");
+	case EGameplayEventType::Throw: return TEXT("Throw");
+	case EGameplayEventType::Shot: return TEXT("Shot");
+	default: return TEXT("Unknown");
+	}
+}
+
+// Console command to log the event counts
+static FAutoConsoleCommand EventLogStatsCommand(
+	TEXT("ef.EventLog.Stats"),
+	TEXT("Logs the number of gameplay events recorded per type."),
+	FConsoleCommandDelegate::CreateStatic([]() {
+		FGameplayEventLog& EventLog = FGameplayEventLog::Get();
+		for (uint8 Type = 0; Type < (uint8)EGameplayEventType::Count; Type++) {
+			UE_LOG(LogTemp, Display, TEXT("%s: %llu"), FGameplayEventLog::GetTypeName((EGameplayEventType)Type), EventLog.GetEventCount((EGameplayEventType)Type));
+		}
+		UE_LOG(LogTemp, Display, TEXT("Dropped: %llu"), EventLog.GetDroppedCount());
+	})
+);
+
+// Console command to measure the cost of pushing events, on a separate log so the real one isn't flooded
+static FAutoConsoleCommandWithArgs EventLogBenchCommand(
+	TEXT("ef.EventLog.Bench"),
+	TEXT("Measures the per-event cost of pushing gameplay events. Usage: ef.EventLog.Bench [Count=1000000]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args) {
+		const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000000;
+		const int32 BatchSize = 4096;
+		FGameplayEventLog BenchLog(BatchSize);
+		double PushSeconds = 0.0;
+		for (int32 Pushed = 0; Pushed < Count; Pushed += BatchSize) {
+			const int32 NumToPush = FMath::Min(BatchSize - 1, Count - Pushed);
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 i = 0; i < NumToPush; i++) {
+				BenchLog.Push(EGameplayEventType::Damage, nullptr, nullptr, (float)i);
+			}
+			PushSeconds += FPlatformTime::Seconds() - StartTime;
+			BenchLog.Drain();
+		}
+		UE_LOG(LogTemp, Display, TEXT("Pushed %d events: %.1f ns per event"), Count, PushSeconds * 1e9 / FMath::Max(Count, 1));
+	})
+);
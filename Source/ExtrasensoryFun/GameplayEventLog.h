@@ -0,0 +1,96 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Containers/CircularQueue.h"
+#include <atomic>
+
+// Types of gameplay events recorded by the event log
+enum class EGameplayEventType : uint8 {
+	Damage,
+	Death,
+	Grab,
+	Throw,
+	Shot,
+	Count
+};
+
+// Compact binary record for a single gameplay event, written to disk as-is
+struct FGameplayEventRecord {
+	uint32 Frame;
+	float Time;
+	// UObject unique IDs of the actors involved, 0 if none
+	uint32 ActorId;
+	uint32 OtherId;
+	// Damage amount for damage events, unused otherwise
+	float Value;
+	EGameplayEventType Type;
+	uint8 Padding[3];
+};
+static_assert(sizeof(FGameplayEventRecord) == 24, "FGameplayEventRecord is part of the event file format");
+
+// Header at the start of every event file
+struct FGameplayEventFileHeader {
+	uint32 Magic;
+	uint16 Version;
+	uint16 RecordSize;
+
+	static constexpr uint32 ExpectedMagic = 0x54564547; // "GEVT"
+	static constexpr uint16 CurrentVersion = 1;
+};
+
+/**
+ * Fixed-capacity, lock-free gameplay event log.
+ * The game thread pushes compact records into a single-producer single-consumer ring buffer without allocating,
+ * and a background thread drains them into per-type counters and, when ef.EventLog.File is on, a binary file.
+ * Events pushed while the ring buffer is full are dropped and counted.
+ * Only the game thread may push events.
+ */
+class EXTRASENSORYFUN_API FGameplayEventLog : public FRunnable {
+public:
+	explicit FGameplayEventLog(uint32 Capacity);
+	virtual ~FGameplayEventLog();
+
+	// Global log, started and stopped with the game module
+	static FGameplayEventLog& Get();
+
+	// Start and stop the background consumer
+	void Start();
+	void Stop();
+
+	// Push an event, from the game thread only
+	void Push(EGameplayEventType Type, const UObject* Actor, const UObject* Other = nullptr, float Value = 0.f);
+
+	// Drain the ring buffer on the calling thread, returns the number of records drained
+	int32 Drain();
+
+	// Getter methods
+	uint64 GetEventCount(EGameplayEventType Type) const { return EventCounts[(uint8)Type].load(std::memory_order_relaxed); }
+	uint64 GetDroppedCount() const { return DroppedCount.load(std::memory_order_relaxed); }
+
+	// Decode an event file written by the log, returns false if the file isn't a valid event file
+	static bool ReadEventFile(const FString& Filename, TArray<FGameplayEventRecord>& OutRecords);
+	static const TCHAR* GetTypeName(EGameplayEventType Type);
+
+	// FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Exit() override;
+
+private:
+	TCircularQueue<FGameplayEventRecord> Queue;
+	std::atomic<uint64> EventCounts[(uint8)EGameplayEventType::Count];
+	std::atomic<uint64> DroppedCount;
+
+	// Background consumer
+	FRunnableThread* Thread = nullptr;
+	FEvent* WakeEvent = nullptr;
+	std::atomic<bool> bStopping;
+	// Set before the consumer thread is created and cleared once it has exited, so the consumer never reads Thread.
+	// Logs that were never started, like the bench's, drain on the caller and don't write a file.
+	std::atomic<bool> bStarted;
+	// Event file, only touched by the consumer
+	FArchive* FileWriter = nullptr;
+	void WriteRecord(const FGameplayEventRecord& Record);
+};
@@ -6,15 +6,16 @@
 #include <Kismet/GameplayStatics.h>
 #include "BaseCharacter.h"
 #include "EspCharacter.h"
+#include "GameplayEventLog.h"
+#include "ExtrasensoryFunStats.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Health Percent Queries"), STAT_HealthPercentQueries, STATGROUP_ExtrasensoryFun);
 
 // Default constructor
 UHealthComponent::UHealthComponent()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
-	PrimaryComponentTick.bCanEverTick = true;
-
-	// ...
+	// Health only changes on damage, everything else is notified through OnHealthChanged and OnDeath
+	PrimaryComponentTick.bCanEverTick = false;
 }
 
 // Called when the game starts
@@ -24,29 +25,41 @@ void UHealthComponent::BeginPlay() {
 	Health = MaxHealth;
 	// Add function to delegate
 	GetOwner()->OnTakeAnyDamage.AddDynamic(this, &UHealthComponent::DamageTaken);
-	// Get game mode
+	// Get game mode and let it know when the owner dies
 	ExtrasensoryFunGameMode = Cast<AExtrasensoryFunGameMode>(UGameplayStatics::GetGameMode(this));
-
+	if (ExtrasensoryFunGameMode) {
+		ExtrasensoryFunGameMode->RegisterHealthComponent(this);
+	}
+	OnHealthChanged.Broadcast(Health, GetHealthPercent());
 }
 
-// Called every frame
-void UHealthComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+// Health percent, counted so UI polling shows up in "stat game"
+float UHealthComponent::GetHealthPercent() const {
+	INC_DWORD_STAT(STAT_HealthPercentQueries);
+	return Health / MaxHealth;
+}
 
-	// ...
+// Set health and notify listeners if it changed
+void UHealthComponent::SetHealth(float NewHealth) {
+	NewHealth = FMath::Clamp(NewHealth, 0.f, MaxHealth);
+	if (NewHealth != Health) {
+		Health = NewHealth;
+		OnHealthChanged.Broadcast(Health, Health / MaxHealth);
+	}
 }
 
 // Take damage
 void UHealthComponent::DamageTaken(AActor* DamagedActor, float Damage, const UDamageType* DamageType, AController* Instigator, AActor* DamageCauser) {
 	// Check if there's damage and if the actor can die
 	if (Health <= 0.f || Damage <= 0.f || !CanDie) return;
-	UE_LOG(LogTemp, Warning, TEXT("Damage: %f"), Damage);
 	// Apply damage
 	Health -= Damage;
-	UE_LOG(LogTemp, Warning, TEXT("Health Remaining: %f"), Health);
+	FGameplayEventLog::Get().Push(EGameplayEventType::Damage, DamagedActor, DamageCauser, Damage);
+	OnHealthChanged.Broadcast(FMath::Max(Health, 0.f), FMath::Max(Health, 0.f) / MaxHealth);
 	// Check for death
 	if (IsDead()) {
-		ExtrasensoryFunGameMode->ActorDied(DamagedActor);
+		FGameplayEventLog::Get().Push(EGameplayEventType::Death, DamagedActor, DamageCauser);
+		OnDeath.Broadcast(DamagedActor, DamageCauser);
 		if (ABaseCharacter* BaseCharacter = Cast<ABaseCharacter>(DamageCauser->GetOwner())) {
 			if (BaseCharacter->GetTarget().GetActor()) {
 				BaseCharacter->ResetTargeting();
@@ -6,6 +6,9 @@
 #include "Components/ActorComponent.h"
 #include "HealthComponent.generated.h"
 
+// Delegates for health changes and death, so UI and game rules don't have to poll
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnHealthChanged, float, Health, float, HealthPercent);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnDeath, AActor*, DeadActor, AActor*, DamageCauser);
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class EXTRASENSORYFUN_API UHealthComponent : public UActorComponent
@@ -21,14 +24,25 @@ protected:
 	virtual void BeginPlay() override;
 
 public:
-	// Called every frame
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
-	
+	// Broadcast whenever health changes
+	UPROPERTY(BlueprintAssignable)
+	FOnHealthChanged OnHealthChanged;
+	// Broadcast once when health reaches 0
+	UPROPERTY(BlueprintAssignable)
+	FOnDeath OnDeath;
+
 	// Getter methods
 	UFUNCTION(BlueprintPure)
-	float GetHealthPercent() const { return Health / MaxHealth; }
+	float GetHealthPercent() const;
 	UFUNCTION(BlueprintPure)
 	bool IsDead() const { return Health <= 0.f; }
+	float GetHealth() const { return Health; }
+	float GetMaxHealth() const { return MaxHealth; }
+
+	// Setter method, used to carry health over when an actor stands in for another representation
+	void SetHealth(float NewHealth);
+	// Bring health back to max, used when reusing an actor
+	void ResetHealth() { SetHealth(MaxHealth); }
 
 private:
 	// -----Health and death properties-----
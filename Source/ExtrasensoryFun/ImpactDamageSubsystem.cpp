@@ -0,0 +1,247 @@
+// by Jason Hilani
+
+
+#include "ImpactDamageSubsystem.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PBDRigidsSolver.h"
+#include "EventManager.h"
+#include "EventsData.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMeshActor.h"
+#include "Kismet/GameplayStatics.h"
+#include "TimerManager.h"
+#include "HealthComponent.h"
+#include "ShooterCharacter.h"
+#include "ShooterProjectile.h"
+#include "ThrownObjectSubsystem.h"
+#include "CollisionProfiles.h"
+#include "ExtrasensoryFunStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Impact Contacts"), STAT_ImpactContacts, STATGROUP_ExtrasensoryFun);
+DECLARE_CYCLE_STAT(TEXT("Impact Damage"), STAT_ImpactDamage, STATGROUP_ExtrasensoryFun);
+
+static TAutoConsoleVariable<float> CVarImpactMinSpeed(
+	TEXT("ef.Physics.ImpactMinSpeed"),
+	1000.f,
+	TEXT("Relative speed under which a thrown object's impact does no damage."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarImpactDamageScale(
+	TEXT("ef.Physics.ImpactDamageScale"),
+	0.0002f,
+	TEXT("Damage per unit of momentum (relative speed in cm/s times the thrown object's mass in kg)."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarImpactMaxDamage(
+	TEXT("ef.Physics.ImpactMaxDamage"),
+	150.f,
+	TEXT("Maximum damage of a single impact."),
+	ECVF_Default
+);
+
+// Listen to the solver's collision events, only where damage is applied
+void UImpactDamageSubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+	Super::OnWorldBeginPlay(InWorld);
+	FPhysScene* PhysScene = InWorld.GetPhysicsScene();
+	if (!PhysScene || InWorld.GetNetMode() == NM_Client) return;
+	if (Chaos::FPhysicsSolver* Solver = PhysScene->GetSolver()) {
+		Solver->SetGenerateCollisionData(true);
+		Solver->GetEventManager()->RegisterHandler<Chaos::FCollisionEventData>(Chaos::EEventType::Collision, this, &UImpactDamageSubsystem::HandleCollisionEvents);
+		bRegistered = true;
+	}
+}
+
+void UImpactDamageSubsystem::Deinitialize() {
+	FPhysScene* PhysScene = GetWorld()->GetPhysicsScene();
+	if (bRegistered && PhysScene && PhysScene->GetSolver()) {
+		PhysScene->GetSolver()->GetEventManager()->UnregisterHandler(Chaos::EEventType::Collision, this);
+	}
+	bRegistered = false;
+	Super::Deinitialize();
+}
+
+// Damage for an impact, 0 under the minimum speed
+float UImpactDamageSubsystem::ComputeImpactDamage(float RelativeSpeed, float Mass) {
+	if (RelativeSpeed < CVarImpactMinSpeed.GetValueOnGameThread()) return 0.f;
+	return FMath::Min(RelativeSpeed * Mass * CVarImpactDamageScale.GetValueOnGameThread(), CVarImpactMaxDamage.GetValueOnGameThread());
+}
+
+/**
+* Keep the contacts between a tracked thrown object and an actor with health, and queue the strongest one per object and victim.
+* Contacts are looked up against the tracked set once, so untracked bodies cost a set lookup each.
+*/
+void UImpactDamageSubsystem::HandleCollisionEvents(const Chaos::FCollisionEventData& CollisionData) {
+	EF_SCOPE_CYCLE_COUNTER(STAT_ImpactContacts);
+	const double StartTime = FPlatformTime::Seconds();
+	const TArray<Chaos::FCollidingData>& Contacts = CollisionData.CollisionData.AllCollisionsArray;
+	const UThrownObjectSubsystem* ThrownObjects = GetWorld()->GetSubsystem<UThrownObjectSubsystem>();
+	FPhysScene* PhysScene = GetWorld()->GetPhysicsScene();
+	if (Contacts.Num() == 0 || !ThrownObjects || ThrownObjects->GetNumTracked() == 0 || !PhysScene) return;
+	ThrownObjects->GetTrackedComponents(TrackedComponents);
+	ContactsProcessed += Contacts.Num();
+
+	for (const Chaos::FCollidingData& Contact : Contacts) {
+		UPrimitiveComponent* Component1 = PhysScene->GetOwningComponent<UPrimitiveComponent>(Contact.Proxy1);
+		UPrimitiveComponent* Component2 = PhysScene->GetOwningComponent<UPrimitiveComponent>(Contact.Proxy2);
+		// The thrown object can be either side of the contact
+		const bool bThrown1 = TrackedComponents.Contains(Component1);
+		if (!bThrown1 && !TrackedComponents.Contains(Component2)) continue;
+		UPrimitiveComponent* Thrown = bThrown1 ? Component1 : Component2;
+		UPrimitiveComponent* Other = bThrown1 ? Component2 : Component1;
+		AActor* Victim = Other ? Other->GetOwner() : nullptr;
+		if (!Victim || Victim == Thrown->GetOwner()->GetOwner() || Thrown->GetOwner()->IsA<AShooterProjectile>()
+			|| !Victim->FindComponentByClass<UHealthComponent>()) continue;
+
+		const float RelativeSpeed = (float)(Contact.Velocity1 - Contact.Velocity2).Size();
+		const float Damage = ComputeImpactDamage(RelativeSpeed, (float)(bThrown1 ? Contact.Mass1 : Contact.Mass2));
+		if (Damage <= 0.f) continue;
+		auto* Victims = DamagedVictims.Find(Thrown);
+		if (Victims && Victims->Contains(Victim)) continue;
+
+		FImpact* Pending = PendingImpacts.FindByPredicate([Thrown, Victim](const FImpact& Impact) {
+			return Impact.Thrown.Get() == Thrown && Impact.Victim.Get() == Victim;
+		});
+		if (Pending) {
+			Pending->Damage = FMath::Max(Pending->Damage, Damage);
+		} else {
+			PendingImpacts.Add({ Thrown, Victim, Damage });
+		}
+	}
+	CollectSeconds += FPlatformTime::Seconds() - StartTime;
+}
+
+// Apply the frame's impacts in one pass, and forget the victims of throws that ended
+void UImpactDamageSubsystem::Tick(float DeltaTime) {
+	EF_SCOPE_CYCLE_COUNTER(STAT_ImpactDamage);
+	const double StartTime = FPlatformTime::Seconds();
+	for (const FImpact& Impact : PendingImpacts) {
+		UPrimitiveComponent* Thrown = Impact.Thrown.Get();
+		AActor* Victim = Impact.Victim.Get();
+		if (!Thrown || !Victim) continue;
+		AActor* Thrower = Thrown->GetOwner()->GetOwner();
+		UGameplayStatics::ApplyDamage(Victim, Impact.Damage, Thrower ? Thrower->GetInstigatorController() : nullptr, Thrown->GetOwner(), UDamageType::StaticClass());
+		DamagedVictims.FindOrAdd(Thrown).Add(Victim);
+		ImpactsApplied++;
+		TotalDamage += Impact.Damage;
+	}
+	PendingImpacts.Reset();
+
+	if (DamagedVictims.Num() > 0) {
+		const UThrownObjectSubsystem* ThrownObjects = GetWorld()->GetSubsystem<UThrownObjectSubsystem>();
+		for (auto It = DamagedVictims.CreateIterator(); It; ++It) {
+			if (!ThrownObjects || !ThrownObjects->IsTracked(It.Key().ResolveObjectPtr())) {
+				It.RemoveCurrent();
+			}
+		}
+	}
+	ApplySeconds += FPlatformTime::Seconds() - StartTime;
+}
+
+TStatId UImpactDamageSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UImpactDamageSubsystem, STATGROUP_Tickables);
+}
+
+// Log the stats
+void UImpactDamageSubsystem::DumpStats() const {
+	UE_LOG(LogTemp, Display, TEXT("Impact damage: %lld contacts, %d impacts, %.0f damage, %.3f ms collecting, %.3f ms applying"),
+		ContactsProcessed, ImpactsApplied, TotalDamage, CollectSeconds * 1000.0, ApplySeconds * 1000.0);
+}
+
+void UImpactDamageSubsystem::ResetStats() {
+	ContactsProcessed = 0;
+	ImpactsApplied = 0;
+	TotalDamage = 0.0;
+	CollectSeconds = 0.0;
+	ApplySeconds = 0.0;
+}
+
+// -----Console commands-----
+
+/**
+* Throw Objects cubes at Enemies shooters lined up in front of the player, and report the impact processing cost and results.
+* The shooters are spawned without a controller so they stand still.
+*/
+static void ImpactDamageBench(const TArray<FString>& Args, UWorld* World) {
+	const int32 NumObjects = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 200;
+	const int32 NumEnemies = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 50;
+	UImpactDamageSubsystem* ImpactDamage = World->GetSubsystem<UImpactDamageSubsystem>();
+	UThrownObjectSubsystem* ThrownObjects = World->GetSubsystem<UThrownObjectSubsystem>();
+	APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(World, 0);
+	UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	UClass* ShooterClass = TSoftClassPtr<AShooterCharacter>(FSoftObjectPath(TEXT("/Game/Characters/ShooterCharacter/BP_RocketShooterCharacter.BP_RocketShooterCharacter_C"))).LoadSynchronous();
+	if (!ImpactDamage || !ThrownObjects || !PlayerPawn || !Cube || !ShooterClass) {
+		UE_LOG(LogTemp, Error, TEXT("Impact damage bench: needs a player pawn and the shooter class"));
+		return;
+	}
+
+	// Enemies on a line 2000 units in front of the player, objects in rows between the player and the line, all aimed at the line.
+	// Everything is at the height of the player's capsule center, which is the enemies' torso height on flat ground.
+	const FVector Origin = PlayerPawn->GetActorLocation();
+	const FVector Forward = PlayerPawn->GetActorForwardVector().GetSafeNormal2D();
+	const FVector Right = FVector::CrossProduct(FVector::UpVector, Forward);
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	TArray<TWeakObjectPtr<AActor>> Spawned;
+	TArray<TWeakObjectPtr<UHealthComponent>> EnemyHealth;
+	for (int32 i = 0; i < NumEnemies; i++) {
+		const FVector Location = Origin + Forward * 2000.f + Right * (i - NumEnemies / 2) * 120.f;
+		if (AShooterCharacter* Shooter = World->SpawnActor<AShooterCharacter>(ShooterClass, Location, (-Forward).Rotation(), SpawnParams)) {
+			Spawned.Add(Shooter);
+			EnemyHealth.Add(Shooter->GetHealthComponent());
+		}
+	}
+	const float LineWidth = NumEnemies * 120.f;
+	const int32 Columns = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt((float)NumObjects)));
+	for (int32 i = 0; i < NumObjects; i++) {
+		const FVector Location = Origin + Forward * (300.f + (i / Columns) * 60.f) + Right * ((i % Columns) / (float)Columns - 0.5f) * LineWidth;
+		AStaticMeshActor* Actor = World->SpawnActor<AStaticMeshActor>(Location, FRotator::ZeroRotator);
+		UStaticMeshComponent* Mesh = Actor->GetStaticMeshComponent();
+		Mesh->SetMobility(EComponentMobility::Movable);
+		Mesh->SetStaticMesh(Cube);
+		Actor->SetActorScale3D(FVector(0.3f));
+		Actor->SetOwner(PlayerPawn);
+		CollisionProfiles::Apply(Mesh, CollisionProfiles::GetThrownProfile());
+		Mesh->SetPhysicsLinearVelocity(Forward * 12000.f);
+		ThrownObjects->TrackThrow(Mesh);
+		Spawned.Add(Actor);
+	}
+	ImpactDamage->ResetStats();
+
+	FTimerHandle Unused;
+	World->GetTimerManager().SetTimer(Unused, [ImpactDamage, Spawned, EnemyHealth, NumObjects]() {
+		int32 Damaged = 0;
+		int32 Dead = 0;
+		for (const TWeakObjectPtr<UHealthComponent>& Health : EnemyHealth) {
+			if (Health.IsValid() && Health->GetHealth() < Health->GetMaxHealth()) {
+				Damaged++;
+				Dead += Health->IsDead() ? 1 : 0;
+			}
+		}
+		UE_LOG(LogTemp, Display, TEXT("Impact damage bench: %d objects, %d enemies damaged, %d killed"), NumObjects, Damaged, Dead);
+		ImpactDamage->DumpStats();
+		for (const TWeakObjectPtr<AActor>& Actor : Spawned) {
+			if (Actor.IsValid()) {
+				Actor->Destroy();
+			}
+		}
+	}, 2.f, false);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs ImpactDamageBenchCommand(
+	TEXT("ef.Physics.ImpactBench"),
+	TEXT("Throws a barrage of objects at a line of enemies and reports impact damage results and processing time. Usage: ef.Physics.ImpactBench [Objects=200] [Enemies=50]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ImpactDamageBench)
+);
+
+static FAutoConsoleCommandWithWorld ImpactDamageStatsCommand(
+	TEXT("ef.Physics.ImpactStats"),
+	TEXT("Logs the impact damage counters and processing time."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World) {
+		if (UImpactDamageSubsystem* ImpactDamage = World->GetSubsystem<UImpactDamageSubsystem>()) {
+			ImpactDamage->DumpStats();
+		}
+	})
+);
@@ -0,0 +1,61 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ImpactDamageSubsystem.generated.h"
+
+namespace Chaos {
+	struct FCollisionEventData;
+}
+
+/**
+ * Damage from thrown objects hitting characters.
+ * Instead of a hit delegate per object, the subsystem takes the physics solver's collision events in bulk once per physics frame,
+ * keeps the contacts involving objects tracked by UThrownObjectSubsystem, and queues one impact per object and character.
+ * The queued impacts are applied in a single pass in Tick, through ApplyDamage and so UHealthComponent::DamageTaken.
+ * Damage scales with the relative speed and the thrown object's mass, and each throw damages a character at most once.
+ * Projectiles already apply their own damage on hit, so they're left out.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API UImpactDamageSubsystem : public UTickableWorldSubsystem {
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Damage for an impact, 0 under ef.Physics.ImpactMinSpeed
+	static float ComputeImpactDamage(float RelativeSpeed, float Mass);
+
+	// Log and reset the stats
+	void DumpStats() const;
+	void ResetStats();
+
+private:
+	// Solver event handler, on the game thread with every contact of the last physics frame
+	void HandleCollisionEvents(const Chaos::FCollisionEventData& CollisionData);
+	bool bRegistered = false;
+
+	struct FImpact {
+		TWeakObjectPtr<UPrimitiveComponent> Thrown;
+		TWeakObjectPtr<AActor> Victim;
+		float Damage;
+	};
+	// Impacts to apply this frame, one per thrown object and victim
+	TArray<FImpact> PendingImpacts;
+	// Victims already damaged by each tracked object's current throw
+	TMap<TObjectKey<UPrimitiveComponent>, TArray<TWeakObjectPtr<AActor>, TInlineAllocator<2>>> DamagedVictims;
+	// Reused for the contact lookups
+	TSet<const UPrimitiveComponent*> TrackedComponents;
+
+	// -----Stats-----
+	int64 ContactsProcessed = 0;
+	int32 ImpactsApplied = 0;
+	double TotalDamage = 0.0;
+	double CollectSeconds = 0.0;
+	double ApplySeconds = 0.0;
+};
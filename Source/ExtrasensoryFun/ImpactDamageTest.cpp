@@ -0,0 +1,39 @@
+// by Jason Hilani
+
+
+#include "ImpactDamageSubsystem.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Checked against the current ef.Physics.Impact* settings, so it holds whatever they're tuned to
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FImpactDamageComputeTest, "ExtrasensoryFun.ImpactDamage.Compute",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FImpactDamageComputeTest::RunTest(const FString& Parameters) {
+	IConsoleManager& ConsoleManager = IConsoleManager::Get();
+	const IConsoleVariable* MinSpeedVariable = ConsoleManager.FindConsoleVariable(TEXT("ef.Physics.ImpactMinSpeed"));
+	const IConsoleVariable* ScaleVariable = ConsoleManager.FindConsoleVariable(TEXT("ef.Physics.ImpactDamageScale"));
+	const IConsoleVariable* MaxDamageVariable = ConsoleManager.FindConsoleVariable(TEXT("ef.Physics.ImpactMaxDamage"));
+	if (!TestNotNull(TEXT("Min speed setting"), MinSpeedVariable) || !TestNotNull(TEXT("Scale setting"), ScaleVariable)
+		|| !TestNotNull(TEXT("Max damage setting"), MaxDamageVariable)) {
+		return false;
+	}
+	const float MinSpeed = MinSpeedVariable->GetFloat();
+	const float Scale = ScaleVariable->GetFloat();
+	const float MaxDamage = MaxDamageVariable->GetFloat();
+	if (!TestTrue(TEXT("Impact settings are positive"), MinSpeed > 0.f && Scale > 0.f && MaxDamage > 0.f)) {
+		return false;
+	}
+
+	// A mass that does a quarter of the cap at the minimum speed
+	const float Mass = MaxDamage * 0.25f / (MinSpeed * Scale);
+	TestEqual(TEXT("No damage under the minimum speed"), UImpactDamageSubsystem::ComputeImpactDamage(MinSpeed * 0.99f, Mass), 0.f);
+	TestEqual(TEXT("Damage at the minimum speed"), UImpactDamageSubsystem::ComputeImpactDamage(MinSpeed, Mass), MaxDamage * 0.25f, MaxDamage * 1e-4f);
+	TestEqual(TEXT("Damage scales with speed"), UImpactDamageSubsystem::ComputeImpactDamage(MinSpeed * 2.f, Mass), MaxDamage * 0.5f, MaxDamage * 1e-4f);
+	TestEqual(TEXT("Damage scales with mass"), UImpactDamageSubsystem::ComputeImpactDamage(MinSpeed, Mass * 3.f), MaxDamage * 0.75f, MaxDamage * 1e-4f);
+	TestEqual(TEXT("Damage is capped"), UImpactDamageSubsystem::ComputeImpactDamage(MinSpeed * 10.f, Mass), MaxDamage);
+	return true;
+}
+
+#endif
@@ -0,0 +1,274 @@
+// by Jason Hilani
+
+
+#include "InputReplaySubsystem.h"
+#include "LevelResetSubsystem.h"
+#include "ESPCharacter.h"
+#include "HealthComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerInput.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "EngineUtils.h"
+
+namespace InputRecordingFormat {
+	constexpr uint32 Magic = 0x52494645; // "EFIR"
+	constexpr uint16 Version = 2;
+}
+
+// Start recording, with a fixed timestep if FixedFPS is above 0
+void UInputReplaySubsystem::StartRecording(const FString& Name, float FixedFPS) {
+	if (Mode != EMode::None) return;
+
+	RecordingName = Name;
+	Seed = (int32)FPlatformTime::Cycles();
+	KeyNames.Reset();
+	Frames.Reset();
+	PendingEvents.Reset();
+	bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+	PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	if (FixedFPS > 0.f) {
+		FApp::SetUseFixedTimeStep(true);
+		FApp::SetFixedDeltaTime(1.0 / FixedFPS);
+	}
+	ResetSimulation();
+	Mode = EMode::Recording;
+	UE_LOG(LogTemp, Display, TEXT("Recording input to %s (seed %d)"), *GetRecordingPath(Name), Seed);
+}
+
+// Stop recording and write the file
+bool UInputReplaySubsystem::StopRecording() {
+	if (Mode != EMode::Recording) return false;
+	Mode = EMode::None;
+	FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+	FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+
+	uint32 Magic = InputRecordingFormat::Magic;
+	uint16 Version = InputRecordingFormat::Version;
+	uint32 Checksum = ComputeStateChecksum();
+	TArray<FString> KeyStrings;
+	for (const FName& KeyName : KeyNames) {
+		KeyStrings.Add(KeyName.ToString());
+	}
+	int32 NumFrames = Frames.Num();
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	Writer << Magic << Version << Seed << Checksum << KeyStrings << NumFrames;
+	for (FInputFrame& Frame : Frames) {
+		uint16 NumEvents = Frame.Events.Num();
+		Writer << Frame.DeltaTime << NumEvents;
+		for (FInputEvent& Event : Frame.Events) {
+			Writer << Event.KeyIndex << Event.Event << Event.NumSamples << Event.Delta;
+		}
+	}
+
+	const bool bSaved = FFileHelper::SaveArrayToFile(Bytes, *GetRecordingPath(RecordingName));
+	UE_LOG(LogTemp, Display, TEXT("Recorded %d frames of input (%d bytes), final state checksum %08x"), NumFrames, Bytes.Num(), Checksum);
+	return bSaved;
+}
+
+// Load a recording and start replaying it, returns false if the file is missing or invalid
+bool UInputReplaySubsystem::StartReplay(const FString& Name) {
+	if (Mode != EMode::None) return false;
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *GetRecordingPath(Name))) {
+		UE_LOG(LogTemp, Warning, TEXT("Input recording %s not found"), *Name);
+		return false;
+	}
+	FMemoryReader Reader(Bytes);
+	uint32 Magic = 0;
+	uint16 Version = 0;
+	TArray<FString> KeyStrings;
+	int32 NumFrames = 0;
+	Reader << Magic << Version;
+	if (Magic != InputRecordingFormat::Magic || Version != InputRecordingFormat::Version) {
+		UE_LOG(LogTemp, Warning, TEXT("Input recording %s is invalid or from another version"), *Name);
+		return false;
+	}
+	Reader << Seed << RecordedChecksum << KeyStrings << NumFrames;
+	KeyNames.Reset(KeyStrings.Num());
+	for (const FString& KeyString : KeyStrings) {
+		KeyNames.Add(FName(*KeyString));
+	}
+	Frames.SetNum(FMath::Max(NumFrames, 0));
+	for (FInputFrame& Frame : Frames) {
+		uint16 NumEvents = 0;
+		Reader << Frame.DeltaTime << NumEvents;
+		Frame.Events.SetNum(NumEvents);
+		for (FInputEvent& Event : Frame.Events) {
+			Reader << Event.KeyIndex << Event.Event << Event.NumSamples << Event.Delta;
+		}
+	}
+	if (Reader.IsError() || Frames.Num() == 0) {
+		UE_LOG(LogTemp, Warning, TEXT("Input recording %s is truncated"), *Name);
+		return false;
+	}
+
+	RecordingName = Name;
+	bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+	PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	ResetSimulation();
+	Mode = EMode::Replaying;
+	// Every frame gets exactly the delta time it had when recorded
+	FApp::SetUseFixedTimeStep(true);
+	ReplayFrame = 0;
+	FApp::SetFixedDeltaTime(Frames[0].DeltaTime);
+	InjectFrame(Frames[0]);
+	UE_LOG(LogTemp, Display, TEXT("Replaying %d frames of input from %s"), Frames.Num(), *Name);
+	return true;
+}
+
+// Called by the player controller for every key and axis event
+void UInputReplaySubsystem::RecordInput(const FInputKeyParams& Params) {
+	if (Mode != EMode::Recording) return;
+
+	int32 KeyIndex = KeyNames.AddUnique(Params.Key.GetFName());
+	FInputEvent& Event = PendingEvents.AddDefaulted_GetRef();
+	Event.KeyIndex = (uint16)KeyIndex;
+	Event.Event = (uint8)Params.Event;
+	Event.NumSamples = (uint8)FMath::Clamp(Params.NumSamples, 0, MAX_uint8);
+	Event.Delta = FVector2f((float)Params.Delta.X, (float)Params.Delta.Y);
+}
+
+// Feed a frame's events to the player controller, they get processed by the bindings on the next world tick
+void UInputReplaySubsystem::InjectFrame(const FInputFrame& Frame) {
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (!PlayerController) return;
+
+	bInjecting = true;
+	for (const FInputEvent& Event : Frame.Events) {
+		FInputKeyParams Params;
+		Params.Key = FKey(KeyNames[Event.KeyIndex]);
+		Params.Event = (EInputEvent)Event.Event;
+		Params.Delta = FVector(Event.Delta.X, Event.Delta.Y, 0.f);
+		Params.NumSamples = Event.NumSamples;
+		Params.DeltaTime = Frame.DeltaTime;
+		PlayerController->InputKey(Params);
+	}
+	bInjecting = false;
+}
+
+// Commit the recorded frame, or feed the next replayed one
+void UInputReplaySubsystem::Tick(float DeltaTime) {
+	if (Mode == EMode::Recording) {
+		FInputFrame& Frame = Frames.AddDefaulted_GetRef();
+		Frame.DeltaTime = FApp::GetDeltaTime();
+		Frame.Events = MoveTemp(PendingEvents);
+		PendingEvents.Reset();
+	} else if (Mode == EMode::Replaying) {
+		ReplayFrame++;
+		if (ReplayFrame < Frames.Num()) {
+			FApp::SetFixedDeltaTime(Frames[ReplayFrame].DeltaTime);
+			InjectFrame(Frames[ReplayFrame]);
+		} else {
+			StopReplay();
+		}
+	} else if (!PendingReplayName.IsEmpty()) {
+		// Started from a tick like the console command, so the first frame isn't advanced in the same tick it's injected
+		StartReplay(PendingReplayName);
+		PendingReplayName.Reset();
+	}
+}
+
+// Compare the final state with the recorded one
+void UInputReplaySubsystem::StopReplay() {
+	Mode = EMode::None;
+	FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+	FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+
+	const uint32 Checksum = ComputeStateChecksum();
+	const bool bMatch = Checksum == RecordedChecksum;
+	if (bMatch) {
+		UE_LOG(LogTemp, Display, TEXT("Replay of %s finished, final state matches (%08x)"), *RecordingName, Checksum);
+	} else {
+		UE_LOG(LogTemp, Error, TEXT("Replay of %s finished, final state differs: %08x, recorded %08x"), *RecordingName, Checksum, RecordedChecksum);
+	}
+	if (FParse::Param(FCommandLine::Get(), TEXT("InputReplayExit"))) {
+		FPlatformMisc::RequestExitWithStatus(false, bMatch ? 0 : 1);
+	}
+}
+
+// Put the world and the random streams in the same state for recording and replaying
+void UInputReplaySubsystem::ResetSimulation() {
+	ULevelResetSubsystem* LevelReset = GetWorld()->GetSubsystem<ULevelResetSubsystem>();
+	if (LevelReset && LevelReset->HasSnapshot()) {
+		LevelReset->ResetLevel();
+	}
+	FMath::RandInit(Seed);
+	FMath::SRandInit(Seed);
+}
+
+// Hash of the characters' and grabbable props' quantized state, independent of actor order
+uint32 UInputReplaySubsystem::ComputeStateChecksum() const {
+	uint32 Checksum = 0;
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It) {
+		AActor* Actor = *It;
+		int32 State[4] = { 0, 0, 0, 0 };
+		if (ABaseCharacter* Character = Cast<ABaseCharacter>(Actor)) {
+			State[3] = FMath::RoundToInt(Character->GetHealthComponent()->GetHealth() * 100.f);
+		} else if (!AESPCharacter::IsGrabbable(Cast<UPrimitiveComponent>(Actor->GetRootComponent()))) {
+			continue;
+		}
+		// Eighths of a centimeter, like checkpoints
+		const FVector Location = Actor->GetActorLocation();
+		for (int32 i = 0; i < 3; i++) {
+			State[i] = FMath::RoundToInt(Location[i] * 8.0);
+		}
+		Checksum ^= HashCombine(GetTypeHash(Actor->GetFName()), FCrc::MemCrc32(State, sizeof(State)));
+	}
+	return Checksum;
+}
+
+FString UInputReplaySubsystem::GetRecordingPath(const FString& Name) {
+	return FPaths::ProjectSavedDir() / TEXT("InputRecordings") / Name + TEXT(".efir");
+}
+
+// Start a replay from the command line with -InputReplay=Name on the first tick, once the level snapshot is taken
+void UInputReplaySubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (InWorld.IsGameWorld()) {
+		FParse::Value(FCommandLine::Get(), TEXT("InputReplay="), PendingReplayName);
+	}
+}
+
+TStatId UInputReplaySubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UInputReplaySubsystem, STATGROUP_Tickables);
+}
+
+// Console commands to record and replay input
+static FAutoConsoleCommandWithWorldAndArgs RecordInputCommand(
+	TEXT("ef.Input.Record"),
+	TEXT("Resets the level and records the player's input. Usage: ef.Input.Record [Name=Session] [FixedFPS]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World) {
+		if (UInputReplaySubsystem* InputReplay = World->GetSubsystem<UInputReplaySubsystem>()) {
+			InputReplay->StartRecording(Args.Num() > 0 ? Args[0] : TEXT("Session"), Args.Num() > 1 ? FCString::Atof(*Args[1]) : 0.f);
+		}
+	})
+);
+
+static FAutoConsoleCommandWithWorld StopRecordingCommand(
+	TEXT("ef.Input.Stop"),
+	TEXT("Stops recording input and writes the file."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World) {
+		if (UInputReplaySubsystem* InputReplay = World->GetSubsystem<UInputReplaySubsystem>()) {
+			InputReplay->StopRecording();
+		}
+	})
+);
+
+static FAutoConsoleCommandWithWorldAndArgs ReplayInputCommand(
+	TEXT("ef.Input.Replay"),
+	TEXT("Resets the level and replays recorded input, then compares the final state. Usage: ef.Input.Replay [Name=Session]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World) {
+		if (UInputReplaySubsystem* InputReplay = World->GetSubsystem<UInputReplaySubsystem>()) {
+			InputReplay->StartReplay(Args.Num() > 0 ? Args[0] : TEXT("Session"));
+		}
+	})
+);
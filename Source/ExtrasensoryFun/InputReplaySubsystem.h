@@ -0,0 +1,89 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "InputReplaySubsystem.generated.h"
+
+struct FInputKeyParams;
+
+/**
+ * Records the player's raw key and axis input per frame, and replays it through the same input bindings.
+ * Recordings store the random seed, every frame's delta time and a checksum of the final world state.
+ * Replays run at a fixed timestep using the recorded delta times and compare the checksum once done, so two builds
+ * can be compared on the exact same play session and any change in behaviour shows up as a mismatch.
+ * Both start from the level's reset snapshot.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API UInputReplaySubsystem : public UTickableWorldSubsystem {
+	GENERATED_BODY()
+
+public:
+	// Start recording, with a fixed timestep if FixedFPS is above 0
+	void StartRecording(const FString& Name, float FixedFPS = 0.f);
+	// Stop recording and write the file
+	bool StopRecording();
+	// Load a recording and start replaying it, returns false if the file is missing or invalid
+	bool StartReplay(const FString& Name);
+
+	bool IsRecording() const { return Mode == EMode::Recording; }
+	bool IsReplaying() const { return Mode == EMode::Replaying; }
+	// True while the replay is feeding input, so the player controller lets it through
+	bool IsInjecting() const { return bInjecting; }
+
+	// Called by the player controller for every key and axis event
+	void RecordInput(const FInputKeyParams& Params);
+
+	// Hash of the characters' and grabbable props' quantized state
+	uint32 ComputeStateChecksum() const;
+
+	static FString GetRecordingPath(const FString& Name);
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	enum class EMode : uint8 {
+		None,
+		Recording,
+		Replaying
+	};
+
+	// A single key or axis event
+	struct FInputEvent {
+		uint16 KeyIndex;
+		uint8 Event;
+		uint8 NumSamples;
+		// Axis value, both axes for 2D axes like the mouse
+		FVector2f Delta;
+	};
+	// The events processed in a frame and the frame's delta time
+	struct FInputFrame {
+		float DeltaTime;
+		TArray<FInputEvent> Events;
+	};
+
+	EMode Mode = EMode::None;
+	FString RecordingName;
+	int32 Seed = 0;
+	// Keys referenced by the events, stored once in the file
+	TArray<FName> KeyNames;
+	TArray<FInputFrame> Frames;
+	// Events received since the last committed frame while recording
+	TArray<FInputEvent> PendingEvents;
+	int32 ReplayFrame = 0;
+	// Recording to replay on the first tick, from -InputReplay=
+	FString PendingReplayName;
+	uint32 RecordedChecksum = 0;
+	bool bInjecting = false;
+	// Timestep settings to restore when done
+	bool bPreviousUseFixedTimeStep = false;
+	double PreviousFixedDeltaTime = 0.0;
+
+	// Put the world and the random streams in the same state for recording and replaying
+	void ResetSimulation();
+	void InjectFrame(const FInputFrame& Frame);
+	void StopReplay();
+};
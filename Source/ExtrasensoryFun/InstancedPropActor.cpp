@@ -0,0 +1,40 @@
+// by Jason Hilani
+
+
+#include "InstancedPropActor.h"
+#include "InstancedPropContainer.h"
+#include "CollisionProfiles.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Net/UnrealNetwork.h"
+
+// Default constructor
+AInstancedPropActor::AInstancedPropActor() {
+	bReplicates = true;
+	SetReplicatingMovement(true);
+	// Replicated movement can't move a static root, and the clients' grab sweep needs the Grabbable profile
+	UStaticMeshComponent* Mesh = GetStaticMeshComponent();
+	Mesh->SetMobility(EComponentMobility::Movable);
+	Mesh->SetCollisionProfileName(CollisionProfiles::Grabbable);
+}
+
+// Take the container's mesh and materials
+void AInstancedPropActor::SetContainer(AInstancedPropContainer* InContainer) {
+	Container = InContainer;
+	OnRep_Container();
+}
+
+void AInstancedPropActor::OnRep_Container() {
+	if (!Container) return;
+	const UHierarchicalInstancedStaticMeshComponent* Instances = Container->GetInstances();
+	UStaticMeshComponent* Mesh = GetStaticMeshComponent();
+	Mesh->SetStaticMesh(Instances->GetStaticMesh());
+	for (int32 i = 0; i < Instances->GetNumMaterials(); i++) {
+		Mesh->SetMaterial(i, Instances->GetMaterial(i));
+	}
+}
+
+void AInstancedPropActor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const {
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(AInstancedPropActor, Container, COND_InitialOnly);
+}
@@ -0,0 +1,35 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StaticMeshActor.h"
+#include "InstancedPropActor.generated.h"
+
+class AInstancedPropContainer;
+
+/**
+ * Replicated prop an instanced prop container expands into in network games.
+ * Mobility and collision profile are set in the constructor so clients, which create the actor from its class defaults,
+ * get a movable grabbable prop as well. Mesh and materials come from the container, which is replicated as a reference.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API AInstancedPropActor : public AStaticMeshActor {
+	GENERATED_BODY()
+
+public:
+	// Default constructor
+	AInstancedPropActor();
+
+	// Take the container's mesh and materials, on the server and on clients once the container has replicated
+	void SetContainer(AInstancedPropContainer* InContainer);
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+private:
+	UPROPERTY(ReplicatedUsing = OnRep_Container)
+	AInstancedPropContainer* Container;
+
+	UFUNCTION()
+	void OnRep_Container();
+};
@@ -0,0 +1,438 @@
+// by Jason Hilani
+
+
+#include "InstancedPropContainer.h"
+#include "InstancedPropActor.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/Engine.h"
+#include "Kismet/GameplayStatics.h"
+#include "EngineUtils.h"
+#include "Containers/Ticker.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "RenderCore.h"
+#include "ESPCharacter.h"
+#include "ThrownObjectSubsystem.h"
+#include "CollisionProfiles.h"
+#include "ExtrasensoryFunStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Instanced Props Tick"), STAT_InstancedPropsTick, STATGROUP_ExtrasensoryFun);
+DECLARE_CYCLE_STAT(TEXT("Promote Instance"), STAT_PromoteInstance, STATGROUP_ExtrasensoryFun);
+
+// Default constructor
+AInstancedPropContainer::AInstancedPropContainer() {
+	// Promoted props are only checked a few times per second
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickInterval = 0.25f;
+
+	// Movable and overlapping the Telekinesis channel, so the instances are grabbable
+	Instances = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("Instances"));
+	SetRootComponent(Instances);
+	Instances->SetMobility(EComponentMobility::Movable);
+	Instances->SetCollisionProfileName(CollisionProfiles::Grabbable);
+}
+
+// Keep the instances' mesh in sync with PropMesh
+void AInstancedPropContainer::OnConstruction(const FTransform& Transform) {
+	Super::OnConstruction(Transform);
+	Instances->SetStaticMesh(PropMesh);
+}
+
+// Called when the game starts or when spawned
+void AInstancedPropContainer::BeginPlay() {
+	Super::BeginPlay();
+
+	if (GetNetMode() != NM_Standalone) {
+		if (HasAuthority()) {
+			ExpandToActors();
+		}
+		Instances->ClearInstances();
+		return;
+	}
+
+	InitialTransforms.SetNum(Instances->GetInstanceCount());
+	for (int32 i = 0; i < InitialTransforms.Num(); i++) {
+		Instances->GetInstanceTransform(i, InitialTransforms[i], true);
+	}
+	FreeActors.Reserve(PoolSize);
+	for (int32 i = 0; i < PoolSize; i++) {
+		ReturnToPool(SpawnPropActor());
+	}
+}
+
+// Destroy the pooled and promoted actors along with the container
+void AInstancedPropContainer::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	Super::EndPlay(EndPlayReason);
+	for (const FPromotedProp& Prop : Promoted) {
+		if (AStaticMeshActor* Actor = Prop.Actor.Get()) {
+			Actor->Destroy();
+		}
+	}
+	for (AStaticMeshActor* Actor : FreeActors) {
+		if (Actor) {
+			Actor->Destroy();
+		}
+	}
+	Promoted.Reset();
+	FreeActors.Reset();
+}
+
+/**
+* Put the promoted props that stayed still for SettleTime back into their instance.
+* Held props and thrown props still tracked never settle.
+*/
+void AInstancedPropContainer::Tick(float DeltaTime) {
+	EF_SCOPE_CYCLE_COUNTER(STAT_InstancedPropsTick);
+	Super::Tick(DeltaTime);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	for (int32 i = Promoted.Num() - 1; i >= 0; i--) {
+		FPromotedProp& Prop = Promoted[i];
+		AStaticMeshActor* Actor = Prop.Actor.Get();
+		// Destroyed by something else, its instance stays hidden
+		if (!Actor) {
+			Promoted.RemoveAtSwap(i);
+			continue;
+		}
+		if (!IsSettled(Actor->GetStaticMeshComponent())) {
+			Prop.StillSince = 0.0;
+		} else if (Prop.StillSince == 0.0) {
+			Prop.StillSince = Now;
+		} else if (Now - Prop.StillSince >= SettleTime) {
+			DemoteProp(i);
+		}
+	}
+}
+
+/**
+* Swap an instance for a pooled actor at its transform.
+* The instance is scaled down to nothing rather than removed, so the other instances keep their index
+* and the promoted prop can go back into the same one.
+* Returns the actor's mesh, or null if the instance is invalid, already promoted or this is a network game.
+*/
+UStaticMeshComponent* AInstancedPropContainer::PromoteInstance(int32 Item) {
+	EF_SCOPE_CYCLE_COUNTER(STAT_PromoteInstance);
+	if (GetNetMode() != NM_Standalone || !Instances->IsValidInstance(Item)) return nullptr;
+	FTransform Transform;
+	Instances->GetInstanceTransform(Item, Transform, true);
+	if (Transform.GetScale3D().IsNearlyZero()) return nullptr;
+
+	// Zero scale instances have no body
+	FTransform Hidden = Transform;
+	Hidden.SetScale3D(FVector::ZeroVector);
+	Instances->UpdateInstanceTransform(Item, Hidden, true, true, true);
+
+	AStaticMeshActor* Actor = TakeFromPool();
+	UStaticMeshComponent* Mesh = Actor->GetStaticMeshComponent();
+	Mesh->SetWorldTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+	Mesh->SetCollisionProfileName(CollisionProfiles::Grabbable);
+	Actor->SetActorHiddenInGame(false);
+	Promoted.Add({ Actor, Item, 0.0 });
+	Promotions++;
+	return Mesh;
+}
+
+// Add a prop at a world transform, returns its instance index
+int32 AInstancedPropContainer::AddProp(const FTransform& Transform) {
+	if (HasActorBegunPlay()) {
+		InitialTransforms.Add(Transform);
+	}
+	return Instances->AddInstance(Transform, true);
+}
+
+void AInstancedPropContainer::SetPropMesh(UStaticMesh* Mesh) {
+	PropMesh = Mesh;
+	Instances->SetStaticMesh(Mesh);
+	for (AStaticMeshActor* Actor : FreeActors) {
+		Actor->GetStaticMeshComponent()->SetStaticMesh(Mesh);
+	}
+}
+
+// Put every promoted prop back into the pool and every instance where it started
+void AInstancedPropContainer::ResetProps() {
+	if (GetNetMode() != NM_Standalone) return;
+	for (const FPromotedProp& Prop : Promoted) {
+		if (AStaticMeshActor* Actor = Prop.Actor.Get()) {
+			ReturnToPool(Actor);
+		}
+	}
+	Promoted.Reset();
+	for (int32 i = 0; i < InitialTransforms.Num(); i++) {
+		Instances->UpdateInstanceTransform(i, InitialTransforms[i], true, i == InitialTransforms.Num() - 1, true);
+	}
+}
+
+// Whether a hit is on one of the containers' instances
+bool AInstancedPropContainer::IsInstanceHit(const FHitResult& HitResult) {
+	const AInstancedPropContainer* Container = Cast<AInstancedPropContainer>(HitResult.GetActor());
+	return Container && HitResult.GetComponent() == Container->Instances && Container->Instances->IsValidInstance(HitResult.Item);
+}
+
+// World location of the grabbable object that was hit, the instance's for instance hits
+FVector AInstancedPropContainer::GetHitObjectLocation(const FHitResult& HitResult) {
+	if (IsInstanceHit(HitResult)) {
+		FTransform Transform;
+		CastChecked<UInstancedStaticMeshComponent>(HitResult.GetComponent())->GetInstanceTransform(HitResult.Item, Transform, true);
+		return Transform.GetLocation();
+	}
+	return HitResult.GetComponent()->GetComponentLocation();
+}
+
+// Spawn an actor with the props' mesh and materials, not in the pool yet
+AStaticMeshActor* AInstancedPropContainer::SpawnPropActor() {
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AStaticMeshActor* Actor = GetWorld()->SpawnActor<AStaticMeshActor>(GetActorLocation(), FRotator::ZeroRotator, SpawnParams);
+	UStaticMeshComponent* Mesh = Actor->GetStaticMeshComponent();
+	Mesh->SetMobility(EComponentMobility::Movable);
+	Mesh->SetStaticMesh(Instances->GetStaticMesh());
+	for (int32 i = 0; i < Instances->GetNumMaterials(); i++) {
+		Mesh->SetMaterial(i, Instances->GetMaterial(i));
+	}
+	return Actor;
+}
+
+// Take a free actor, the pool grows if it's empty
+AStaticMeshActor* AInstancedPropContainer::TakeFromPool() {
+	if (FreeActors.Num() == 0) {
+		ReturnToPool(SpawnPropActor());
+		PoolGrowths++;
+	}
+	return FreeActors.Pop(false);
+}
+
+// Hide the actor and take it out of collision, so it isn't grabbable or captured by the level reset
+void AInstancedPropContainer::ReturnToPool(AStaticMeshActor* Actor) {
+	UStaticMeshComponent* Mesh = Actor->GetStaticMeshComponent();
+	// Reset mid-flight, the thrown object tracking would restore its collision later
+	if (UThrownObjectSubsystem* ThrownObjects = GetWorld()->GetSubsystem<UThrownObjectSubsystem>()) {
+		ThrownObjects->StopTracking(Mesh);
+	}
+	Mesh->SetSimulatePhysics(false);
+	Mesh->SetEnableGravity(true);
+	Mesh->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetOwner(nullptr);
+	Actor->Tags.Remove("Grabbed");
+	FreeActors.Add(Actor);
+}
+
+// Put a promoted prop back into its instance, where it settled
+void AInstancedPropContainer::DemoteProp(int32 PromotedIndex) {
+	const FPromotedProp& Prop = Promoted[PromotedIndex];
+	AStaticMeshActor* Actor = Prop.Actor.Get();
+	Instances->UpdateInstanceTransform(Prop.Item, Actor->GetStaticMeshComponent()->GetComponentTransform(), true, true, true);
+	ReturnToPool(Actor);
+	Promoted.RemoveAtSwap(PromotedIndex);
+	Demotions++;
+}
+
+// Not held, not flying and not moving
+bool AInstancedPropContainer::IsSettled(const UStaticMeshComponent* Mesh) const {
+	if (Mesh->GetOwner()->ActorHasTag("Grabbed")) return false;
+	const UThrownObjectSubsystem* ThrownObjects = GetWorld()->GetSubsystem<UThrownObjectSubsystem>();
+	if (ThrownObjects && ThrownObjects->IsTracked(Mesh)) return false;
+	return !Mesh->IsSimulatingPhysics() || !Mesh->IsAnyRigidBodyAwake();
+}
+
+// Replace every instance with a replicated actor at its transform, clients get rid of their instances
+void AInstancedPropContainer::ExpandToActors() {
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	for (int32 i = 0; i < Instances->GetInstanceCount(); i++) {
+		FTransform Transform;
+		Instances->GetInstanceTransform(i, Transform, true);
+		if (AInstancedPropActor* Actor = GetWorld()->SpawnActor<AInstancedPropActor>(AInstancedPropActor::StaticClass(), Transform, SpawnParams)) {
+			Actor->SetContainer(this);
+		}
+	}
+}
+
+// Log the stats
+void AInstancedPropContainer::DumpStats() const {
+	UE_LOG(LogTemp, Display, TEXT("%s: %d instances, %d promoted, %d pooled. %d promotions, %d demotions, pool grew %d times"),
+		*GetName(), Instances->GetInstanceCount(), Promoted.Num(), FreeActors.Num(), Promotions, Demotions, PoolGrowths);
+}
+
+void AInstancedPropContainer::ResetStats() {
+	Promotions = 0;
+	Demotions = 0;
+	PoolGrowths = 0;
+}
+
+#if WITH_EDITOR
+// Turn the level's movable, grabbable static mesh actors using PropMesh into instances, and delete them
+void AInstancedPropContainer::GatherProps() {
+	if (!PropMesh) return;
+	Modify();
+	Instances->Modify();
+	Instances->SetStaticMesh(PropMesh);
+	int32 Gathered = 0;
+	for (TActorIterator<AStaticMeshActor> It(GetWorld()); It; ++It) {
+		UStaticMeshComponent* Mesh = It->GetStaticMeshComponent();
+		if (Mesh->GetStaticMesh() != PropMesh || !AESPCharacter::IsGrabbable(Mesh)) continue;
+		Instances->AddInstance(Mesh->GetComponentTransform(), true);
+		It->Destroy();
+		Gathered++;
+	}
+	UE_LOG(LogTemp, Display, TEXT("%s: gathered %d props, %d instances"), *GetName(), Gathered, Instances->GetInstanceCount());
+}
+#endif
+
+// Console command to read the stats of every container
+static FAutoConsoleCommandWithWorld InstancedPropStatsCommand(
+	TEXT("ef.Props.Stats"),
+	TEXT("Logs the instance, promotion and pool counts of every instanced prop container."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World) {
+		for (TActorIterator<AInstancedPropContainer> It(World); It; ++It) {
+			It->DumpStats();
+		}
+	})
+);
+
+// State of an instancing benchmark, shared between its two runs
+struct FInstanceBench {
+	TWeakObjectPtr<UWorld> World;
+	int32 NumProps;
+	float Seconds;
+	bool bInstanced = false;
+	TArray<TWeakObjectPtr<AActor>> Actors;
+	// Sampled every frame
+	FTSTicker::FDelegateHandle TickerHandle;
+	double GameThreadMs = 0.0;
+	double FrameMs = 0.0;
+	int32 Frames = 0;
+};
+
+// Current size of the physics LLM tag, 0 when LLM is off
+static int64 GetPhysicsMemory() {
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	FLowLevelMemTracker& Tracker = FLowLevelMemTracker::Get();
+	if (Tracker.IsEnabled()) {
+		return Tracker.GetTagAmountForTracker(ELLMTracker::Default, TEXT("Physics"), ELLMTagSet::None, UE::LLM::ESizeParams::ReportCurrent);
+	}
+#endif
+	return 0;
+}
+
+/**
+* Lay the props out in a grid in front of the player, either as separate actors or as a container's instances,
+* and report the memory they took, the cost of a grab sweep over them and the game thread time once Seconds are over.
+*/
+static void RunInstanceBench(TSharedRef<FInstanceBench> Test) {
+	UWorld* World = Test->World.Get();
+	UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	APawn* PlayerPawn = World ? UGameplayStatics::GetPlayerPawn(World, 0) : nullptr;
+	if (!Cube || !PlayerPawn) {
+		UE_LOG(LogTemp, Error, TEXT("Instance benchmark: needs a player pawn"));
+		return;
+	}
+
+	const int64 PhysicsMemoryBefore = GetPhysicsMemory();
+	const uint64 UsedMemoryBefore = FPlatformMemory::GetStats().UsedPhysical;
+	const double SpawnStartTime = FPlatformTime::Seconds();
+
+	// 60 units apart, starting a bit in front of the player
+	const int32 Side = FMath::CeilToInt(FMath::Sqrt((float)Test->NumProps));
+	const FVector Origin = PlayerPawn->GetActorLocation() + PlayerPawn->GetActorForwardVector() * 300.f;
+	AInstancedPropContainer* Container = nullptr;
+	if (Test->bInstanced) {
+		Container = World->SpawnActor<AInstancedPropContainer>(Origin, FRotator::ZeroRotator);
+		Container->SetPropMesh(Cube);
+		Test->Actors.Add(Container);
+	}
+	for (int32 i = 0; i < Test->NumProps; i++) {
+		const FTransform Transform(FRotator::ZeroRotator, Origin + FVector((i / Side) * 60.f, (i % Side - Side / 2) * 60.f, 0.f), FVector(0.4f));
+		if (Container) {
+			Container->AddProp(Transform);
+			continue;
+		}
+		AStaticMeshActor* Actor = World->SpawnActor<AStaticMeshActor>(Transform.GetLocation(), FRotator::ZeroRotator);
+		UStaticMeshComponent* Mesh = Actor->GetStaticMeshComponent();
+		Mesh->SetMobility(EComponentMobility::Movable);
+		Mesh->SetStaticMesh(Cube);
+		Actor->SetActorScale3D(Transform.GetScale3D());
+		Mesh->SetCollisionProfileName(CollisionProfiles::Grabbable);
+		Test->Actors.Add(Actor);
+	}
+	const double SpawnMs = (FPlatformTime::Seconds() - SpawnStartTime) * 1000.0;
+	const double PhysicsMemory = (GetPhysicsMemory() - PhysicsMemoryBefore) / (1024.0 * 1024.0);
+	const double UsedMemory = ((int64)FPlatformMemory::GetStats().UsedPhysical - (int64)UsedMemoryBefore) / (1024.0 * 1024.0);
+
+	// The telekinesis sweep, over the first rows
+	TArray<FHitResult> HitResults;
+	FCollisionQueryParams Params;
+	Params.bFindInitialOverlaps = true;
+	const double SweepStartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < 100; i++) {
+		HitResults.Reset();
+		World->SweepMultiByChannel(HitResults, Origin, Origin + PlayerPawn->GetActorForwardVector() * 1500.f, FQuat::Identity,
+			ECC_GameTraceChannel1, FCollisionShape::MakeSphere(300.f), Params);
+	}
+	const double SweepMs = (FPlatformTime::Seconds() - SweepStartTime) * 1000.0 / 100.0;
+
+	// Promote the swept instances and put them back, like grabbing and settling them
+	double PromoteMs = 0.0;
+	if (Container) {
+		const double PromoteStartTime = FPlatformTime::Seconds();
+		for (const FHitResult& HitResult : HitResults) {
+			if (AInstancedPropContainer::IsInstanceHit(HitResult)) {
+				Container->PromoteInstance(HitResult.Item);
+			}
+		}
+		PromoteMs = (FPlatformTime::Seconds() - PromoteStartTime) * 1000.0 / FMath::Max(Container->GetNumPromoted(), 1);
+		Container->ResetProps();
+	}
+	UE_LOG(LogTemp, Display, TEXT("  %s: spawned in %.1f ms, %.2f MB physics, %.2f MB used. Grab sweep %.3f ms for %d hits, %.3f ms per promotion"),
+		Test->bInstanced ? TEXT("Instances") : TEXT("Actors   "), SpawnMs, PhysicsMemory, UsedMemory, SweepMs, HitResults.Num(), PromoteMs);
+
+	Test->GameThreadMs = 0.0;
+	Test->FrameMs = 0.0;
+	Test->Frames = 0;
+	Test->TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Test](float DeltaTime) {
+		Test->GameThreadMs += FPlatformTime::ToMilliseconds(GGameThreadTime);
+		Test->FrameMs += DeltaTime * 1000.0;
+		Test->Frames++;
+		return true;
+	}));
+
+	FTimerHandle Unused;
+	World->GetTimerManager().SetTimer(Unused, [Test]() {
+		FTSTicker::GetCoreTicker().RemoveTicker(Test->TickerHandle);
+		const int32 Frames = FMath::Max(Test->Frames, 1);
+		UE_LOG(LogTemp, Display, TEXT("  %s: %.2f ms game thread, %.2f ms frame on average"),
+			Test->bInstanced ? TEXT("Instances") : TEXT("Actors   "), Test->GameThreadMs / Frames, Test->FrameMs / Frames);
+		for (const TWeakObjectPtr<AActor>& Actor : Test->Actors) {
+			if (Actor.IsValid()) {
+				Actor->Destroy();
+			}
+		}
+		Test->Actors.Reset();
+		UWorld* CurrentWorld = Test->World.Get();
+		if (!Test->bInstanced && CurrentWorld) {
+			// Collect the destroyed actors at the end of this frame, and only start the instance run on the next one,
+			// so it doesn't pay for their cleanup or count their memory
+			GEngine->ForceGarbageCollection(true);
+			Test->bInstanced = true;
+			CurrentWorld->GetTimerManager().SetTimerForNextTick([Test]() {
+				RunInstanceBench(Test);
+			});
+		}
+	}, Test->Seconds, false);
+}
+
+// Separate actors against instances
+static void InstanceBench(const TArray<FString>& Args, UWorld* World) {
+	TSharedRef<FInstanceBench> Test = MakeShared<FInstanceBench>();
+	Test->World = World;
+	Test->NumProps = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 5000;
+	Test->Seconds = Args.Num() > 1 ? FMath::Max(FCString::Atof(*Args[1]), 1.f) : 5.f;
+	UE_LOG(LogTemp, Display, TEXT("Instance benchmark: %d props, %.0f s per run. Run with -llm for the physics memory"), Test->NumProps, Test->Seconds);
+	RunInstanceBench(Test);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs InstanceBenchCommand(
+	TEXT("ef.Props.InstanceBench"),
+	TEXT("Lays props out as separate actors then as instances, and reports memory, grab sweep cost and game thread time. Usage: ef.Props.InstanceBench [Count=5000] [Seconds=5]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&InstanceBench)
+);
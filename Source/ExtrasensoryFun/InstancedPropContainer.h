@@ -0,0 +1,109 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "InstancedPropContainer.generated.h"
+
+class UHierarchicalInstancedStaticMeshComponent;
+class UStaticMesh;
+class AStaticMeshActor;
+
+/**
+ * Renders and collides many grabbable props of the same mesh as instances while they're at rest.
+ * The instances use the Grabbable collision profile, so the telekinesis sweep finds them like any other prop,
+ * with the instance index in the hit's Item. Grabbing an instance promotes it to a pooled static mesh actor
+ * at the same transform, and the actor goes back into its instance once it has settled.
+ * A promoted instance keeps its index, scaled down to nothing so it has no body and doesn't render.
+ * Network games expand the instances into replicated actors instead, since the instances' state doesn't replicate.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API AInstancedPropContainer : public AActor {
+	GENERATED_BODY()
+
+public:
+	// Default constructor
+	AInstancedPropContainer();
+
+protected:
+	virtual void OnConstruction(const FTransform& Transform) override;
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+	// Destroy the pooled and promoted actors along with the container
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	// Called every TickInterval
+	virtual void Tick(float DeltaTime) override;
+
+	// Swap an instance for a pooled actor at its transform, returns the actor's mesh or null if it can't be promoted
+	UStaticMeshComponent* PromoteInstance(int32 Item);
+	// Add a prop at a world transform
+	int32 AddProp(const FTransform& Transform);
+	void SetPropMesh(UStaticMesh* Mesh);
+
+	// Put every promoted prop back and every instance where it started
+	void ResetProps();
+
+	// Whether a hit is on one of the containers' instances
+	static bool IsInstanceHit(const FHitResult& HitResult);
+	// World location of the grabbable object that was hit, the instance's for instance hits
+	static FVector GetHitObjectLocation(const FHitResult& HitResult);
+
+	// Getter methods
+	UHierarchicalInstancedStaticMeshComponent* GetInstances() const { return Instances; }
+	int32 GetNumPromoted() const { return Promoted.Num(); }
+
+	// Log and reset the stats
+	void DumpStats() const;
+	void ResetStats();
+
+#if WITH_EDITOR
+	// Turn the level's movable static mesh actors using PropMesh into instances of this container
+	UFUNCTION(CallInEditor, Category = "Props")
+	void GatherProps();
+#endif
+
+private:
+	UPROPERTY(VisibleAnywhere)
+	UHierarchicalInstancedStaticMeshComponent* Instances;
+
+	// -----Props-----
+	UPROPERTY(EditAnywhere, Category = "Props")
+	UStaticMesh* PropMesh;
+	// How long a released prop has to stay still before going back into its instance
+	UPROPERTY(EditAnywhere, Category = "Props")
+	float SettleTime = 1.f;
+
+	// -----Pool properties-----
+	UPROPERTY(EditAnywhere, Category = "Pool")
+	int32 PoolSize = 16;
+
+	// A prop out of its instance
+	struct FPromotedProp {
+		TWeakObjectPtr<AStaticMeshActor> Actor;
+		int32 Item;
+		// Time since which it has been still, 0 while moving
+		double StillSince;
+	};
+	TArray<FPromotedProp> Promoted;
+	UPROPERTY()
+	TArray<AStaticMeshActor*> FreeActors;
+	// Instance transforms when play started
+	TArray<FTransform> InitialTransforms;
+
+	AStaticMeshActor* SpawnPropActor();
+	AStaticMeshActor* TakeFromPool();
+	void ReturnToPool(AStaticMeshActor* Actor);
+	// Put a promoted prop back into its instance
+	void DemoteProp(int32 PromotedIndex);
+	bool IsSettled(const UStaticMeshComponent* Mesh) const;
+	// Replace every instance with its own replicated actor
+	void ExpandToActors();
+
+	// -----Stats-----
+	int32 Promotions = 0;
+	int32 Demotions = 0;
+	int32 PoolGrowths = 0;
+};
@@ -0,0 +1,192 @@
+// by Jason Hilani
+
+
+#include "LevelResetSubsystem.h"
+#include "ESPCharacter.h"
+#include "ShooterCharacter.h"
+#include "ShooterHorde.h"
+#include "ShooterProjectile.h"
+#include "ShooterSpawnDirector.h"
+#include "InstancedPropContainer.h"
+#include "HealthComponent.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "EngineUtils.h"
+
+// Record the state of every resettable actor
+void ULevelResetSubsystem::CaptureSnapshot() {
+	Props.Reset();
+	Characters.Reset();
+
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It) {
+		CaptureActor(*It);
+	}
+	bHasSnapshot = true;
+	UE_LOG(LogTemp, Display, TEXT("Level reset snapshot: %d characters, %d props"), Characters.Num(), Props.Num());
+}
+
+// Record an actor if it's resettable, returns whether it was
+bool ULevelResetSubsystem::CaptureActor(AActor* Actor) {
+	if (ABaseCharacter* Character = Cast<ABaseCharacter>(Actor)) {
+		// Pooled and horde characters get reset by their owners
+		AShooterCharacter* ShooterCharacter = Cast<AShooterCharacter>(Character);
+		if (ShooterCharacter && (ShooterCharacter->GetSpawnDirector() || Cast<AShooterHorde>(ShooterCharacter->GetOwner()))) return false;
+		Characters.Add({ Character, Character->GetActorTransform() });
+		return true;
+	}
+	UPrimitiveComponent* Component = Actor ? Cast<UPrimitiveComponent>(Actor->GetRootComponent()) : nullptr;
+	if (!Component || !AESPCharacter::IsGrabbable(Component)) return false;
+	Props.Add({
+		Component,
+		Component->GetComponentTransform(),
+		Component->IsSimulatingPhysics(),
+		Component->IsGravityEnabled(),
+		Actor->GetAttachParentActor(),
+		Actor->GetAttachParentSocketName()
+	});
+	return true;
+}
+
+// Add the resettable actors of a streamed in level to the snapshot
+int32 ULevelResetSubsystem::CaptureLevel(const ULevel* Level) {
+	int32 Captured = 0;
+	for (AActor* Actor : Level->Actors) {
+		Captured += Actor && CaptureActor(Actor) ? 1 : 0;
+	}
+	return Captured;
+}
+
+/**
+* Drop the actors of a streamed out level from the snapshot.
+* Its level is loaded again from disk when it streams back in, so its actors start over in their initial state anyway.
+*/
+int32 ULevelResetSubsystem::ForgetLevel(const ULevel* Level) {
+	const int32 NumBefore = Props.Num() + Characters.Num();
+	Props.RemoveAll([Level](const FPropState& State) {
+		return State.Component.IsValid() && State.Component->GetComponentLevel() == Level;
+	});
+	Characters.RemoveAll([Level](const FCharacterState& State) {
+		return State.Character.IsValid() && State.Character->GetLevel() == Level;
+	});
+	return NumBefore - Props.Num() - Characters.Num();
+}
+
+// Restore the recorded state
+void ULevelResetSubsystem::ResetLevel() {
+	if (!bHasSnapshot) return;
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Projectiles in flight don't survive the reset
+	for (TActorIterator<AShooterProjectile> It(GetWorld()); It; ++It) {
+		It->Destroy();
+	}
+	// Pooled and data-only enemies go back to their initial state
+	for (TActorIterator<AShooterSpawnDirector> It(GetWorld()); It; ++It) {
+		It->ReturnAllToPool();
+	}
+	for (TActorIterator<AShooterHorde> It(GetWorld()); It; ++It) {
+		It->ResetEntities();
+	}
+	// Characters first, so the player lets go of the props before they get moved back
+	for (const FCharacterState& State : Characters) {
+		ResetCharacter(State);
+	}
+	// Promoted props go back into their instances
+	for (TActorIterator<AInstancedPropContainer> It(GetWorld()); It; ++It) {
+		It->ResetProps();
+	}
+	for (const FPropState& State : Props) {
+		UPrimitiveComponent* Component = State.Component.Get();
+		if (!Component) continue;
+		AActor* Actor = Component->GetOwner();
+		Actor->Tags.Remove("Grabbed");
+		Actor->SetOwner(nullptr);
+		Component->SetSimulatePhysics(State.bSimulatePhysics);
+		Component->SetEnableGravity(State.bEnableGravity);
+		Component->SetWorldTransform(State.Transform, false, nullptr, ETeleportType::ResetPhysics);
+		if (State.bSimulatePhysics) {
+			Component->SetPhysicsLinearVelocity(FVector::ZeroVector);
+			Component->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+		}
+		if (AActor* AttachParent = State.AttachParent.Get()) {
+			Actor->AttachToActor(AttachParent, FAttachmentTransformRules::KeepWorldTransform, State.AttachSocket);
+		}
+	}
+	UE_LOG(LogTemp, Display, TEXT("Level reset in place in %.2f ms"), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+// Revive a character where it started, and give it back a controller
+void ULevelResetSubsystem::ResetCharacter(const FCharacterState& State) {
+	ABaseCharacter* Character = State.Character.Get();
+	if (!Character) return;
+
+	Character->GetCharacterMovement()->StopMovementImmediately();
+	Character->SetActorTransform(State.Transform, false, nullptr, ETeleportType::ResetPhysics);
+	Character->Revive();
+
+	// The player controller stays around after death, AI controllers get destroyed with HandleDeath
+	if (Character->IsPlayerControlled() || Character->GetController()) {
+		if (AAIController* AIController = Cast<AAIController>(Character->GetController())) {
+			if (UBlackboardComponent* Blackboard = AIController->GetBlackboardComponent()) {
+				Blackboard->SetValueAsVector(TEXT("StartLocation"), State.Transform.GetLocation());
+				Blackboard->SetValueAsRotator(TEXT("StartRotation"), State.Transform.Rotator());
+			}
+			if (UBrainComponent* Brain = AIController->GetBrainComponent()) {
+				Brain->RestartLogic();
+			}
+		}
+	} else if (Cast<AShooterCharacter>(Character)) {
+		Character->SpawnDefaultController();
+	}
+}
+
+// Compare the current state to the snapshot, returns the number of mismatches and logs them
+int32 ULevelResetSubsystem::VerifySnapshot() const {
+	int32 Mismatches = 0;
+	for (const FCharacterState& State : Characters) {
+		const ABaseCharacter* Character = State.Character.Get();
+		if (!Character) {
+			UE_LOG(LogTemp, Warning, TEXT("Reset mismatch: a character was destroyed"));
+			Mismatches++;
+		} else if (!Character->GetActorLocation().Equals(State.Transform.GetLocation(), 1.f) || Character->GetHealthComponent()->GetHealthPercent() < 1.f) {
+			UE_LOG(LogTemp, Warning, TEXT("Reset mismatch: %s isn't back at full health at its start location"), *Character->GetName());
+			Mismatches++;
+		}
+	}
+	for (const FPropState& State : Props) {
+		const UPrimitiveComponent* Component = State.Component.Get();
+		if (!Component) {
+			UE_LOG(LogTemp, Warning, TEXT("Reset mismatch: a prop was destroyed"));
+			Mismatches++;
+		} else if (!Component->GetComponentTransform().Equals(State.Transform, 1.f) || Component->IsSimulatingPhysics() != State.bSimulatePhysics
+			|| Component->GetOwner()->GetAttachParentActor() != State.AttachParent.Get()) {
+			UE_LOG(LogTemp, Warning, TEXT("Reset mismatch: %s isn't back in its initial state"), *Component->GetOwner()->GetName());
+			Mismatches++;
+		}
+	}
+	UE_LOG(LogTemp, Display, TEXT("Level reset verification: %d characters, %d props, %d mismatches"), Characters.Num(), Props.Num(), Mismatches);
+	return Mismatches;
+}
+
+// Console commands to reset the level and check the result against the snapshot
+static FAutoConsoleCommandWithWorld ResetLevelCommand(
+	TEXT("ef.ResetLevel"),
+	TEXT("Resets the level in place to its state when it started."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World) {
+		if (ULevelResetSubsystem* LevelReset = World->GetSubsystem<ULevelResetSubsystem>()) {
+			LevelReset->ResetLevel();
+		}
+	})
+);
+
+static FAutoConsoleCommandWithWorld VerifyResetCommand(
+	TEXT("ef.VerifyReset"),
+	TEXT("Compares the resettable actors to their state when the level started and logs the differences."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World) {
+		if (ULevelResetSubsystem* LevelReset = World->GetSubsystem<ULevelResetSubsystem>()) {
+			LevelReset->VerifySnapshot();
+		}
+	})
+);
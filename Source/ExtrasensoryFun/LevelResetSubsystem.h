@@ -0,0 +1,58 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LevelResetSubsystem.generated.h"
+
+class ABaseCharacter;
+
+/**
+ * Resets the level in place instead of reloading it.
+ * A snapshot of the resettable actors (player spawn, enemies and grabbable props) is taken once the level has started,
+ * and restoring it revives characters, returns pooled enemies and teleports props back where they were.
+ * Actors destroyed during play can't be brought back, and are reported by VerifySnapshot.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API ULevelResetSubsystem : public UWorldSubsystem {
+	GENERATED_BODY()
+
+public:
+	// Record the state of every resettable actor
+	void CaptureSnapshot();
+	// Restore the recorded state
+	void ResetLevel();
+	// Compare the current state to the snapshot, returns the number of mismatches and logs them
+	int32 VerifySnapshot() const;
+	// Add the resettable actors of a streamed in level to the snapshot, returns how many were added
+	int32 CaptureLevel(const ULevel* Level);
+	// Drop the actors of a streamed out level from the snapshot, returns how many were dropped
+	int32 ForgetLevel(const ULevel* Level);
+
+	bool HasSnapshot() const { return bHasSnapshot; }
+
+private:
+	// Saved state of a grabbable prop
+	struct FPropState {
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		FTransform Transform;
+		bool bSimulatePhysics;
+		bool bEnableGravity;
+		TWeakObjectPtr<AActor> AttachParent;
+		FName AttachSocket;
+	};
+	// Saved state of a character
+	struct FCharacterState {
+		TWeakObjectPtr<ABaseCharacter> Character;
+		FTransform Transform;
+	};
+
+	TArray<FPropState> Props;
+	TArray<FCharacterState> Characters;
+	bool bHasSnapshot = false;
+
+	// Record an actor if it's resettable, returns whether it was
+	bool CaptureActor(AActor* Actor);
+	void ResetCharacter(const FCharacterState& State);
+};
@@ -0,0 +1,147 @@
+// by Jason Hilani
+
+
+#include "LevelResetSubsystem.h"
+#include "ESPCharacter.h"
+#include "ShooterCharacter.h"
+#include "ShooterSpawnDirector.h"
+#include "ShooterHorde.h"
+#include "HealthComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/AutomationCommon.h"
+#include "EngineUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace {
+	const TCHAR* ResetTestMap = TEXT("/Game/Main");
+
+	// State of a resettable actor, keyed by actor name since placed actors keep their names across loads
+	struct FActorState {
+		FTransform Transform;
+		float HealthPercent = 1.f;
+		bool bSimulatePhysics = false;
+	};
+
+	// Resettable actors and pooled enemies of a world, at the time the level reset snapshot is taken
+	struct FWorldState {
+		TMap<FString, FActorState> Actors;
+		int32 ActiveEnemies = 0;
+	};
+
+	struct FResetTestData {
+		FWorldState Reset;
+		FWorldState Fresh;
+	};
+
+	FWorldState CaptureWorldState(UWorld* World) {
+		FWorldState State;
+		for (TActorIterator<AActor> It(World); It; ++It) {
+			if (const ABaseCharacter* Character = Cast<ABaseCharacter>(*It)) {
+				// Pooled characters are compared through the active count, horde characters come and go with the player's distance
+				const AShooterCharacter* ShooterCharacter = Cast<AShooterCharacter>(Character);
+				if (ShooterCharacter && (ShooterCharacter->GetSpawnDirector() || Cast<AShooterHorde>(ShooterCharacter->GetOwner()))) continue;
+				State.Actors.Add(Character->GetName(), { Character->GetActorTransform(), Character->GetHealthComponent()->GetHealthPercent(), false });
+			} else if (const UPrimitiveComponent* Component = Cast<UPrimitiveComponent>(It->GetRootComponent())) {
+				if (AESPCharacter::IsGrabbable(Component)) {
+					State.Actors.Add(It->GetName(), { Component->GetComponentTransform(), 1.f, Component->IsSimulatingPhysics() });
+				}
+			}
+		}
+		for (TActorIterator<AShooterSpawnDirector> It(World); It; ++It) {
+			State.ActiveEnemies += It->GetActiveCount();
+		}
+		return State;
+	}
+
+	ULevelResetSubsystem* GetLevelReset() {
+		UWorld* World = AutomationCommon::GetAnyGameWorld();
+		return World ? World->GetSubsystem<ULevelResetSubsystem>() : nullptr;
+	}
+}
+
+// Wait for the game mode to take the level reset snapshot
+DEFINE_LATENT_AUTOMATION_COMMAND(FWaitForResetSnapshot);
+bool FWaitForResetSnapshot::Update() {
+	const ULevelResetSubsystem* LevelReset = GetLevelReset();
+	return LevelReset && LevelReset->HasSnapshot();
+}
+
+// Play the level for a bit: hurt every character, throw the props around and spawn a wave
+DEFINE_LATENT_AUTOMATION_COMMAND(FPlayLevel);
+bool FPlayLevel::Update() {
+	UWorld* World = AutomationCommon::GetAnyGameWorld();
+	for (TActorIterator<ABaseCharacter> It(World); It; ++It) {
+		UGameplayStatics::ApplyDamage(*It, It->GetHealthComponent()->GetMaxHealth() * 0.5f, nullptr, nullptr, nullptr);
+		It->SetActorLocation(It->GetActorLocation() + FVector(300.f, 0.f, 0.f), false, nullptr, ETeleportType::TeleportPhysics);
+	}
+	for (TActorIterator<AActor> It(World); It; ++It) {
+		UPrimitiveComponent* Component = Cast<UPrimitiveComponent>(It->GetRootComponent());
+		if (Component && AESPCharacter::IsGrabbable(Component)) {
+			Component->SetSimulatePhysics(true);
+			Component->AddImpulse(FVector(0.f, 0.f, 1000.f), NAME_None, true);
+		}
+	}
+	for (TActorIterator<AShooterSpawnDirector> It(World); It; ++It) {
+		It->StartWave(10);
+	}
+	return true;
+}
+
+// Reset the level in place and record the result
+DEFINE_LATENT_AUTOMATION_COMMAND_ONE_PARAMETER(FResetAndCapture, TSharedRef<FResetTestData>, Data);
+bool FResetAndCapture::Update() {
+	ULevelResetSubsystem* LevelReset = GetLevelReset();
+	LevelReset->ResetLevel();
+	Data->Reset = CaptureWorldState(LevelReset->GetWorld());
+	return true;
+}
+
+// Record the freshly loaded level once its snapshot has been taken
+DEFINE_LATENT_AUTOMATION_COMMAND_ONE_PARAMETER(FCaptureFreshLoad, TSharedRef<FResetTestData>, Data);
+bool FCaptureFreshLoad::Update() {
+	Data->Fresh = CaptureWorldState(AutomationCommon::GetAnyGameWorld());
+	return true;
+}
+
+// Compare the reset level against the fresh load
+DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FCompareResetToFreshLoad, FAutomationTestBase*, Test, TSharedRef<FResetTestData>, Data);
+bool FCompareResetToFreshLoad::Update() {
+	Test->TestTrue(TEXT("The fresh load has resettable actors"), Data->Fresh.Actors.Num() > 0);
+	Test->TestEqual(TEXT("Active pooled enemies"), Data->Reset.ActiveEnemies, Data->Fresh.ActiveEnemies);
+	for (const TPair<FString, FActorState>& Fresh : Data->Fresh.Actors) {
+		const FActorState* Reset = Data->Reset.Actors.Find(Fresh.Key);
+		if (!Test->TestNotNull(*FString::Printf(TEXT("%s exists after the reset"), *Fresh.Key), Reset)) continue;
+		Test->TestTrue(*FString::Printf(TEXT("%s is back at its fresh load transform"), *Fresh.Key), Reset->Transform.Equals(Fresh.Value.Transform, 1.f));
+		Test->TestEqual(*FString::Printf(TEXT("%s health"), *Fresh.Key), Reset->HealthPercent, Fresh.Value.HealthPercent);
+		Test->TestEqual(*FString::Printf(TEXT("%s simulates physics"), *Fresh.Key), Reset->bSimulatePhysics, Fresh.Value.bSimulatePhysics);
+	}
+	Test->TestEqual(TEXT("Resettable actors"), Data->Reset.Actors.Num(), Data->Fresh.Actors.Num());
+	return true;
+}
+
+/**
+ * Loads Main, plays it, resets it in place, then loads it again from scratch and checks the reset level matches the fresh load:
+ * characters back at full health where they started, props back in place with their physics state, no pooled enemy active.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLevelResetMatchesFreshLoadTest, "ExtrasensoryFun.LevelReset.MatchesFreshLoad",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FLevelResetMatchesFreshLoadTest::RunTest(const FString& Parameters) {
+	TSharedRef<FResetTestData> Data = MakeShared<FResetTestData>();
+
+	AutomationOpenMap(ResetTestMap);
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForResetSnapshot());
+	ADD_LATENT_AUTOMATION_COMMAND(FPlayLevel());
+	ADD_LATENT_AUTOMATION_COMMAND(FEngineWaitLatentCommand(2.f));
+	ADD_LATENT_AUTOMATION_COMMAND(FResetAndCapture(Data));
+
+	AutomationOpenMap(ResetTestMap, true);
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForResetSnapshot());
+	ADD_LATENT_AUTOMATION_COMMAND(FCaptureFreshLoad(Data));
+	ADD_LATENT_AUTOMATION_COMMAND(FCompareResetToFreshLoad(this, Data));
+	return true;
+}
+
+#endif
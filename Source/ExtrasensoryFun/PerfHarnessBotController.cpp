@@ -0,0 +1,69 @@
+// by Jason Hilani
+
+
+#include "PerfHarnessBotController.h"
+#include "ESPCharacter.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+// Default constructor
+APerfHarnessBotController::APerfHarnessBotController() {
+	PrimaryActorTick.bCanEverTick = true;
+	// Nothing to aim with without a viewport, the pawn's camera is enough
+	bAutoManageActiveCameraTarget = false;
+}
+
+/**
+* Walk in circles and go through the telekinesis cycle:
+* grab for GrabTime, freeze to aim, throw everything at ThrowInterval, then cancel whatever's left at the end of the cycle.
+*/
+void APerfHarnessBotController::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	AESPCharacter* Bot = Cast<AESPCharacter>(GetPawn());
+	if (!Bot) return;
+
+	SetControlRotation(GetControlRotation() + FRotator(0.f, TurnRate * DeltaTime, 0.f));
+	if (!Bot->GetIsFrozen()) {
+		const FVector Direction = GetControlRotation().Vector().GetSafeNormal2D();
+		if (Bot->IsLocallyControlled()) {
+			Bot->AddMovementInput(Direction);
+		} else {
+			// Move the capsule at walking speed, sliding along whatever it runs into
+			UCharacterMovementComponent* Movement = Bot->GetCharacterMovement();
+			const FVector Delta = Direction * Movement->GetMaxSpeed() * DeltaTime;
+			FHitResult Hit;
+			Movement->SafeMoveUpdatedComponent(Delta, FRotator(0.f, GetControlRotation().Yaw, 0.f).Quaternion(), true, Hit);
+			if (Hit.IsValidBlockingHit()) {
+				Movement->SlideAlongSurface(Delta, 1.f - Hit.Time, Hit.Normal, Hit, true);
+			}
+		}
+	}
+
+	CycleTimer += DeltaTime;
+	if (CycleTimer < GrabTime) {
+		if (!bGrabbing) {
+			Bot->StartGrabbing();
+			bGrabbing = true;
+		}
+	} else if (CycleTimer < CycleTime) {
+		if (bGrabbing) {
+			Bot->StopGrabbing();
+			bGrabbing = false;
+		}
+		// The character starts aiming on its own once frozen for its aim time
+		if (!bAimStarted && Bot->GetHeldObjectCount() > 0) {
+			Bot->ThrowAim();
+			bAimStarted = true;
+		}
+		ThrowTimer -= DeltaTime;
+		if (bAimStarted && Bot->GetIsAiming() && ThrowTimer <= 0.f) {
+			Bot->Throw();
+			ThrowTimer = ThrowInterval;
+		}
+	} else {
+		Bot->CancelAim();
+		CycleTimer = 0.f;
+		ThrowTimer = 0.f;
+		bAimStarted = false;
+	}
+}
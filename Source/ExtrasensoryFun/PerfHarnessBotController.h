@@ -0,0 +1,45 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerController.h"
+#include "PerfHarnessBotController.generated.h"
+
+/**
+ * Scripted controller for the perf harness' ESP character.
+ * It's a player controller without a player, so the enemies' behaviour trees treat its pawn as the player.
+ * On a server it's never a local controller and the movement component ignores its input, so it walks the pawn itself there.
+ * The pawn walks in circles and repeats a fixed grab, aim and throw cycle, driven by the world time so runs at a fixed timestep are repeatable.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API APerfHarnessBotController : public APlayerController {
+	GENERATED_BODY()
+
+public:
+	// Default constructor
+	APerfHarnessBotController();
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+private:
+	// -----Bot properties-----
+	// Length of one grab, aim and throw cycle
+	UPROPERTY(EditAnywhere, Category = "Bot")
+	float CycleTime = 4.f;
+	// Time spent grabbing at the start of a cycle
+	UPROPERTY(EditAnywhere, Category = "Bot")
+	float GrabTime = 1.f;
+	// Time between throws once aiming
+	UPROPERTY(EditAnywhere, Category = "Bot")
+	float ThrowInterval = 0.25f;
+	// Yaw speed in degrees/s, makes the bot walk in circles
+	UPROPERTY(EditAnywhere, Category = "Bot")
+	float TurnRate = 30.f;
+
+	float CycleTimer = 0.f;
+	float ThrowTimer = 0.f;
+	bool bGrabbing = false;
+	bool bAimStarted = false;
+};
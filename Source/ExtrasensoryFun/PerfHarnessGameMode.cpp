@@ -0,0 +1,206 @@
+// by Jason Hilani
+
+
+#include "PerfHarnessGameMode.h"
+#include "PerfHarnessBotController.h"
+#include "ESPCharacter.h"
+#include "ShooterCharacter.h"
+#include "FireTokenSubsystem.h"
+#include "PropNavigationSubsystem.h"
+#include "CellStreamingSubsystem.h"
+#include "StreamingCell.h"
+#include "ExtrasensoryFunStats.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+// Default constructor
+APerfHarnessGameMode::APerfHarnessGameMode() {
+	PrimaryActorTick.bCanEverTick = true;
+	// The harness spawns its own pawns
+	DefaultPawnClass = nullptr;
+	ESPBotClass = TSoftClassPtr<AESPCharacter>(FSoftObjectPath(TEXT("/Game/Characters/ESPCharacter/BP_PlayerESPCharacter.BP_PlayerESPCharacter_C")));
+	ShooterClass = TSoftClassPtr<AShooterCharacter>(FSoftObjectPath(TEXT("/Game/Characters/ShooterCharacter/BP_RocketShooterCharacter.BP_RocketShooterCharacter_C")));
+}
+
+// Read the run settings from the command line and switch to a fixed timestep
+void APerfHarnessGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) {
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	FParse::Value(CommandLine, TEXT("PerfFrames="), NumFrames);
+	FParse::Value(CommandLine, TEXT("PerfShooters="), NumShooters);
+	FParse::Value(CommandLine, TEXT("PerfFPS="), FixedFPS);
+	FParse::Value(CommandLine, TEXT("PerfBaselineMs="), BaselineMs);
+	FParse::Value(CommandLine, TEXT("PerfTolerance="), Tolerance);
+	FParse::Value(CommandLine, TEXT("PerfHitchMs="), HitchMs);
+	FParse::Value(CommandLine, TEXT("PerfTraverse="), TraverseSpeed);
+
+	// Every frame simulates the same amount of time and runs as fast as it can, so runs are comparable
+	FApp::SetBenchmarking(true);
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(1.0 / FMath::Max(FixedFPS, 1.f));
+}
+
+// Spawn the bots and start capturing
+void APerfHarnessGameMode::StartPlay() {
+	Super::StartPlay();
+
+	SpawnBots();
+	if (TraverseSpeed > 0.f) {
+		if (UCellStreamingSubsystem* CellStreaming = GetWorld()->GetSubsystem<UCellStreamingSubsystem>()) {
+			for (const TWeakObjectPtr<AStreamingCell>& Cell : CellStreaming->GetCells()) {
+				if (Cell.IsValid()) {
+					TraversePoints.Add(Cell->GetCellBounds().GetCenter());
+				}
+			}
+		}
+		// Without cells the run only measures the persistent level, its numbers say nothing about streaming
+		if (TraversePoints.Num() == 0) {
+			UE_LOG(LogTemp, Warning, TEXT("Perf harness: -PerfTraverse was given but the map has no streaming cells, nothing will stream"));
+		}
+	}
+#if CSV_PROFILER
+	FCsvProfiler::Get()->BeginCapture(NumFrames + WarmupFrames, FPaths::ProfilingDir() / TEXT("CSV"), FString::Printf(TEXT("PerfHarness-%s.csv"), *FDateTime::Now().ToString()));
+#endif
+	LastFrameTime = FPlatformTime::Seconds();
+	UE_LOG(LogTemp, Display, TEXT("Perf harness: %d frames at %.0f fps with %d shooters, traversing %d cells"), NumFrames, FixedFPS, NumShooters, TraversePoints.Num());
+}
+
+/**
+* Move the bot toward the next cell center at TraverseSpeed, looping back to the first one.
+* It's teleported at its current height rather than walked, so the route doesn't depend on the navmesh or the cells' content.
+*/
+void APerfHarnessGameMode::Traverse(float DeltaTime) {
+	if (!ESPBot || TraversePoints.Num() == 0) return;
+	const FVector Location = ESPBot->GetActorLocation();
+	FVector Target = TraversePoints[NextTraversePoint % TraversePoints.Num()];
+	Target.Z = Location.Z;
+	const float Step = TraverseSpeed * DeltaTime;
+	if (FVector::DistSquared(Location, Target) <= FMath::Square(Step)) {
+		NextTraversePoint++;
+		ESPBot->SetActorLocation(Target, false, nullptr, ETeleportType::TeleportPhysics);
+		return;
+	}
+	ESPBot->SetActorLocation(Location + (Target - Location).GetSafeNormal() * Step, false, nullptr, ETeleportType::TeleportPhysics);
+}
+
+// Spawn the ESP bot at the player start and the shooters on a ring around it
+void APerfHarnessGameMode::SpawnBots() {
+	UClass* BotClass = ESPBotClass.LoadSynchronous();
+	UClass* EnemyClass = ShooterClass.LoadSynchronous();
+	if (!BotClass || !EnemyClass) {
+		UE_LOG(LogTemp, Error, TEXT("Perf harness: bot classes not found"));
+		return;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	AActor* Start = FindPlayerStart(nullptr);
+	const FTransform StartTransform = Start ? Start->GetActorTransform() : FTransform::Identity;
+
+	ESPBot = GetWorld()->SpawnActor<AESPCharacter>(BotClass, StartTransform, SpawnParams);
+	if (ESPBot) {
+		// The run measures throughput, so the bot doesn't get to die and end it early
+		ESPBot->SetCanBeDamaged(false);
+		if (APerfHarnessBotController* BotController = GetWorld()->SpawnActor<APerfHarnessBotController>(SpawnParams)) {
+			BotController->Possess(ESPBot);
+		} else {
+			UE_LOG(LogTemp, Error, TEXT("Perf harness: couldn't spawn the bot controller, the ESP bot will stand still"));
+		}
+	}
+
+	for (int32 i = 0; i < NumShooters; i++) {
+		const float Angle = 2.f * PI * i / FMath::Max(NumShooters, 1);
+		const FVector Location = StartTransform.GetLocation() + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * ShooterRingRadius;
+		const FRotator Rotation = (StartTransform.GetLocation() - Location).Rotation();
+		if (AShooterCharacter* Shooter = GetWorld()->SpawnActor<AShooterCharacter>(EnemyClass, Location, Rotation, SpawnParams)) {
+			if (!Shooter->GetController()) {
+				Shooter->SpawnDefaultController();
+			}
+		}
+	}
+}
+
+// Measure the frame and end the run after NumFrames
+void APerfHarnessGameMode::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	const double Now = FPlatformTime::Seconds();
+	const float FrameMs = (Now - LastFrameTime) * 1000.0;
+	LastFrameTime = Now;
+	if (bFinished) return;
+
+	Traverse(DeltaTime);
+	RecordCounters();
+	FrameCount++;
+	// Peaks only cover the measured frames
+	if (FrameCount == WarmupFrames + 1) {
+		if (UFireTokenSubsystem* FireTokens = GetWorld()->GetSubsystem<UFireTokenSubsystem>()) {
+			FireTokens->ResetStats();
+		}
+	}
+	if (FrameCount > WarmupFrames) {
+		FrameTimes.Add(FrameMs);
+		Hitches += FrameMs > HitchMs ? 1 : 0;
+		PeakUsedPhysical = FMath::Max<uint64>(PeakUsedPhysical, FPlatformMemory::GetStats().UsedPhysical);
+	}
+	if (FrameTimes.Num() >= NumFrames) {
+		FinishRun();
+	}
+}
+
+// Counters that are states rather than per-frame events
+void APerfHarnessGameMode::RecordCounters() const {
+	CSV_CUSTOM_STAT(ExtrasensoryFun, HeldObjects, ESPBot ? ESPBot->GetHeldObjectCount() : 0, ECsvCustomStatOp::Set);
+	if (UFireTokenSubsystem* FireTokens = GetWorld()->GetSubsystem<UFireTokenSubsystem>()) {
+		CSV_CUSTOM_STAT(ExtrasensoryFun, ProjectilesAlive, FireTokens->GetLiveProjectiles(), ECsvCustomStatOp::Set);
+	}
+	CSV_CUSTOM_STAT(ExtrasensoryFun, UsedPhysicalMB, (float)(FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0)), ECsvCustomStatOp::Set);
+}
+
+// Write the summary, compare against the baseline and exit
+void APerfHarnessGameMode::FinishRun() {
+	bFinished = true;
+#if CSV_PROFILER
+	FCsvProfiler::Get()->EndCapture();
+#endif
+
+	TArray<float> Sorted = FrameTimes;
+	Sorted.Sort();
+	float Total = 0.f;
+	for (float FrameMs : FrameTimes) {
+		Total += FrameMs;
+	}
+	const float AverageMs = Total / FMath::Max(FrameTimes.Num(), 1);
+	const float P95Ms = Sorted.Num() > 0 ? Sorted[FMath::Min(FMath::FloorToInt(Sorted.Num() * 0.95f), Sorted.Num() - 1)] : 0.f;
+	const float WorstMs = Sorted.Num() > 0 ? Sorted.Last() : 0.f;
+
+	const double PeakUsedMB = PeakUsedPhysical / (1024.0 * 1024.0);
+	UFireTokenSubsystem* FireTokens = GetWorld()->GetSubsystem<UFireTokenSubsystem>();
+	const int32 PeakProjectiles = FireTokens ? FireTokens->GetPeakLiveProjectiles() : 0;
+
+	const FString Summary = FString::Printf(TEXT("Frames,Shooters,AverageMs,P95Ms,WorstMs,BaselineMs,Hitches,PeakUsedMB,PeakProjectiles\n%d,%d,%.3f,%.3f,%.3f,%.3f,%d,%.1f,%d\n"),
+		FrameTimes.Num(), NumShooters, AverageMs, P95Ms, WorstMs, BaselineMs, Hitches, PeakUsedMB, PeakProjectiles);
+	FFileHelper::SaveStringToFile(Summary, *(FPaths::ProfilingDir() / TEXT("PerfHarnessSummary.csv")));
+
+	// No baseline means there's nothing to regress against
+	const bool bRegressed = BaselineMs > 0.f && AverageMs > BaselineMs * (1.f + Tolerance);
+	if (bRegressed) {
+		UE_LOG(LogTemp, Error, TEXT("Perf harness: average frame %.3f ms regressed past %.3f ms (+%.0f%%)"), AverageMs, BaselineMs, Tolerance * 100.f);
+	} else {
+		UE_LOG(LogTemp, Display, TEXT("Perf harness: average %.3f ms, p95 %.3f ms, worst %.3f ms"), AverageMs, P95Ms, WorstMs);
+	}
+	UE_LOG(LogTemp, Display, TEXT("Perf harness: %d frames over %.0f ms, peak used memory %.1f MB"), Hitches, HitchMs, PeakUsedMB);
+	if (FireTokens) {
+		FireTokens->DumpStats();
+	}
+	if (UPropNavigationSubsystem* PropNavigation = GetWorld()->GetSubsystem<UPropNavigationSubsystem>()) {
+		PropNavigation->DumpStats();
+	}
+	if (UCellStreamingSubsystem* CellStreaming = GetWorld()->GetSubsystem<UCellStreamingSubsystem>()) {
+		CellStreaming->DumpStats();
+	}
+	FPlatformMisc::RequestExitWithStatus(false, bRegressed ? 1 : 0);
+}
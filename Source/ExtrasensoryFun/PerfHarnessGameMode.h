@@ -0,0 +1,92 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ExtrasensoryFunGameMode.h"
+#include "PerfHarnessGameMode.generated.h"
+
+class AESPCharacter;
+class AShooterCharacter;
+
+/**
+ * Game mode for headless soak and throughput runs.
+ * Spawns a scripted ESP bot and a number of shooter AIs, runs a fixed number of frames at a fixed timestep,
+ * captures a CSV profile with the game's counters, then exits with a non-zero code if the frame time regressed.
+ *
+ * Example nightly run on the server target:
+ * ExtrasensoryFunServer /Game/Main?game=/Script/ExtrasensoryFun.PerfHarnessGameMode -nullrhi -unattended
+ *     -PerfFrames=3600 -PerfShooters=20 -PerfBaselineMs=4.0 -PerfTolerance=0.1
+ *
+ * The fire token benchmark is the same run with -PerfShooters=100, the shooters all engage the bot and the summary
+ * reports the peak number of live projectiles next to the frame times. Compare runs with ef.AI.FireTokenBudget set
+ * through -ExecCmds. Shooters spawned here aren't pooled, so unlike ef.SpawnWave they aren't capped by a pool size.
+ *
+ * With -PerfTraverse=<speed> the ESP bot is moved through every streaming cell in turn, to measure the peak memory
+ * and the hitches (frames over -PerfHitchMs=) caused by streaming the level in and out.
+ * Main isn't split into cells yet, so there are no streaming numbers to compare against until it is.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API APerfHarnessGameMode : public AExtrasensoryFunGameMode {
+	GENERATED_BODY()
+
+public:
+	// Default constructor
+	APerfHarnessGameMode();
+
+	// Read the run settings from the command line and switch to a fixed timestep
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	// Spawn the bots and start capturing
+	virtual void StartPlay() override;
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+private:
+	// -----Harness properties-----
+	UPROPERTY(EditAnywhere, Category = "Harness")
+	TSoftClassPtr<AESPCharacter> ESPBotClass;
+	UPROPERTY(EditAnywhere, Category = "Harness")
+	TSoftClassPtr<AShooterCharacter> ShooterClass;
+	// Overridden by -PerfShooters=
+	UPROPERTY(EditAnywhere, Category = "Harness")
+	int32 NumShooters = 20;
+	// Shooters get spawned on a ring of this radius around the ESP bot
+	UPROPERTY(EditAnywhere, Category = "Harness")
+	float ShooterRingRadius = 2500.f;
+	// Overridden by -PerfFrames=
+	UPROPERTY(EditAnywhere, Category = "Harness")
+	int32 NumFrames = 3600;
+	// Overridden by -PerfFPS=
+	UPROPERTY(EditAnywhere, Category = "Harness")
+	float FixedFPS = 60.f;
+	// Frames skipped before measuring, while everything spawns and settles
+	UPROPERTY(EditAnywhere, Category = "Harness")
+	int32 WarmupFrames = 60;
+	// Average frame time to compare against and allowed regression, from -PerfBaselineMs= and -PerfTolerance=
+	float BaselineMs = 0.f;
+	float Tolerance = 0.1f;
+	// Frames over this count as hitches, from -PerfHitchMs=
+	float HitchMs = 50.f;
+	// Speed at which the bot is moved through the streaming cells, from -PerfTraverse=, 0 to leave it in place
+	float TraverseSpeed = 0.f;
+
+	UPROPERTY()
+	AESPCharacter* ESPBot;
+	// Wall-clock time of each measured frame, in milliseconds
+	TArray<float> FrameTimes;
+	double LastFrameTime = 0.0;
+	int32 FrameCount = 0;
+	bool bFinished = false;
+	int32 Hitches = 0;
+	uint64 PeakUsedPhysical = 0;
+
+	// Cell centers the bot goes through in traversal runs
+	TArray<FVector> TraversePoints;
+	int32 NextTraversePoint = 0;
+	void Traverse(float DeltaTime);
+
+	void SpawnBots();
+	void RecordCounters() const;
+	// Write the summary, compare against the baseline and exit
+	void FinishRun();
+};
@@ -0,0 +1,322 @@
+// by Jason Hilani
+
+
+#include "PhysicsActivitySubsystem.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMeshActor.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "Kismet/GameplayStatics.h"
+#include "EngineUtils.h"
+#include "TimerManager.h"
+#include "ESPCharacter.h"
+#include "ThrownObjectSubsystem.h"
+#include "ExtrasensoryFunStats.h"
+#include "PhysicsTickTimer.h"
+
+DECLARE_CYCLE_STAT(TEXT("Physics Activity Update"), STAT_PhysicsActivityUpdate, STATGROUP_ExtrasensoryFun);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Awake Props"), STAT_AwakeProps, STATGROUP_ExtrasensoryFun);
+
+static TAutoConsoleVariable<int32> CVarActivityManager(
+	TEXT("ef.Physics.ActivityManager"),
+	1,
+	TEXT("Put settled and excess props to sleep, and stop simulating settled props far from the players."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<int32> CVarMaxAwakeProps(
+	TEXT("ef.Physics.MaxAwakeProps"),
+	64,
+	TEXT("Maximum number of awake props that were grabbed at least once, not counting held and flying ones."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarSettleSpeed(
+	TEXT("ef.Physics.SettleSpeed"),
+	30.f,
+	TEXT("Linear speed, and angular speed in degrees, under which a prop is considered settling."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarSettleTime(
+	TEXT("ef.Physics.SettleTime"),
+	0.5f,
+	TEXT("Seconds a prop has to stay under the settle speed before being put to sleep."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarDeactivateDistance(
+	TEXT("ef.Physics.DeactivateDistance"),
+	4000.f,
+	TEXT("Distance from every ESP character past which settled props stop simulating, if they didn't before being grabbed."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarActivityInterval(
+	TEXT("ef.Physics.ActivityInterval"),
+	0.1f,
+	TEXT("Seconds between two passes over the registered props."),
+	ECVF_Default
+);
+
+// Register a prop about to be grabbed, before its physics and collision settings change
+void UPhysicsActivitySubsystem::RegisterProp(UPrimitiveComponent* Component) {
+	if (!Component || SavedCollisions.Contains(Component)) return;
+	SavedCollisions.Add(Component, CollisionProfiles::Save(Component));
+	Props.Add({ Component, Component->IsSimulatingPhysics(), 0.0, Component });
+}
+
+void UPhysicsActivitySubsystem::UnregisterProp(const UPrimitiveComponent* Component) {
+	if (!Component || !SavedCollisions.Remove(Component)) return;
+	Props.RemoveAllSwap([Component](const FProp& Prop) { return Prop.Key == TObjectKey<UPrimitiveComponent>(Component); });
+}
+
+// Log the stats
+void UPhysicsActivitySubsystem::DumpStats() const {
+	UE_LOG(LogTemp, Display, TEXT("Physics activity: %d props, awake %d, peak awake %d, settled sleeps %d, budget sleeps %d, deactivations %d"),
+		Props.Num(), NumAwake, PeakAwake, SettledSleeps, BudgetSleeps, Deactivations);
+}
+
+// Reset the stats, except for the current awake count
+void UPhysicsActivitySubsystem::ResetStats() {
+	PeakAwake = NumAwake;
+	SettledSleeps = 0;
+	BudgetSleeps = 0;
+	Deactivations = 0;
+}
+
+void UPhysicsActivitySubsystem::Tick(float DeltaTime) {
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Now - LastUpdateTime >= CVarActivityInterval.GetValueOnGameThread()) {
+		LastUpdateTime = Now;
+		Update();
+	}
+}
+
+/**
+* One pass over the registered props:
+* - Props that stayed slow for SettleTime are put to sleep, or stop simulating if they're far from every ESP character and didn't simulate originally.
+* - If more than MaxAwakeProps are still awake, the farthest ones are put to sleep.
+* Destroyed props are dropped.
+*/
+void UPhysicsActivitySubsystem::Update() {
+	EF_SCOPE_CYCLE_COUNTER(STAT_PhysicsActivityUpdate);
+	const bool bEnabled = CVarActivityManager.GetValueOnGameThread() != 0;
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float SettleSpeedSquared = FMath::Square(CVarSettleSpeed.GetValueOnGameThread());
+	const float SettleTime = CVarSettleTime.GetValueOnGameThread();
+	const float DeactivateDistanceSquared = FMath::Square(CVarDeactivateDistance.GetValueOnGameThread());
+	const UThrownObjectSubsystem* ThrownObjects = GetWorld()->GetSubsystem<UThrownObjectSubsystem>();
+
+	TArray<FVector, TInlineAllocator<4>> ViewerLocations;
+	for (TActorIterator<AESPCharacter> It(GetWorld()); It; ++It) {
+		ViewerLocations.Add(It->GetActorLocation());
+	}
+	auto DistanceSquaredToViewers = [&ViewerLocations](const FVector& Location) {
+		float Closest = ViewerLocations.Num() > 0 ? MAX_flt : 0.f;
+		for (const FVector& ViewerLocation : ViewerLocations) {
+			Closest = FMath::Min(Closest, (float)FVector::DistSquared(ViewerLocation, Location));
+		}
+		return Closest;
+	};
+
+	// Awake props that could be put to sleep for the budget, with their distance to the closest viewer
+	TArray<TPair<float, UPrimitiveComponent*>> Candidates;
+	NumAwake = 0;
+	for (int32 i = Props.Num() - 1; i >= 0; i--) {
+		FProp& Prop = Props[i];
+		UPrimitiveComponent* Component = Prop.Component.Get();
+		if (!Component) {
+			SavedCollisions.Remove(Prop.Key);
+			Props.RemoveAtSwap(i);
+			continue;
+		}
+		if (!Component->IsSimulatingPhysics() || !Component->IsAnyRigidBodyAwake()) {
+			Prop.SlowSince = 0.0;
+			continue;
+		}
+		NumAwake++;
+		// Held and flying props are someone else's business
+		if (!bEnabled || Component->GetOwner()->ActorHasTag("Grabbed") || (ThrownObjects && ThrownObjects->IsInFlight(Component))) {
+			Prop.SlowSince = 0.0;
+			continue;
+		}
+
+		const bool bSlow = Component->GetPhysicsLinearVelocity().SizeSquared() < SettleSpeedSquared
+			&& Component->GetPhysicsAngularVelocityInDegrees().SizeSquared() < SettleSpeedSquared;
+		if (!bSlow) {
+			Prop.SlowSince = 0.0;
+		} else if (Prop.SlowSince == 0.0) {
+			Prop.SlowSince = Now;
+		}
+		const float DistanceSquared = DistanceSquaredToViewers(Component->GetComponentLocation());
+		if (bSlow && Now - Prop.SlowSince >= SettleTime) {
+			if (!Prop.bOriginallySimulating && DistanceSquared > DeactivateDistanceSquared) {
+				Component->SetSimulatePhysics(false);
+				Deactivations++;
+			} else {
+				Component->PutAllRigidBodiesToSleep();
+				SettledSleeps++;
+			}
+			NumAwake--;
+			Prop.SlowSince = 0.0;
+			continue;
+		}
+		Candidates.Emplace(DistanceSquared, Component);
+	}
+
+	// Over budget, put the farthest to sleep
+	const int32 Excess = Candidates.Num() - CVarMaxAwakeProps.GetValueOnGameThread();
+	if (bEnabled && Excess > 0) {
+		Candidates.Sort([](const TPair<float, UPrimitiveComponent*>& A, const TPair<float, UPrimitiveComponent*>& B) {
+			return A.Key > B.Key;
+		});
+		for (int32 i = 0; i < Excess; i++) {
+			Candidates[i].Value->PutAllRigidBodiesToSleep();
+		}
+		NumAwake -= Excess;
+		BudgetSleeps += Excess;
+	}
+	PeakAwake = FMath::Max(PeakAwake, NumAwake);
+	SET_DWORD_STAT(STAT_AwakeProps, NumAwake);
+	CSV_CUSTOM_STAT(ExtrasensoryFun, AwakeProps, NumAwake, ECsvCustomStatOp::Set);
+}
+
+TStatId UPhysicsActivitySubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPhysicsActivitySubsystem, STATGROUP_Tickables);
+}
+
+// -----Console commands-----
+
+static FAutoConsoleCommandWithWorld PhysicsActivityStatsCommand(
+	TEXT("ef.Physics.ActivityStats"),
+	TEXT("Logs the registered and awake prop counts and how many were put to sleep or deactivated."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World) {
+		if (UPhysicsActivitySubsystem* PhysicsActivity = World->GetSubsystem<UPhysicsActivitySubsystem>()) {
+			PhysicsActivity->DumpStats();
+		}
+	})
+);
+
+// State of a soak test, shared between its two runs
+struct FPhysicsSoakTest {
+	TWeakObjectPtr<UWorld> World;
+	int32 NumProps;
+	float Seconds;
+	bool bManagerEnabled = false;
+	int32 PreviousManagerEnabled;
+	TArray<TWeakObjectPtr<UStaticMeshComponent>> Props;
+	FTimerHandle KickHandle;
+	// Sampled every physics tick
+	FPhysicsTickTimer PhysicsTimer;
+	int64 AwakeSum = 0;
+	int32 PeakAwake = 0;
+};
+
+/**
+* Drop the soak props around the player, then keep kicking some of them around like a fight would,
+* and report the awake counts and physics time once Seconds are over.
+*/
+static void RunPhysicsSoak(TSharedRef<FPhysicsSoakTest> Test) {
+	UWorld* World = Test->World.Get();
+	UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	APawn* PlayerPawn = World ? UGameplayStatics::GetPlayerPawn(World, 0) : nullptr;
+	UPhysicsActivitySubsystem* PhysicsActivity = World ? World->GetSubsystem<UPhysicsActivitySubsystem>() : nullptr;
+	if (!Cube || !PlayerPawn || !PhysicsActivity) {
+		UE_LOG(LogTemp, Error, TEXT("Physics soak test: needs a player pawn"));
+		return;
+	}
+	IConsoleManager::Get().FindConsoleVariable(TEXT("ef.Physics.ActivityManager"))->Set(Test->bManagerEnabled ? 1 : 0);
+	PhysicsActivity->ResetStats();
+
+	// Props within 8000 units, so some end up past the deactivation distance
+	const FVector Origin = PlayerPawn->GetActorLocation();
+	for (int32 i = 0; i < Test->NumProps; i++) {
+		const FVector2D Offset = FMath::RandPointInCircle(8000.f);
+		AStaticMeshActor* Actor = World->SpawnActor<AStaticMeshActor>(Origin + FVector(Offset, FMath::FRandRange(200.f, 800.f)), FRotator::ZeroRotator);
+		UStaticMeshComponent* Mesh = Actor->GetStaticMeshComponent();
+		Mesh->SetMobility(EComponentMobility::Movable);
+		Mesh->SetStaticMesh(Cube);
+		Actor->SetActorScale3D(FVector(0.4f));
+		Mesh->SetCollisionProfileName(TEXT("PhysicsActor"));
+		// Like a grabbed level prop, registered before it starts simulating
+		PhysicsActivity->RegisterProp(Mesh);
+		Mesh->SetSimulatePhysics(true);
+		Test->Props.Add(Mesh);
+	}
+
+	// Kick 2% of the props every half second
+	World->GetTimerManager().SetTimer(Test->KickHandle, [Test]() {
+		const int32 NumKicks = FMath::Max(1, Test->Props.Num() / 50);
+		for (int32 i = 0; i < NumKicks; i++) {
+			if (UStaticMeshComponent* Mesh = Test->Props[FMath::RandHelper(Test->Props.Num())].Get()) {
+				Mesh->SetSimulatePhysics(true);
+				Mesh->WakeAllRigidBodies();
+				Mesh->AddImpulse(FMath::VRand() * 1500.f + FVector(0.f, 0.f, 800.f), NAME_None, true);
+			}
+		}
+	}, 0.5f, true);
+
+	Test->PhysicsTimer.Reset();
+	Test->AwakeSum = 0;
+	Test->PeakAwake = 0;
+	FTimerHandle Unused;
+	World->GetTimerManager().SetTimer(Unused, [Test, PhysicsActivity]() {
+		UWorld* World = Test->World.Get();
+		if (!World) return;
+		World->GetTimerManager().ClearTimer(Test->KickHandle);
+		const int32 Frames = FMath::Max(Test->PhysicsTimer.GetFrames(), 1);
+		UE_LOG(LogTemp, Display, TEXT("  Manager %s: awake %.1f average, %d peak, %.3f ms physics per frame"),
+			Test->bManagerEnabled ? TEXT("on ") : TEXT("off"), (double)Test->AwakeSum / Frames, Test->PeakAwake, Test->PhysicsTimer.GetAverageMs());
+		if (Test->bManagerEnabled) {
+			PhysicsActivity->DumpStats();
+		}
+		for (const TWeakObjectPtr<UStaticMeshComponent>& Mesh : Test->Props) {
+			if (Mesh.IsValid()) {
+				Mesh->GetOwner()->Destroy();
+			}
+		}
+		Test->Props.Reset();
+
+		if (!Test->bManagerEnabled) {
+			Test->bManagerEnabled = true;
+			RunPhysicsSoak(Test);
+			return;
+		}
+		// Done, put everything back
+		IConsoleManager::Get().FindConsoleVariable(TEXT("ef.Physics.ActivityManager"))->Set(Test->PreviousManagerEnabled);
+		Test->PhysicsTimer.Stop();
+	}, Test->Seconds, false);
+}
+
+// Soak test with and without the activity manager
+static void PhysicsSoakTest(const TArray<FString>& Args, UWorld* World) {
+	TSharedRef<FPhysicsSoakTest> Test = MakeShared<FPhysicsSoakTest>();
+	Test->World = World;
+	Test->NumProps = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000;
+	Test->Seconds = Args.Num() > 1 ? FMath::Max(FCString::Atof(*Args[1]), 1.f) : 30.f;
+	Test->PreviousManagerEnabled = CVarActivityManager.GetValueOnGameThread();
+
+	// The awake soak props once each timed physics tick is done, the timer belongs to the test so it can't outlive it
+	FPhysicsSoakTest* TestState = &Test.Get();
+	const bool bStarted = Test->PhysicsTimer.Start(World, [TestState]() {
+		int32 Awake = 0;
+		for (const TWeakObjectPtr<UStaticMeshComponent>& Mesh : TestState->Props) {
+			if (Mesh.IsValid() && Mesh->IsSimulatingPhysics() && Mesh->IsAnyRigidBodyAwake()) {
+				Awake++;
+			}
+		}
+		TestState->AwakeSum += Awake;
+		TestState->PeakAwake = FMath::Max(TestState->PeakAwake, Awake);
+	});
+	if (!bStarted) return;
+
+	UE_LOG(LogTemp, Display, TEXT("Physics soak test: %d props, %.0f s per run"), Test->NumProps, Test->Seconds);
+	RunPhysicsSoak(Test);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs PhysicsSoakTestCommand(
+	TEXT("ef.Physics.SoakTest"),
+	TEXT("Kicks props around the player with and without the activity manager and reports awake counts and physics time. Usage: ef.Physics.SoakTest [Props=1000] [Seconds=30]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&PhysicsSoakTest)
+);
@@ -0,0 +1,62 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CollisionProfiles.h"
+#include "PhysicsActivitySubsystem.generated.h"
+
+/**
+ * Keeps the number of simulating props in check after fights.
+ * Every prop grabbed at least once is registered here. Released props that settle are put to sleep instead of waiting
+ * for the solver, and those that settle far from every ESP character stop simulating if they didn't simulate before being grabbed.
+ * On top of that, at most ef.Physics.MaxAwakeProps registered props stay awake, the farthest ones are put to sleep first.
+ * Held props and thrown props still in flight are left alone.
+ * It also keeps each prop's collision settings from before its first grab, to restore them on release.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API UPhysicsActivitySubsystem : public UTickableWorldSubsystem {
+	GENERATED_BODY()
+
+public:
+	// Register a prop about to be grabbed, before its physics and collision settings change
+	void RegisterProp(UPrimitiveComponent* Component);
+	// Forget a prop whose level is being unloaded
+	void UnregisterProp(const UPrimitiveComponent* Component);
+	// Collision settings from before the first grab, null if it was never grabbed
+	const CollisionProfiles::FSavedCollision* GetSavedCollision(const UPrimitiveComponent* Component) const { return SavedCollisions.Find(Component); }
+
+	// Awake registered props as of the last update
+	int32 GetNumAwake() const { return NumAwake; }
+	int32 GetNumRegistered() const { return Props.Num(); }
+
+	// Log and reset the stats
+	void DumpStats() const;
+	void ResetStats();
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	struct FProp {
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		// Level props that didn't simulate go back to not simulating when settled far away
+		bool bOriginallySimulating;
+		// Time since which it has been under the settle speed, 0 while moving
+		double SlowSince;
+		// Its saved collision settings, which outlive the component
+		TObjectKey<UPrimitiveComponent> Key;
+	};
+	TArray<FProp> Props;
+	TMap<TObjectKey<UPrimitiveComponent>, CollisionProfiles::FSavedCollision> SavedCollisions;
+	double LastUpdateTime = 0.0;
+	void Update();
+
+	// -----Stats-----
+	int32 NumAwake = 0;
+	int32 PeakAwake = 0;
+	int32 SettledSleeps = 0;
+	int32 BudgetSleeps = 0;
+	int32 Deactivations = 0;
+};
@@ -0,0 +1,54 @@
+// by Jason Hilani
+
+
+#include "PhysicsTickTimer.h"
+#include "Engine/World.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+
+// Listen to the world's physics scene
+bool FPhysicsTickTimer::Start(UWorld* InWorld, TFunction<void()> InOnPostTick) {
+	Stop();
+	FPhysScene* PhysScene = InWorld ? InWorld->GetPhysicsScene() : nullptr;
+	if (!PhysScene) return false;
+	World = InWorld;
+	OnPostTick = MoveTemp(InOnPostTick);
+	PreTickHandle = PhysScene->OnPhysScenePreTick.AddRaw(this, &FPhysicsTickTimer::HandlePreTick);
+	PostTickHandle = PhysScene->OnPhysScenePostTick.AddRaw(this, &FPhysicsTickTimer::HandlePostTick);
+	Reset();
+	return true;
+}
+
+// Stop listening, the scene is gone already if the world is
+void FPhysicsTickTimer::Stop() {
+	if (UWorld* CurrentWorld = World.Get()) {
+		if (FPhysScene* PhysScene = CurrentWorld->GetPhysicsScene()) {
+			PhysScene->OnPhysScenePreTick.Remove(PreTickHandle);
+			PhysScene->OnPhysScenePostTick.Remove(PostTickHandle);
+		}
+	}
+	World.Reset();
+	OnPostTick.Reset();
+	PreTickHandle.Reset();
+	PostTickHandle.Reset();
+}
+
+void FPhysicsTickTimer::Reset() {
+	StartTime = 0.0;
+	Seconds = 0.0;
+	Frames = 0;
+}
+
+void FPhysicsTickTimer::HandlePreTick(FPhysScene_Chaos* Scene, float DeltaTime) {
+	StartTime = FPlatformTime::Seconds();
+}
+
+// Only ticks that started after the last reset are counted
+void FPhysicsTickTimer::HandlePostTick(FPhysScene_Chaos* Scene) {
+	if (StartTime <= 0.0) return;
+	Seconds += FPlatformTime::Seconds() - StartTime;
+	Frames++;
+	StartTime = 0.0;
+	if (OnPostTick) {
+		OnPostTick();
+	}
+}
@@ -0,0 +1,43 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+class FPhysScene_Chaos;
+
+/**
+ * Times a world's physics ticks for the physics benchmarks, from the start of the physics tick to the end of the solve.
+ * An optional callback runs after each timed tick, to sample the scene along with the time.
+ * Stops listening on Stop or when destroyed, so it can live in a benchmark's shared state.
+ */
+class EXTRASENSORYFUN_API FPhysicsTickTimer {
+public:
+	FPhysicsTickTimer() = default;
+	FPhysicsTickTimer(const FPhysicsTickTimer&) = delete;
+	FPhysicsTickTimer& operator=(const FPhysicsTickTimer&) = delete;
+	~FPhysicsTickTimer() { Stop(); }
+
+	// Start listening to the world's physics scene, false if it has none
+	bool Start(UWorld* InWorld, TFunction<void()> InOnPostTick = nullptr);
+	void Stop();
+	// Forget the ticks timed so far, e.g. between the runs of a benchmark
+	void Reset();
+
+	int32 GetFrames() const { return Frames; }
+	// Average physics tick time since the last reset
+	double GetAverageMs() const { return Frames > 0 ? Seconds * 1000.0 / Frames : 0.0; }
+
+private:
+	void HandlePreTick(FPhysScene_Chaos* Scene, float DeltaTime);
+	void HandlePostTick(FPhysScene_Chaos* Scene);
+
+	TWeakObjectPtr<UWorld> World;
+	TFunction<void()> OnPostTick;
+	FDelegateHandle PreTickHandle;
+	FDelegateHandle PostTickHandle;
+	double StartTime = 0.0;
+	double Seconds = 0.0;
+	int32 Frames = 0;
+};
@@ -0,0 +1,31 @@
+// by Jason Hilani
+
+
+#include "PlayerHUDWidget.h"
+#include "HealthComponent.h"
+#include "Components/ProgressBar.h"
+
+// Listen to a health component and show its current health right away
+void UPlayerHUDWidget::SetHealthComponent(UHealthComponent* InHealthComponent) {
+	if (HealthComponent) {
+		HealthComponent->OnHealthChanged.RemoveDynamic(this, &UPlayerHUDWidget::HandleHealthChanged);
+	}
+	HealthComponent = InHealthComponent;
+	if (HealthComponent) {
+		HealthComponent->OnHealthChanged.AddUniqueDynamic(this, &UPlayerHUDWidget::HandleHealthChanged);
+		HandleHealthChanged(HealthComponent->GetHealth(), HealthComponent->GetHealthPercent());
+	}
+}
+
+void UPlayerHUDWidget::NativeDestruct() {
+	SetHealthComponent(nullptr);
+	Super::NativeDestruct();
+}
+
+// Update the health bar, then let the blueprint update the rest
+void UPlayerHUDWidget::HandleHealthChanged(float Health, float HealthPercent) {
+	if (HealthBar) {
+		HealthBar->SetPercent(HealthPercent);
+	}
+	OnHealthUpdated(Health, HealthPercent);
+}
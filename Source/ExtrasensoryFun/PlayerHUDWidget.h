@@ -0,0 +1,43 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "PlayerHUDWidget.generated.h"
+
+class UHealthComponent;
+class UProgressBar;
+
+/**
+ * Base class of the player's HUD widget.
+ * The HUD listens to the possessed character's OnHealthChanged instead of binding to GetHealthPercent,
+ * so it only updates when health actually changes rather than on every paint.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API UPlayerHUDWidget : public UUserWidget {
+	GENERATED_BODY()
+
+public:
+	// Listen to a health component, or stop listening with nullptr
+	void SetHealthComponent(UHealthComponent* InHealthComponent);
+
+protected:
+	// Stop listening when the widget goes away
+	virtual void NativeDestruct() override;
+
+	// Filled with the health percent, when the widget has one named HealthBar
+	UPROPERTY(meta = (BindWidgetOptional))
+	UProgressBar* HealthBar;
+
+	// Called on every health change, for the rest of the widget to update
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnHealthUpdated(float Health, float HealthPercent);
+
+private:
+	UPROPERTY()
+	UHealthComponent* HealthComponent;
+
+	UFUNCTION()
+	void HandleHealthChanged(float Health, float HealthPercent);
+};
@@ -0,0 +1,152 @@
+// by Jason Hilani
+
+
+#include "PropNavigationSubsystem.h"
+#include "NavigationSystem.h"
+#include "Components/PrimitiveComponent.h"
+#include "ThrownObjectSubsystem.h"
+#include "ExtrasensoryFunStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Prop Navigation Tick"), STAT_PropNavigationTick, STATGROUP_ExtrasensoryFun);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Props Out Of Navmesh"), STAT_PropsOutOfNavmesh, STATGROUP_ExtrasensoryFun);
+
+static TAutoConsoleVariable<int32> CVarPropExclusion(
+	TEXT("ef.Nav.PropExclusion"),
+	1,
+	TEXT("Take grabbed props out of the navmesh until they settle."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<int32> CVarMaxPropRegistrations(
+	TEXT("ef.Nav.MaxPropRegistrations"),
+	8,
+	TEXT("Maximum number of settled props put back in the navmesh per batch."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarPropRegistrationInterval(
+	TEXT("ef.Nav.PropRegistrationInterval"),
+	0.5f,
+	TEXT("Seconds between two batches of settled props put back in the navmesh."),
+	ECVF_Default
+);
+
+// Take a prop about to be grabbed out of the navmesh, once
+void UPropNavigationSubsystem::ExcludeProp(UPrimitiveComponent* Component) {
+	if (!Component || CVarPropExclusion.GetValueOnGameThread() == 0) return;
+	// Grabbed again while waiting to go back in
+	if (SettledProps.Remove(Component) > 0) {
+		ExcludedProps.Add(Component);
+		return;
+	}
+	if (!Component->CanEverAffectNavigation() || ExcludedProps.Contains(Component)) return;
+	Component->SetCanEverAffectNavigation(false);
+	ExcludedProps.Add(Component);
+	Exclusions++;
+}
+
+bool UPropNavigationSubsystem::IsExcluded(const UPrimitiveComponent* Component) const {
+	return ExcludedProps.Contains(Component) || SettledProps.Contains(Component);
+}
+
+void UPropNavigationSubsystem::UnregisterProp(const UPrimitiveComponent* Component) {
+	auto IsComponent = [Component](const TWeakObjectPtr<UPrimitiveComponent>& Prop) { return Prop == Component; };
+	ExcludedProps.RemoveAllSwap(IsComponent);
+	SettledProps.RemoveAllSwap(IsComponent);
+}
+
+/**
+* Queue the props that settled, put a batch of them back in the navmesh if it's time,
+* and follow the navmesh build tasks.
+*/
+void UPropNavigationSubsystem::Tick(float DeltaTime) {
+	EF_SCOPE_CYCLE_COUNTER(STAT_PropNavigationTick);
+	const UThrownObjectSubsystem* ThrownObjects = GetWorld()->GetSubsystem<UThrownObjectSubsystem>();
+	for (int32 i = ExcludedProps.Num() - 1; i >= 0; i--) {
+		UPrimitiveComponent* Component = ExcludedProps[i].Get();
+		if (!Component) {
+			ExcludedProps.RemoveAtSwap(i);
+			continue;
+		}
+		const bool bMoving = Component->GetOwner()->ActorHasTag("Grabbed") || (ThrownObjects && ThrownObjects->IsTracked(Component))
+			|| (Component->IsSimulatingPhysics() && Component->IsAnyRigidBodyAwake());
+		if (!bMoving) {
+			SettledProps.Add(Component);
+			ExcludedProps.RemoveAtSwap(i);
+		}
+	}
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (SettledProps.Num() > 0 && Now - LastRegistrationTime >= CVarPropRegistrationInterval.GetValueOnGameThread()) {
+		LastRegistrationTime = Now;
+		RegisterSettledProps();
+	}
+	SET_DWORD_STAT(STAT_PropsOutOfNavmesh, ExcludedProps.Num() + SettledProps.Num());
+
+	// Build time, from the first pending tile to the last built one
+	if (const UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld())) {
+		const int32 BuildTasks = NavSys->GetNumRemainingBuildTasks() + NavSys->GetNumRunningBuildTasks();
+		PeakBuildTasks = FMath::Max(PeakBuildTasks, BuildTasks);
+		const double RealTime = FPlatformTime::Seconds();
+		if (BuildTasks > 0 && !bBuilding) {
+			bBuilding = true;
+			BuildStartTime = RealTime;
+		} else if (BuildTasks == 0 && bBuilding) {
+			bBuilding = false;
+			BuildSeconds += RealTime - BuildStartTime;
+			Builds++;
+		}
+		CSV_CUSTOM_STAT(ExtrasensoryFun, NavBuildTasks, BuildTasks, ECsvCustomStatOp::Set);
+	}
+}
+
+// Put the oldest settled props back in the navmesh, up to the budget
+void UPropNavigationSubsystem::RegisterSettledProps() {
+	const int32 Count = FMath::Min(SettledProps.Num(), CVarMaxPropRegistrations.GetValueOnGameThread());
+	for (int32 i = 0; i < Count; i++) {
+		if (UPrimitiveComponent* Component = SettledProps[i].Get()) {
+			Component->SetCanEverAffectNavigation(true);
+			Registrations++;
+		}
+	}
+	SettledProps.RemoveAt(0, Count);
+}
+
+TStatId UPropNavigationSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPropNavigationSubsystem, STATGROUP_Tickables);
+}
+
+// Log the stats
+void UPropNavigationSubsystem::DumpStats() const {
+	UE_LOG(LogTemp, Display, TEXT("Prop navigation: %d exclusions, %d registrations, %d out of the navmesh. Navmesh: %d builds, %.1f ms building, peak %d tasks. AI re-paths: %d"),
+		Exclusions, Registrations, ExcludedProps.Num() + SettledProps.Num(), Builds, BuildSeconds * 1000.0, PeakBuildTasks, Repaths);
+}
+
+void UPropNavigationSubsystem::ResetStats() {
+	Exclusions = 0;
+	Registrations = 0;
+	Repaths = 0;
+	BuildSeconds = 0.0;
+	Builds = 0;
+	PeakBuildTasks = 0;
+}
+
+// Console commands to read and reset the stats while playing or running the perf harness
+static FAutoConsoleCommandWithWorld PropNavigationStatsCommand(
+	TEXT("ef.Nav.Stats"),
+	TEXT("Logs prop navigation exclusions, navmesh build time and AI re-paths."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World) {
+		if (UPropNavigationSubsystem* PropNavigation = World->GetSubsystem<UPropNavigationSubsystem>()) {
+			PropNavigation->DumpStats();
+		}
+	})
+);
+
+static FAutoConsoleCommandWithWorld PropNavigationStatsResetCommand(
+	TEXT("ef.Nav.StatsReset"),
+	TEXT("Resets the prop navigation, navmesh build and re-path stats."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World) {
+		if (UPropNavigationSubsystem* PropNavigation = World->GetSubsystem<UPropNavigationSubsystem>()) {
+			PropNavigation->ResetStats();
+		}
+	})
+);
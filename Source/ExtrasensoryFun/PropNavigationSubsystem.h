@@ -0,0 +1,55 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PropNavigationSubsystem.generated.h"
+
+/**
+ * Keeps moving telekinesis props out of the navmesh.
+ * A grabbed prop that affects navigation is taken out of it once, dirtying the tiles where it was,
+ * and stays out while it's held, flying or still moving, so it doesn't dirty tiles every frame it moves.
+ * Once settled it goes back in, dirtying the tiles where it landed. Settled props are registered back in batches,
+ * at most ef.Nav.MaxPropRegistrations every ef.Nav.PropRegistrationInterval, so their tile rebuilds get coalesced.
+ * Also measures the navmesh build time and the AI re-paths caused by navigation changes.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API UPropNavigationSubsystem : public UTickableWorldSubsystem {
+	GENERATED_BODY()
+
+public:
+	// Take a prop about to be grabbed out of the navmesh
+	void ExcludeProp(UPrimitiveComponent* Component);
+	bool IsExcluded(const UPrimitiveComponent* Component) const;
+	// Forget a prop whose level is being unloaded, the navmesh loses its geometry with the level anyway
+	void UnregisterProp(const UPrimitiveComponent* Component);
+
+	// Called by AI controllers when navigation changes update or invalidate their path
+	void RecordRepath() { Repaths++; }
+
+	// Log and reset the stats
+	void DumpStats() const;
+	void ResetStats();
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	// Excluded props, settled ones are queued for registration
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> ExcludedProps;
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> SettledProps;
+	double LastRegistrationTime = 0.0;
+	void RegisterSettledProps();
+
+	// -----Stats-----
+	int32 Exclusions = 0;
+	int32 Registrations = 0;
+	int32 Repaths = 0;
+	// Time spent with navmesh tiles waiting or being built
+	double BuildSeconds = 0.0;
+	int32 Builds = 0;
+	int32 PeakBuildTasks = 0;
+	double BuildStartTime = 0.0;
+	bool bBuilding = false;
+};
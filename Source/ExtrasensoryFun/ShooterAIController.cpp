@@ -4,17 +4,43 @@
 #include "ShooterAIController.h"
 #include "Kismet/GameplayStatics.h"
 #include "BehaviorTree/BlackboardComponent.h"
+#include "ExtrasensoryFunLLM.h"
+#include "PropNavigationSubsystem.h"
 
 void AShooterAIController::BeginPlay() {
 	Super::BeginPlay();
+}
+
+// Start the behaviour tree on possession rather than in BeginPlay,
+// since controllers of pawns spawned at runtime begin play before possessing them
+void AShooterAIController::OnPossess(APawn* InPawn) {
+	Super::OnPossess(InPawn);
+	LLM_SCOPE_BYTAG(ExtrasensoryFun_AI);
 	// Assign behaviour tree and pawn's start location and rotation
-	if (AIBehavior) {
+	if (AIBehavior && InPawn) {
 		RunBehaviorTree(AIBehavior);
-		GetBlackboardComponent()->SetValueAsVector(TEXT("StartLocation"), GetPawn()->GetActorLocation());
-		GetBlackboardComponent()->SetValueAsRotator(TEXT("StartRotation"), GetPawn()->GetActorRotation());
+		GetBlackboardComponent()->SetValueAsVector(TEXT("StartLocation"), InPawn->GetActorLocation());
+		GetBlackboardComponent()->SetValueAsRotator(TEXT("StartRotation"), InPawn->GetActorRotation());
 	}
 }
 
 void AShooterAIController::Tick(float DeltaTime) {
 	Super::Tick(DeltaTime);
+}
+
+// Watch the move's path for navigation changes
+FAIRequestID AShooterAIController::RequestMove(const FAIMoveRequest& MoveRequest, FNavPathSharedPtr Path) {
+	if (Path.IsValid()) {
+		Path->AddObserver(FNavigationPath::FPathObserverDelegate::FDelegate::CreateUObject(this, &AShooterAIController::OnPathEvent));
+	}
+	return Super::RequestMove(MoveRequest, Path);
+}
+
+// Count the re-paths caused by navigation changes
+void AShooterAIController::OnPathEvent(FNavigationPath* Path, ENavPathEvent::Type Event) {
+	if (Event == ENavPathEvent::Invalidated || Event == ENavPathEvent::UpdatedDueToNavigationChanged) {
+		if (UPropNavigationSubsystem* PropNavigation = GetWorld()->GetSubsystem<UPropNavigationSubsystem>()) {
+			PropNavigation->RecordRepath();
+		}
+	}
 }
\ No newline at end of file
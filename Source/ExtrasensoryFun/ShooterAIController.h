@@ -18,12 +18,19 @@ class EXTRASENSORYFUN_API AShooterAIController : public AAIController {
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	// Called when the controller takes possession of a pawn
+	virtual void OnPossess(APawn* InPawn) override;
 
 public:
 	// Called every frame
 	virtual void Tick(float DeltaSeconds) override;
+	// Watch the move's path for navigation changes
+	virtual FAIRequestID RequestMove(const FAIMoveRequest& MoveRequest, FNavPathSharedPtr Path) override;
 
 private:
+	// Count the re-paths caused by navigation changes
+	void OnPathEvent(FNavigationPath* Path, ENavPathEvent::Type Event);
+
 	UPROPERTY(EditAnywhere)
 	UBehaviorTree* AIBehavior;
 };
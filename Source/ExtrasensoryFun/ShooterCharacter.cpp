@@ -2,6 +2,10 @@
 
 #include "ShooterCharacter.h"
 #include "ShooterWeapon.h"
+#include "SoftAssets.h"
+#include "ShooterSpawnDirector.h"
+#include "AIController.h"
+#include "BrainComponent.h"
 
 // Called when the game starts or when spawned
 void AShooterCharacter::BeginPlay() {
@@ -13,10 +17,46 @@ void AShooterCharacter::BeginPlay() {
 		GetMesh()->HideBoneByName(TEXT("b_RightWeapon"), EPhysBodyOp::PBO_None);
 		ShooterWeapon->AttachToComponent(GetMesh(), FAttachmentTransformRules::KeepRelativeTransform, TEXT("WeaponPoint"));
 		ShooterWeapon->SetOwner(this);
+		// Its projectile class, and that class' FX and sounds, if the menu didn't preload them
+		SoftAssets::RequestSoftReferences(ShooterWeapon);
 	}
 
 }
 
+// Called when the character is removed from the world
+void AShooterCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	Super::EndPlay(EndPlayReason);
+
+	// The weapon is a separate actor in the persistent level, so make sure it doesn't outlive its character or its streamed out level
+	if ((EndPlayReason == EEndPlayReason::Destroyed || EndPlayReason == EEndPlayReason::RemovedFromWorld) && ShooterWeapon) {
+		ShooterWeapon->Destroy();
+		ShooterWeapon = nullptr;
+	}
+}
+
+// Pooled characters keep their controller, only stop its behaviour tree
+void AShooterCharacter::ReleaseControllerOnDeath() {
+	if (!SpawnDirector) {
+		Super::ReleaseControllerOnDeath();
+		return;
+	}
+	if (AAIController* AIController = Cast<AAIController>(GetController())) {
+		AIController->StopMovement();
+		if (UBrainComponent* Brain = AIController->GetBrainComponent()) {
+			Brain->StopLogic(TEXT("Dead"));
+		}
+	}
+}
+
+// Handle character death and hand pooled characters back to their director
+void AShooterCharacter::HandleDeath() {
+	Super::HandleDeath();
+
+	if (SpawnDirector) {
+		SpawnDirector->OnPooledCharacterDied(this);
+	}
+}
+
 // Called to bind functionality to player input
 void AShooterCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent) {
 	Super::SetupPlayerInputComponent(PlayerInputComponent);
@@ -32,4 +72,11 @@ void AShooterCharacter::Shoot() {
 	}
 }
 
+// Spawn a cosmetic copy of a projectile the server fired, the server already spawned the real one
+void AShooterCharacter::MulticastFireWeapon_Implementation(FVector_NetQuantize Location, FRotator ShotDirection) {
+	if (!HasAuthority() && ShooterWeapon) {
+		ShooterWeapon->SpawnProjectile(Location, ShotDirection, true);
+	}
+}
+
 
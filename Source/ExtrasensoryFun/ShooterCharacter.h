@@ -4,9 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "BaseCharacter.h"
+#include "Engine/NetSerialization.h"
 #include "ShooterCharacter.generated.h"
 
 class AShooterWeapon;
+class AShooterSpawnDirector;
 
 /**
  * Adds shooter functionality to a character.
@@ -20,6 +22,10 @@ class EXTRASENSORYFUN_API AShooterCharacter : public ABaseCharacter
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	// Called when the character is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	// Pooled characters keep their controller when dying
+	virtual void ReleaseControllerOnDeath() override;
 
 public:
 	// Called to bind functionality to player input
@@ -27,6 +33,17 @@ public:
 
 	// Fire weapon
 	void Shoot();
+	// Spawn a cosmetic copy of a projectile the server fired, projectiles themselves aren't replicated
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastFireWeapon(FVector_NetQuantize Location, FRotator ShotDirection);
+
+	// Handle character death
+	virtual void HandleDeath() override;
+
+	// Getter and setter methods
+	AShooterWeapon* GetShooterWeapon() const { return ShooterWeapon; }
+	AShooterSpawnDirector* GetSpawnDirector() const { return SpawnDirector; }
+	void SetSpawnDirector(AShooterSpawnDirector* NewSpawnDirector) { SpawnDirector = NewSpawnDirector; }
 
 private:
 	// Weapon class
@@ -34,4 +51,8 @@ private:
 	TSubclassOf<AShooterWeapon> ShooterWeaponClass;
 	UPROPERTY()
 	AShooterWeapon* ShooterWeapon;
+
+	// Spawn director owning this character's pool, if any
+	UPROPERTY()
+	AShooterSpawnDirector* SpawnDirector;
 };
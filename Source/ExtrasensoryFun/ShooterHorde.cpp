@@ -0,0 +1,216 @@
+// by Jason Hilani
+
+
+#include "ShooterHorde.h"
+#include "ShooterCharacter.h"
+#include "HealthComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "GameFramework/PlayerController.h"
+#include "ExtrasensoryFunStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Shooter Horde Tick"), STAT_ShooterHordeTick, STATGROUP_ExtrasensoryFun);
+
+// Default constructor
+AShooterHorde::AShooterHorde() {
+	// Set this actor to call Tick() every frame.
+	PrimaryActorTick.bCanEverTick = true;
+
+	// Root component to place the horde in the level
+	SetRootComponent(CreateDefaultSubobject<USceneComponent>(TEXT("Root")));
+}
+
+// Called when the game starts or when spawned
+void AShooterHorde::BeginPlay() {
+	Super::BeginPlay();
+
+	ResetEntities();
+}
+
+// Remove the promoted actors and scatter the entities around the horde actor, all starting idle with full health
+void AShooterHorde::ResetEntities() {
+	for (int32 Index : PromotedIndices) {
+		if (Actors[Index]) {
+			Actors[Index]->DetachFromControllerPendingDestroy();
+			Actors[Index]->Destroy();
+		}
+	}
+	PromotedIndices.Reset();
+
+	Positions.SetNumUninitialized(EntityCount);
+	Healths.Init(GetEntityMaxHealth(), EntityCount);
+	States.Init(EHordeEntityState::Idle, EntityCount);
+	Actors.Init(nullptr, EntityCount);
+	PromotedIndices.Reserve(MaxPromoted);
+	PromotionCandidates.Reserve(MaxPromoted);
+
+	const FVector Origin = GetActorLocation();
+	for (int32 i = 0; i < EntityCount; i++) {
+		const FVector2D Offset = FMath::RandPointInCircle(SpawnRadius);
+		Positions[i] = Origin + FVector(Offset.X, Offset.Y, 0.f);
+	}
+}
+
+// Called when the horde is removed from the world
+void AShooterHorde::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	// Promoted actors belong to the horde, so take them with it, also when its level streams out
+	if (EndPlayReason == EEndPlayReason::Destroyed || EndPlayReason == EEndPlayReason::RemovedFromWorld) {
+		for (int32 Index : PromotedIndices) {
+			if (Actors[Index]) {
+				Actors[Index]->Destroy();
+			}
+		}
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+// Called every frame
+void AShooterHorde::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+	EF_SCOPE_CYCLE_COUNTER(STAT_ShooterHordeTick);
+
+	APlayerController* PlayerController = UGameplayStatics::GetPlayerController(this, 0);
+	APawn* PlayerPawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+	if (!PlayerPawn) return;
+
+	const FVector PlayerLocation = PlayerPawn->GetActorLocation();
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	const FVector ViewDirection = ViewRotation.Vector();
+
+	// Demote first so freed slots can be reused by promotions in the same frame
+	ProcessPromoted(PlayerLocation, ViewLocation, ViewDirection);
+	ProcessMovement(DeltaTime, PlayerLocation);
+	ProcessPromotionCandidates(PlayerLocation, ViewLocation, ViewDirection);
+}
+
+// Max health of the promoted class' health component, 100 like UHealthComponent's default when there's no class
+float AShooterHorde::GetEntityMaxHealth() const {
+	const AShooterCharacter* DefaultCharacter = ShooterCharacterClass ? ShooterCharacterClass->GetDefaultObject<AShooterCharacter>() : nullptr;
+	return DefaultCharacter && DefaultCharacter->GetHealthComponent() ? DefaultCharacter->GetHealthComponent()->GetMaxHealth() : 100.f;
+}
+
+/**
+* Move all data-only entities in one pass.
+* Idle entities wake up when the player gets within AggroDistance, advancing entities walk straight towards the player.
+* There's no navigation for data-only entities, they only need to be roughly in the right place when promoted.
+*/
+void AShooterHorde::ProcessMovement(float DeltaTime, const FVector& PlayerLocation) {
+	const float AggroDistanceSquared = AggroDistance * AggroDistance;
+	// Stop short of the promotion range, the full AI takes over from there
+	const float StopDistanceSquared = FMath::Square(PromoteDistance * 0.5f);
+	const float Step = MoveSpeed * DeltaTime;
+
+	for (int32 i = 0; i < Positions.Num(); i++) {
+		if (States[i] == EHordeEntityState::Promoted || States[i] == EHordeEntityState::Dead) continue;
+
+		FVector ToPlayer = PlayerLocation - Positions[i];
+		ToPlayer.Z = 0.f;
+		const float DistanceSquared = ToPlayer.SizeSquared();
+		if (States[i] == EHordeEntityState::Idle) {
+			if (DistanceSquared < AggroDistanceSquared) {
+				States[i] = EHordeEntityState::Advancing;
+			}
+		} else if (DistanceSquared > StopDistanceSquared) {
+			Positions[i] += ToPlayer * (Step * FMath::InvSqrt(DistanceSquared));
+		}
+	}
+}
+
+// Check on every promoted entity, demoting the ones that left range and forgetting the ones that died
+void AShooterHorde::ProcessPromoted(const FVector& PlayerLocation, const FVector& ViewLocation, const FVector& ViewDirection) {
+	for (int32 i = PromotedIndices.Num() - 1; i >= 0; i--) {
+		const int32 Index = PromotedIndices[i];
+		AShooterCharacter* Character = Actors[Index];
+		// Dead characters are left to the game mode like any other character
+		if (!IsValid(Character) || Character->GetHealthComponent()->IsDead()) {
+			States[Index] = EHordeEntityState::Dead;
+			Healths[Index] = 0.f;
+			Actors[Index] = nullptr;
+			PromotedIndices.RemoveAtSwap(i);
+			continue;
+		}
+		Positions[Index] = Character->GetActorLocation();
+		if (!IsRelevant(Positions[Index], PlayerLocation, ViewLocation, ViewDirection, DemoteHysteresis)) {
+			DemoteEntity(Index);
+			PromotedIndices.RemoveAtSwap(i);
+		}
+	}
+}
+
+/**
+* Find the entities that should be promoted this frame.
+* Keeps the closest candidates, up to MaxPromotionsPerFrame and the remaining MaxPromoted slots.
+*/
+void AShooterHorde::ProcessPromotionCandidates(const FVector& PlayerLocation, const FVector& ViewLocation, const FVector& ViewDirection) {
+	const int32 Budget = FMath::Min(MaxPromotionsPerFrame, MaxPromoted - PromotedIndices.Num());
+	if (Budget <= 0 || !ShooterCharacterClass) return;
+
+	PromotionCandidates.Reset();
+	for (int32 i = 0; i < Positions.Num(); i++) {
+		if (States[i] == EHordeEntityState::Advancing && IsRelevant(Positions[i], PlayerLocation, ViewLocation, ViewDirection, 0.f)) {
+			PromotionCandidates.Add(i);
+		}
+	}
+	if (PromotionCandidates.Num() > Budget) {
+		PromotionCandidates.Sort([this, &PlayerLocation](int32 A, int32 B) {
+			return FVector::DistSquared(Positions[A], PlayerLocation) < FVector::DistSquared(Positions[B], PlayerLocation);
+		});
+		PromotionCandidates.SetNum(Budget, false);
+	}
+	for (int32 Index : PromotionCandidates) {
+		PromoteEntity(Index);
+	}
+}
+
+/**
+* An entity is relevant if it's close to the player, or within VisibleDistance and in front of the player's camera.
+*
+* @param Slack, extra distance allowed, used for demotion hysteresis
+*/
+bool AShooterHorde::IsRelevant(const FVector& Position, const FVector& PlayerLocation, const FVector& ViewLocation, const FVector& ViewDirection, float Slack) const {
+	if (FVector::DistSquared(Position, PlayerLocation) < FMath::Square(PromoteDistance + Slack)) {
+		return true;
+	}
+	const FVector ToEntity = Position - ViewLocation;
+	const float DistanceSquared = ToEntity.SizeSquared();
+	return DistanceSquared < FMath::Square(VisibleDistance + Slack)
+		&& FVector::DotProduct(ToEntity, ViewDirection) > VisibleConeCos * FMath::Sqrt(DistanceSquared);
+}
+
+// Spawn a ShooterCharacter for an entity and hand it the entity's health
+void AShooterHorde::PromoteEntity(int32 Index) {
+	const FVector ToPlayer = UGameplayStatics::GetPlayerPawn(this, 0)->GetActorLocation() - Positions[Index];
+	const FTransform SpawnTransform(FRotator(0.f, ToPlayer.Rotation().Yaw, 0.f), Positions[Index]);
+	AShooterCharacter* Character = GetWorld()->SpawnActorDeferred<AShooterCharacter>(
+		ShooterCharacterClass,
+		SpawnTransform,
+		this,
+		nullptr,
+		ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn
+	);
+	if (!Character) return;
+	Character->FinishSpawning(SpawnTransform);
+	// Health gets set to max health in BeginPlay, so carry over the entity's health afterwards
+	Character->GetHealthComponent()->SetHealth(Healths[Index]);
+	if (!Character->GetController()) {
+		Character->SpawnDefaultController();
+	}
+
+	Actors[Index] = Character;
+	States[Index] = EHordeEntityState::Promoted;
+	PromotedIndices.Add(Index);
+}
+
+// Write a promoted entity's state back to the arrays and remove its actors
+void AShooterHorde::DemoteEntity(int32 Index) {
+	AShooterCharacter* Character = Actors[Index];
+	Healths[Index] = Character->GetHealthComponent()->GetHealth();
+	Positions[Index] = Character->GetActorLocation();
+	// Destroys the AI controller along with the character, the weapon goes in the character's EndPlay
+	Character->DetachFromControllerPendingDestroy();
+	Character->Destroy();
+
+	Actors[Index] = nullptr;
+	States[Index] = EHordeEntityState::Advancing;
+}
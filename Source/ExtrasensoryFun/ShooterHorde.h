@@ -0,0 +1,115 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ShooterHorde.generated.h"
+
+class AShooterCharacter;
+
+// State of a single horde entity
+UENUM()
+enum class EHordeEntityState : uint8 {
+	Idle,		// Waiting far away from the player
+	Advancing,	// Moving towards the player as data only
+	Promoted,	// Represented by a full ShooterCharacter
+	Dead
+};
+
+/**
+ * Simulates large numbers of far-away shooter enemies as plain data.
+ * Positions, health and states are stored in flat arrays and processed in batches every frame.
+ * Entities close to or visible by the player are promoted to full ShooterCharacters,
+ * and demoted back to data once they leave range. Health carries over both ways.
+ * Data-only entities don't take damage, only promoted ones can be hit.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API AShooterHorde : public AActor {
+	GENERATED_BODY()
+
+public:
+	// Default constructor
+	AShooterHorde();
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+	// Called when the horde is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	// Remove the promoted actors and scatter all entities again with full health
+	void ResetEntities();
+
+	// Getter methods
+	int32 GetEntityCount() const { return Positions.Num(); }
+	int32 GetPromotedCount() const { return PromotedIndices.Num(); }
+
+	// Setter method, for hordes spawned from code
+	void SetShooterCharacterClass(TSubclassOf<AShooterCharacter> InShooterCharacterClass) { ShooterCharacterClass = InShooterCharacterClass; }
+
+private:
+	// -----Horde properties-----
+	// Class used for promoted entities
+	UPROPERTY(EditAnywhere, Category = "Horde")
+	TSubclassOf<AShooterCharacter> ShooterCharacterClass;
+	UPROPERTY(EditAnywhere, Category = "Horde")
+	int32 EntityCount = 2000;
+	// Entities get scattered within this radius around the horde actor
+	UPROPERTY(EditAnywhere, Category = "Horde")
+	float SpawnRadius = 20000.f;
+	// Speed at which advancing entities move towards the player
+	UPROPERTY(EditAnywhere, Category = "Horde")
+	float MoveSpeed = 300.f;
+	// Entities start advancing when the player gets within this distance
+	UPROPERTY(EditAnywhere, Category = "Horde")
+	float AggroDistance = 8000.f;
+
+	// -----Promotion properties-----
+	// Entities within this distance get promoted
+	UPROPERTY(EditAnywhere, Category = "Promotion")
+	float PromoteDistance = 3000.f;
+	// Entities within this distance and in front of the player's camera get promoted
+	UPROPERTY(EditAnywhere, Category = "Promotion")
+	float VisibleDistance = 5000.f;
+	// Cosine of the half-angle of the view cone used for visibility
+	UPROPERTY(EditAnywhere, Category = "Promotion")
+	float VisibleConeCos = 0.7f;
+	// Extra distance before demoting, so entities don't flicker between representations
+	UPROPERTY(EditAnywhere, Category = "Promotion")
+	float DemoteHysteresis = 1000.f;
+	UPROPERTY(EditAnywhere, Category = "Promotion")
+	int32 MaxPromoted = 30;
+	// Spreads the cost of spawning actors over several frames
+	UPROPERTY(EditAnywhere, Category = "Promotion")
+	int32 MaxPromotionsPerFrame = 2;
+
+	// -----Entity data-----
+	TArray<FVector> Positions;
+	TArray<float> Healths;
+	TArray<EHordeEntityState> States;
+	// Actor for each entity, only set while promoted
+	UPROPERTY()
+	TArray<AShooterCharacter*> Actors;
+	// Indices of the currently promoted entities
+	TArray<int32> PromotedIndices;
+	// Scratch list of entities to promote this frame, kept to avoid reallocating
+	TArray<int32> PromotionCandidates;
+
+	// Max health of the promoted class' health component, so entities start with what a character would
+	float GetEntityMaxHealth() const;
+
+	// -----Processors-----
+	void ProcessMovement(float DeltaTime, const FVector& PlayerLocation);
+	void ProcessPromoted(const FVector& PlayerLocation, const FVector& ViewLocation, const FVector& ViewDirection);
+	void ProcessPromotionCandidates(const FVector& PlayerLocation, const FVector& ViewLocation, const FVector& ViewDirection);
+	bool IsRelevant(const FVector& Position, const FVector& PlayerLocation, const FVector& ViewLocation, const FVector& ViewDirection, float Slack) const;
+
+	// Swap an entity's representation
+	void PromoteEntity(int32 Index);
+	void DemoteEntity(int32 Index);
+};
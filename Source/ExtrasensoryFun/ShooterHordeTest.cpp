@@ -0,0 +1,94 @@
+// by Jason Hilani
+
+
+#include "ShooterHorde.h"
+#include "ShooterCharacter.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/AutomationCommon.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace {
+	constexpr int32 NumTimedFrames = 300;
+	constexpr float FrameDeltaTime = 1.f / 60.f;
+	constexpr double BudgetMs = 8.0;
+
+	struct FHordeBenchmarkData {
+		TWeakObjectPtr<AShooterHorde> Horde;
+		TArray<double> TickMs;
+		int32 PeakPromoted = 0;
+	};
+}
+
+// Spawn a horde around the player, its tick is driven by the benchmark so only the horde gets timed
+DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FSpawnBenchmarkHorde, FAutomationTestBase*, Test, TSharedRef<FHordeBenchmarkData>, Data);
+bool FSpawnBenchmarkHorde::Update() {
+	UWorld* World = AutomationCommon::GetAnyGameWorld();
+	APawn* PlayerPawn = World ? UGameplayStatics::GetPlayerPawn(World, 0) : nullptr;
+	UClass* EnemyClass = LoadClass<AShooterCharacter>(nullptr, TEXT("/Game/Characters/ShooterCharacter/BP_RocketShooterCharacter.BP_RocketShooterCharacter_C"));
+	if (!Test->TestNotNull(TEXT("Player pawn"), PlayerPawn) || !Test->TestNotNull(TEXT("Enemy class"), EnemyClass)) {
+		return true;
+	}
+
+	const FTransform SpawnTransform(PlayerPawn->GetActorLocation());
+	AShooterHorde* Horde = World->SpawnActorDeferred<AShooterHorde>(AShooterHorde::StaticClass(), SpawnTransform);
+	if (!Test->TestNotNull(TEXT("Horde"), Horde)) return true;
+	// Set before BeginPlay, which scatters the entities with the class' max health
+	Horde->SetShooterCharacterClass(EnemyClass);
+	Horde->FinishSpawning(SpawnTransform);
+	Horde->SetActorTickEnabled(false);
+	Test->TestEqual(TEXT("Entities"), Horde->GetEntityCount(), 2000);
+	Data->Horde = Horde;
+	return true;
+}
+
+// Tick the horde once per frame and time it, promotions and demotions included
+DEFINE_LATENT_AUTOMATION_COMMAND_ONE_PARAMETER(FTimeHordeTicks, TSharedRef<FHordeBenchmarkData>, Data);
+bool FTimeHordeTicks::Update() {
+	AShooterHorde* Horde = Data->Horde.Get();
+	if (!Horde) return true;
+
+	const double StartTime = FPlatformTime::Seconds();
+	Horde->Tick(FrameDeltaTime);
+	Data->TickMs.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+	Data->PeakPromoted = FMath::Max(Data->PeakPromoted, Horde->GetPromotedCount());
+	return Data->TickMs.Num() >= NumTimedFrames;
+}
+
+// Check the worst tick against the budget, then remove the horde and its promoted characters
+DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FCheckHordeTimings, FAutomationTestBase*, Test, TSharedRef<FHordeBenchmarkData>, Data);
+bool FCheckHordeTimings::Update() {
+	double TotalMs = 0.0;
+	double WorstMs = 0.0;
+	for (double TickMs : Data->TickMs) {
+		TotalMs += TickMs;
+		WorstMs = FMath::Max(WorstMs, TickMs);
+	}
+	const double AverageMs = TotalMs / FMath::Max(Data->TickMs.Num(), 1);
+	Test->AddInfo(FString::Printf(TEXT("2000 horde entities over %d frames: average %.3f ms, worst %.3f ms, %d promoted at most"), Data->TickMs.Num(), AverageMs, WorstMs, Data->PeakPromoted));
+	Test->TestTrue(FString::Printf(TEXT("Horde tick under %.0f ms"), BudgetMs), Data->TickMs.Num() > 0 && WorstMs < BudgetMs);
+
+	if (AShooterHorde* Horde = Data->Horde.Get()) {
+		Horde->Destroy();
+	}
+	return true;
+}
+
+/**
+ * Times the horde's game thread cost with its 2000 default entities scattered around the player on Main, and fails past 8 ms.
+ * Meant for headless runs, e.g. ExtrasensoryFun -nullrhi -ExecCmds="Automation RunTests ExtrasensoryFun.ShooterHorde;Quit"
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FShooterHordeBenchmarkTest, "ExtrasensoryFun.ShooterHorde.Benchmark",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+bool FShooterHordeBenchmarkTest::RunTest(const FString& Parameters) {
+	TSharedRef<FHordeBenchmarkData> Data = MakeShared<FHordeBenchmarkData>();
+	AutomationOpenMap(TEXT("/Game/Main"));
+	ADD_LATENT_AUTOMATION_COMMAND(FSpawnBenchmarkHorde(this, Data));
+	ADD_LATENT_AUTOMATION_COMMAND(FTimeHordeTicks(Data));
+	ADD_LATENT_AUTOMATION_COMMAND(FCheckHordeTimings(this, Data));
+	return true;
+}
+
+#endif
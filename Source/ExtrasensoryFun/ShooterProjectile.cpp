@@ -6,24 +6,28 @@
 #include "Kismet/GameplayStatics.h"
 #include "ShooterWeapon.h"
 #include "Particles/ParticleSystemComponent.h"
+#include "FireTokenSubsystem.h"
+#include "CollisionProfiles.h"
+#include "SoftAssets.h"
+#include "ExtrasensoryFunStats.h"
+#include "ExtrasensoryFunLLM.h"
+
+DECLARE_CYCLE_STAT(TEXT("Projectile Hit"), STAT_ProjectileHit, STATGROUP_ExtrasensoryFun);
 
 // Default constructor
 AShooterProjectile::AShooterProjectile() {
 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
+	LLM_SCOPE_BYTAG(ExtrasensoryFun_Projectiles);
 	//Create projectile mesh, make it the root, and set it collision settings
 	ProjectileMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Projectile Mesh"));
 	RootComponent = ProjectileMesh;
 	ProjectileMesh->SetNotifyRigidBodyCollision(true);
 	ProjectileMesh->SetAllUseCCD(true);
 	ProjectileMesh->bTraceComplexOnMove = true;
-	ProjectileMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-	ProjectileMesh->SetCollisionResponseToChannel(ECC_GameTraceChannel1, ECR_Overlap);
-	ProjectileMesh->SetCollisionResponseToChannel(ECC_Camera, ECR_Overlap);
-	ProjectileMesh->SetCollisionResponseToChannel(ECC_WorldStatic, ECR_Block);
-	ProjectileMesh->SetCollisionResponseToChannel(ECC_WorldDynamic, ECR_Block);
-	ProjectileMesh->SetCollisionResponseToChannel(ECC_Pawn, ECR_Block);
+	// Blocks everything, overlaps the Telekinesis and camera channels
+	ProjectileMesh->SetCollisionProfileName(CollisionProfiles::Grabbable);
 
 	//Create projectile movement component and set properties
 	MovementComp = CreateDefaultSubobject<UProjectileMovementComponent>(TEXT("Projectile Movement Component"));
@@ -43,9 +47,23 @@ void AShooterProjectile::BeginPlay() {
 
 	// Add function to delegate
 	ProjectileMesh->OnComponentHit.AddDynamic(this, &AShooterProjectile::OnHit);
-	if (LaunchSound) {
-		UGameplayStatics::PlaySoundAtLocation(this, LaunchSound, GetActorLocation());
+	if (!LaunchSound.IsNull()) {
+		UGameplayStatics::PlaySoundAtLocation(this, SoftAssets::Get(LaunchSound), GetActorLocation());
+	}
+	// Keep count of the live projectiles
+	INC_DWORD_STAT(STAT_ProjectilesAlive);
+	if (UFireTokenSubsystem* FireTokens = GetWorld()->GetSubsystem<UFireTokenSubsystem>()) {
+		FireTokens->OnProjectileSpawned();
+	}
+}
+
+// Called when the projectile is removed from the world
+void AShooterProjectile::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	DEC_DWORD_STAT(STAT_ProjectilesAlive);
+	if (UFireTokenSubsystem* FireTokens = GetWorld()->GetSubsystem<UFireTokenSubsystem>()) {
+		FireTokens->OnProjectileDestroyed();
 	}
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -54,8 +72,9 @@ void AShooterProjectile::Tick(float DeltaTime) {
 
 }
 
-// On hit, apply damage event and destroy the projectile
+// On hit, apply damage event unless cosmetic and destroy the projectile
 void AShooterProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit) {
+	EF_SCOPE_CYCLE_COUNTER(STAT_ProjectileHit);
 	AActor* MyOwner = GetOwner();
 	AController* MyOwnerInstigator;
 	MyOwnerInstigator = GetOwner()->GetInstigatorController();
@@ -64,17 +83,20 @@ void AShooterProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor,
 	if (OtherActor && OtherActor != this && OtherActor != MyOwner && OtherActor != MyOwnerInstigator) {
 		//DrawDebugSphere(GetWorld(), Hit.ImpactPoint, ExplosionRadius, 20, FColor::Red, false, 3.f);
 		// If there's an explosion radius, apply radial damage, otherwise apply regular damage
-		if (ExplosionRadius > 0) {
+		if (bCosmetic) {
+			// The server's projectile applies the damage
+		} else if (ExplosionRadius > 0) {
 			UGameplayStatics::ApplyRadialDamage(this, Damage, Hit.ImpactPoint, ExplosionRadius, DamageTypeClass, TArray<AActor*>(), this, MyOwnerInstigator);
 		} else {
 			UGameplayStatics::ApplyDamage(OtherActor, Damage, MyOwnerInstigator, this, DamageTypeClass);
 		}
 		// Play explosion FX if there is one
-		if (ExplosionFX) {
-			UGameplayStatics::SpawnEmitterAtLocation(this, ExplosionFX, Hit.ImpactPoint, GetActorRotation());
+		if (UParticleSystem* Explosion = SoftAssets::Get(ExplosionFX)) {
+			LLM_SCOPE_BYTAG(ExtrasensoryFun_FX);
+			UGameplayStatics::SpawnEmitterAtLocation(this, Explosion, Hit.ImpactPoint, GetActorRotation());
 		}
-		if (HitSound) {
-			UGameplayStatics::PlaySoundAtLocation(this, HitSound, GetActorLocation());
+		if (!HitSound.IsNull()) {
+			UGameplayStatics::PlaySoundAtLocation(this, SoftAssets::Get(HitSound), GetActorLocation());
 		}
 	}
 	// Destroy projectile
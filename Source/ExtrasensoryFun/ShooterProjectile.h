@@ -19,6 +19,8 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	// Called when the projectile is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
 	// Called every frame
@@ -29,6 +31,8 @@ public:
 	UProjectileMovementComponent* GetMovementComp() { return MovementComp; }
 	UParticleSystemComponent* GetTrailFX() { return TrailFX; }
 	float GetDamage() const { return Damage; }
+	bool IsCosmetic() const { return bCosmetic; }
+	void SetCosmetic(bool bNewCosmetic) { bCosmetic = bNewCosmetic; }
 	
 private:
 	//-----Projectile properties and components-----
@@ -41,7 +45,7 @@ private:
 	UPROPERTY(VisibleAnywhere, Category = "Particles")
 	UParticleSystemComponent* TrailFX;
 	UPROPERTY(VisibleAnywhere, Category = "Particles")
-	UParticleSystem* ExplosionFX;
+	TSoftObjectPtr<UParticleSystem> ExplosionFX;
 	// Combat properties
 	UPROPERTY(EditAnywhere, Category = "Combat")
 	float Damage = 100.f;
@@ -49,9 +53,11 @@ private:
 	float ExplosionRadius = 300.f;
 	// Sounds
 	UPROPERTY(EditAnywhere, Category = "Combat")
-	USoundBase* LaunchSound;
+	TSoftObjectPtr<USoundBase> LaunchSound;
 	UPROPERTY(EditAnywhere, Category = "Combat")
-	USoundBase* HitSound;
+	TSoftObjectPtr<USoundBase> HitSound;
+	// Client copy of a server projectile, spawned from the shooter's multicast, which only plays FX on hit
+	bool bCosmetic = false;
 
 	// OnHit event
 	UFUNCTION()
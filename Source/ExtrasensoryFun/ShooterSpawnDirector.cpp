@@ -0,0 +1,224 @@
+// by Jason Hilani
+
+
+#include "ShooterSpawnDirector.h"
+#include "ShooterCharacter.h"
+#include "ShooterWeapon.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "EngineUtils.h"
+#include "Misc/App.h"
+
+// Default constructor
+AShooterSpawnDirector::AShooterSpawnDirector() {
+	// Set this actor to call Tick() every frame.
+	PrimaryActorTick.bCanEverTick = true;
+
+	// Root component to place the director in the level
+	SetRootComponent(CreateDefaultSubobject<USceneComponent>(TEXT("Root")));
+}
+
+// Called when the game starts or when spawned
+void AShooterSpawnDirector::BeginPlay() {
+	Super::BeginPlay();
+
+	FreeCharacters.Reserve(PoolSize);
+	ActiveCharacters.Reserve(PoolSize);
+}
+
+// The pooled characters are spawned in the persistent level, so take them with the director when it goes away or its level streams out
+void AShooterSpawnDirector::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (EndPlayReason == EEndPlayReason::Destroyed || EndPlayReason == EEndPlayReason::RemovedFromWorld) {
+		for (AShooterCharacter* Character : FreeCharacters) {
+			if (Character) {
+				Character->DetachFromControllerPendingDestroy();
+				Character->Destroy();
+			}
+		}
+		for (AShooterCharacter* Character : ActiveCharacters) {
+			if (Character) {
+				Character->DetachFromControllerPendingDestroy();
+				Character->Destroy();
+			}
+		}
+		FreeCharacters.Reset();
+		ActiveCharacters.Reset();
+		PendingActivations = 0;
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+// Called every frame
+void AShooterSpawnDirector::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	// Keep filling the pool a few characters at a time
+	for (int32 i = 0; i < PrewarmPerFrame && NumPrewarmed < PoolSize; i++) {
+		PrewarmCharacter();
+	}
+
+	// Record the frame times for as long as the wave is spawning, plus the frame after the last activation
+	if (WaveSize > 0) {
+		const float FrameTime = FApp::GetDeltaTime();
+		WaveWorstFrameTime = FMath::Max(WaveWorstFrameTime, FrameTime);
+		WaveTotalFrameTime += FrameTime;
+		WaveFrames++;
+		if (PendingActivations == 0) {
+			UE_LOG(LogTemp, Display, TEXT("%s: wave of %d spawned over %d frames, worst frame %.2f ms, average frame %.2f ms"),
+				*GetName(), WaveSize, WaveFrames, WaveWorstFrameTime * 1000.f, WaveTotalFrameTime * 1000.f / WaveFrames);
+			WaveSize = 0;
+		}
+	}
+
+	// Activate queued characters, capped per frame
+	for (int32 i = 0; i < ActivationsPerFrame && PendingActivations > 0 && FreeCharacters.Num() > 0; i++) {
+		ActivateCharacter(FreeCharacters.Pop(false), GetNextSpawnTransform());
+		PendingActivations--;
+	}
+}
+
+// Queue Count enemies to be activated over the next frames
+void AShooterSpawnDirector::StartWave(int32 Count) {
+	// Can't activate more than the pool will ever hold
+	const int32 Requested = PendingActivations + Count;
+	PendingActivations = FMath::Min(Requested, PoolSize - ActiveCharacters.Num());
+	if (PendingActivations < Requested) {
+		UE_LOG(LogTemp, Warning, TEXT("%s: wave of %d capped to %d by the pool size (%d)"), *GetName(), Requested, PendingActivations, PoolSize);
+	}
+	WaveSize = PendingActivations;
+	WaveFrames = 0;
+	WaveWorstFrameTime = 0.f;
+	WaveTotalFrameTime = 0.f;
+}
+
+// Called by pooled characters when they die, leave the corpse for a while before reusing it
+void AShooterSpawnDirector::OnPooledCharacterDied(AShooterCharacter* Character) {
+	GetWorldTimerManager().SetTimer(
+		CorpseTimers.FindOrAdd(Character),
+		FTimerDelegate::CreateUObject(this, &AShooterSpawnDirector::ReturnToPool, TWeakObjectPtr<AShooterCharacter>(Character)),
+		CorpseTime,
+		false
+	);
+}
+
+// Put every active character back into the pool
+void AShooterSpawnDirector::ReturnAllToPool() {
+	// Pending corpse timers would put the characters back in the pool a second time, possibly after they were reused
+	for (TPair<TObjectKey<AShooterCharacter>, FTimerHandle>& CorpseTimer : CorpseTimers) {
+		GetWorldTimerManager().ClearTimer(CorpseTimer.Value);
+	}
+	CorpseTimers.Reset();
+	for (AShooterCharacter* Character : ActiveCharacters) {
+		if (Character) {
+			DeactivateCharacter(Character);
+			FreeCharacters.Add(Character);
+		}
+	}
+	ActiveCharacters.Reset();
+	PendingActivations = 0;
+	WaveSize = 0;
+}
+
+// Spawn a character along with its controller and weapon, then put it straight into the pool
+void AShooterSpawnDirector::PrewarmCharacter() {
+	NumPrewarmed++;
+	if (!ShooterCharacterClass) return;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AShooterCharacter* Character = GetWorld()->SpawnActor<AShooterCharacter>(ShooterCharacterClass, GetActorTransform(), SpawnParams);
+	if (!Character) return;
+	if (!Character->GetController()) {
+		Character->SpawnDefaultController();
+	}
+	Character->SetSpawnDirector(this);
+	DeactivateCharacter(Character);
+	FreeCharacters.Add(Character);
+}
+
+// Wake a pooled character up at SpawnTransform
+void AShooterSpawnDirector::ActivateCharacter(AShooterCharacter* Character, const FTransform& SpawnTransform) {
+	ClearCorpseTimer(Character);
+	Character->TeleportTo(SpawnTransform.GetLocation(), SpawnTransform.Rotator(), false, true);
+	Character->Revive();
+	Character->SetActorHiddenInGame(false);
+	Character->SetActorEnableCollision(true);
+	Character->SetActorTickEnabled(true);
+	Character->GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+	if (AShooterWeapon* Weapon = Character->GetShooterWeapon()) {
+		Weapon->SetActorHiddenInGame(false);
+	}
+	// Restart the behaviour tree from the new start location
+	if (AAIController* AIController = Cast<AAIController>(Character->GetController())) {
+		if (UBlackboardComponent* Blackboard = AIController->GetBlackboardComponent()) {
+			Blackboard->SetValueAsVector(TEXT("StartLocation"), SpawnTransform.GetLocation());
+			Blackboard->SetValueAsRotator(TEXT("StartRotation"), SpawnTransform.Rotator());
+		}
+		if (UBrainComponent* Brain = AIController->GetBrainComponent()) {
+			Brain->RestartLogic();
+		}
+	}
+	ActiveCharacters.Add(Character);
+}
+
+// Put a character to sleep: hidden, without collision, tick, movement or AI logic
+void AShooterSpawnDirector::DeactivateCharacter(AShooterCharacter* Character) {
+	Character->SetActorHiddenInGame(true);
+	Character->SetActorEnableCollision(false);
+	Character->SetActorTickEnabled(false);
+	Character->GetCharacterMovement()->StopMovementImmediately();
+	Character->GetCharacterMovement()->DisableMovement();
+	if (AShooterWeapon* Weapon = Character->GetShooterWeapon()) {
+		Weapon->SetActorHiddenInGame(true);
+	}
+	if (AAIController* AIController = Cast<AAIController>(Character->GetController())) {
+		AIController->StopMovement();
+		if (UBrainComponent* Brain = AIController->GetBrainComponent()) {
+			Brain->StopLogic(TEXT("Pooled"));
+		}
+	}
+	Character->SetActorLocation(GetActorLocation());
+}
+
+// Move a dead character from the active list back into the pool
+void AShooterSpawnDirector::ReturnToPool(TWeakObjectPtr<AShooterCharacter> Character) {
+	CorpseTimers.Remove(Character.Get());
+	if (Character.IsValid() && ActiveCharacters.RemoveSwap(Character.Get()) > 0) {
+		DeactivateCharacter(Character.Get());
+		FreeCharacters.Add(Character.Get());
+	}
+}
+
+// Stop a character's corpse timer, so it can't send the character back to the pool once it's active again
+void AShooterSpawnDirector::ClearCorpseTimer(AShooterCharacter* Character) {
+	FTimerHandle CorpseTimer;
+	if (CorpseTimers.RemoveAndCopyValue(Character, CorpseTimer)) {
+		GetWorldTimerManager().ClearTimer(CorpseTimer);
+	}
+}
+
+// Cycle through the spawn points, or pick a random point around the director
+FTransform AShooterSpawnDirector::GetNextSpawnTransform() {
+	if (SpawnPoints.Num() > 0) {
+		AActor* SpawnPoint = SpawnPoints[NextSpawnPoint++ % SpawnPoints.Num()];
+		if (SpawnPoint) {
+			return SpawnPoint->GetActorTransform();
+		}
+	}
+	const FVector2D Offset = FMath::RandPointInCircle(SpawnRadius);
+	return FTransform(GetActorRotation(), GetActorLocation() + FVector(Offset.X, Offset.Y, 0.f));
+}
+
+// Console command to benchmark a spawn burst from every director in the world
+static FAutoConsoleCommandWithWorldAndArgs SpawnWaveCommand(
+	TEXT("ef.SpawnWave"),
+	TEXT("Spawns a wave from every spawn director and logs the worst frame time while it spawns. Each director stops at its PoolSize (50 by default). Usage: ef.SpawnWave [Count=50]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World) {
+		const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 50;
+		for (TActorIterator<AShooterSpawnDirector> It(World); It; ++It) {
+			It->StartWave(Count);
+		}
+	})
+);
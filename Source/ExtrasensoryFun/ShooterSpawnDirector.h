@@ -0,0 +1,94 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ShooterSpawnDirector.generated.h"
+
+class AShooterCharacter;
+
+/**
+ * Spawns waves of shooter enemies from a pre-warmed pool.
+ * Each pooled character comes with its controller and weapon already spawned, so activating one
+ * is only a teleport and a few state changes. Activations are capped per frame to avoid hitches,
+ * and dead characters go back to the pool instead of staying in the world.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API AShooterSpawnDirector : public AActor {
+	GENERATED_BODY()
+
+public:
+	// Default constructor
+	AShooterSpawnDirector();
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	// Queue Count enemies to be activated over the next frames
+	UFUNCTION(BlueprintCallable)
+	void StartWave(int32 Count);
+
+	// Called by pooled characters when they die
+	void OnPooledCharacterDied(AShooterCharacter* Character);
+
+	// Put every active character back into the pool
+	void ReturnAllToPool();
+
+	// Getter methods
+	int32 GetActiveCount() const { return ActiveCharacters.Num(); }
+	int32 GetPooledCount() const { return FreeCharacters.Num(); }
+
+private:
+	// -----Pool properties-----
+	UPROPERTY(EditAnywhere, Category = "Pool")
+	TSubclassOf<AShooterCharacter> ShooterCharacterClass;
+	UPROPERTY(EditAnywhere, Category = "Pool")
+	int32 PoolSize = 50;
+	// Pre-warming is spread over several frames as well
+	UPROPERTY(EditAnywhere, Category = "Pool")
+	int32 PrewarmPerFrame = 5;
+	UPROPERTY(EditAnywhere, Category = "Pool")
+	int32 ActivationsPerFrame = 2;
+	// How long dead characters stay in the world before going back to the pool
+	UPROPERTY(EditAnywhere, Category = "Pool")
+	float CorpseTime = 5.f;
+
+	// -----Spawn locations-----
+	// Enemies are spawned at these actors in turn, or around the director if there are none
+	UPROPERTY(EditInstanceOnly, Category = "Spawning")
+	TArray<AActor*> SpawnPoints;
+	UPROPERTY(EditAnywhere, Category = "Spawning")
+	float SpawnRadius = 1500.f;
+	int32 NextSpawnPoint = 0;
+
+	// -----Pool-----
+	UPROPERTY()
+	TArray<AShooterCharacter*> FreeCharacters;
+	UPROPERTY()
+	TArray<AShooterCharacter*> ActiveCharacters;
+	int32 PendingActivations = 0;
+	int32 NumPrewarmed = 0;
+	// Corpse timers of the dead characters, cleared when a character is reused before its timer fires
+	TMap<TObjectKey<AShooterCharacter>, FTimerHandle> CorpseTimers;
+	void ClearCorpseTimer(AShooterCharacter* Character);
+
+	void PrewarmCharacter();
+	void ActivateCharacter(AShooterCharacter* Character, const FTransform& SpawnTransform);
+	void DeactivateCharacter(AShooterCharacter* Character);
+	void ReturnToPool(TWeakObjectPtr<AShooterCharacter> Character);
+	FTransform GetNextSpawnTransform();
+
+	// -----Wave benchmark-----
+	// Worst frame time from the start of a wave until it's fully spawned
+	int32 WaveSize = 0;
+	int32 WaveFrames = 0;
+	float WaveWorstFrameTime = 0.f;
+	float WaveTotalFrameTime = 0.f;
+};
@@ -3,7 +3,14 @@
 
 #include "ShooterWeapon.h"
 #include "ShooterProjectile.h"
+#include "ShooterCharacter.h"
 #include <Kismet/GameplayStatics.h>
+#include "GameplayEventLog.h"
+#include "ExtrasensoryFunStats.h"
+#include "ExtrasensoryFunLLM.h"
+#include "SoftAssets.h"
+
+DECLARE_CYCLE_STAT(TEXT("Fire Weapon"), STAT_FireWeapon, STATGROUP_ExtrasensoryFun);
 
 // Default constructor
 AShooterWeapon::AShooterWeapon() {
@@ -22,6 +29,7 @@ AShooterWeapon::AShooterWeapon() {
 
 // Spawn/shoot projectile
 void AShooterWeapon::FireWeapon() {
+	EF_SCOPE_CYCLE_COUNTER(STAT_FireWeapon);
 	if (AController* OwnerController = GetOwnerController()) {
 		// Get shot direction from player's viewpoint's rotation
 		FVector Location;
@@ -30,19 +38,38 @@ void AShooterWeapon::FireWeapon() {
 		// Use weapon's Projectile Socket as the spawn location
 		FVector ProjectileSpawnPoint = WeaponMesh->GetSocketLocation("ProjectileSocket");
 
-		// Spawn projectile and set properties
-		AShooterProjectile* Projectile = GetWorld()->SpawnActor<AShooterProjectile>(ShooterProjectileClass, ProjectileSpawnPoint, ShotDirection);
-		Projectile->SetOwner(this);
-		if (Projectile->GetMesh()->GetStaticMesh()->GetName() == "ammo_rocket") {
-			Projectile->SetActorRelativeRotation(ShotDirection + FRotator(-90.f, 0.f, -90.f)); // Add FRotator because of the character's, weapon's and projectile's rotations 
-		} else {
-			Projectile->SetActorRelativeRotation(ShotDirection + FRotator(-90.f, 0.f, 0.f)); // Add that FRotator because of the character's, weapon's and projectile's rotations 
-		}
-		
-		// Play FX
-		if (MuzzleFlash) {
-			UGameplayStatics::SpawnEmitterAttached(MuzzleFlash, WeaponMesh, TEXT("MuzzleFlashSocket"));
+		SpawnProjectile(ProjectileSpawnPoint, ShotDirection, false);
+
+		// Projectiles aren't replicated, clients spawn their own copy from the spawn parameters
+		if (GetNetMode() == NM_DedicatedServer || GetNetMode() == NM_ListenServer) {
+			if (AShooterCharacter* Shooter = Cast<AShooterCharacter>(GetOwner())) {
+				Shooter->MulticastFireWeapon(ProjectileSpawnPoint, ShotDirection);
+			}
 		}
 	}
 }
 
+// Spawn a projectile and play the muzzle flash, cosmetic projectiles don't apply damage
+void AShooterWeapon::SpawnProjectile(const FVector& Location, const FRotator& ShotDirection, bool bCosmetic) {
+	// Spawn projectile and set properties
+	LLM_SCOPE_BYTAG(ExtrasensoryFun_Projectiles);
+	AShooterProjectile* Projectile = GetWorld()->SpawnActor<AShooterProjectile>(SoftAssets::GetClass(ShooterProjectileClass), Location, ShotDirection);
+	if (!Projectile) return;
+	Projectile->SetOwner(this);
+	Projectile->SetCosmetic(bCosmetic);
+	if (!bCosmetic) {
+		FGameplayEventLog::Get().Push(EGameplayEventType::Shot, GetOwner(), Projectile);
+	}
+	if (Projectile->GetMesh()->GetStaticMesh()->GetName() == "ammo_rocket") {
+		Projectile->SetActorRelativeRotation(ShotDirection + FRotator(-90.f, 0.f, -90.f)); // Add FRotator because of the character's, weapon's and projectile's rotations 
+	} else {
+		Projectile->SetActorRelativeRotation(ShotDirection + FRotator(-90.f, 0.f, 0.f)); // Add that FRotator because of the character's, weapon's and projectile's rotations 
+	}
+	
+	// Play FX
+	if (UParticleSystem* Flash = SoftAssets::Get(MuzzleFlash)) {
+		LLM_SCOPE_BYTAG(ExtrasensoryFun_FX);
+		UGameplayStatics::SpawnEmitterAttached(Flash, WeaponMesh, TEXT("MuzzleFlashSocket"));
+	}
+}
+
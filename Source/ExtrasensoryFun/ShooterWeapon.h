@@ -23,6 +23,8 @@ public:
 
 	// Spawn/shoot projectile
 	void FireWeapon();
+	// Spawn a projectile and play the muzzle flash, cosmetic projectiles don't apply damage
+	void SpawnProjectile(const FVector& Location, const FRotator& ShotDirection, bool bCosmetic);
 
 	// Getter methods
 	UStaticMeshComponent* GetWeaponMesh() { return WeaponMesh; }
@@ -35,10 +37,10 @@ private:
 	UPROPERTY(VisibleAnywhere)
 	UStaticMeshComponent* WeaponMesh;
 	UPROPERTY(EditAnywhere)
-	UParticleSystem* MuzzleFlash;
+	TSoftObjectPtr<UParticleSystem> MuzzleFlash;
 
 	// Projectile class
 	UPROPERTY(EditDefaultsOnly)
-	TSubclassOf<AShooterProjectile> ShooterProjectileClass;
+	TSoftClassPtr<AShooterProjectile> ShooterProjectileClass;
 	
 };
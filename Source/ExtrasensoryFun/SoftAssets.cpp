@@ -0,0 +1,119 @@
+// by Jason Hilani
+
+
+#include "SoftAssets.h"
+#include "Engine/AssetManager.h"
+#include "UObject/UnrealType.h"
+
+namespace SoftAssets {
+	namespace {
+		// Every path requested so far, they're only requested once
+		TSet<FSoftObjectPath> Requested;
+		int32 NumPending = 0;
+
+		// -----Stats-----
+		int32 Requests = 0;
+		int32 Fallbacks = 0;
+		int32 SynchronousLoads = 0;
+		// Assets that were needed before they were loaded, and how many times
+		TMap<FSoftObjectPath, int32> FallbackCounts;
+
+		// Count the request as pending until its delegate runs
+		FStreamableDelegate TrackPending(FStreamableDelegate Delegate) {
+			NumPending++;
+			return FStreamableDelegate::CreateLambda([Delegate = MoveTemp(Delegate)]() {
+				NumPending--;
+				Delegate.ExecuteIfBound();
+			});
+		}
+	}
+
+	// Start loading an asset in the background, once
+	void RequestAsyncLoad(const FSoftObjectPath& Path, FStreamableDelegate Delegate) {
+		if (Path.IsNull()) return;
+		bool bAlreadyRequested = false;
+		Requested.Add(Path, &bAlreadyRequested);
+		if (bAlreadyRequested) return;
+		Requests++;
+		// The streamable manager keeps the handle, and with it the asset
+		UAssetManager::GetStreamableManager().RequestAsyncLoad(Path, TrackPending(MoveTemp(Delegate)), FStreamableManager::DefaultAsyncLoadPriority, true);
+	}
+
+	// Load the assets in the background and call Delegate once they're all in
+	void LoadThen(TArray<FSoftObjectPath> Paths, FStreamableDelegate Delegate) {
+		Paths.RemoveAll([](const FSoftObjectPath& Path) { return Path.IsNull(); });
+		if (Paths.Num() == 0) {
+			Delegate.ExecuteIfBound();
+			return;
+		}
+		for (const FSoftObjectPath& Path : Paths) {
+			bool bAlreadyRequested = false;
+			Requested.Add(Path, &bAlreadyRequested);
+			Requests += bAlreadyRequested ? 0 : 1;
+		}
+		UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(Paths), TrackPending(MoveTemp(Delegate)), FStreamableManager::AsyncLoadHighPriority, true);
+	}
+
+	/**
+	* Request the object's soft object and soft class properties.
+	* Referenced classes have soft references of their own (a weapon's projectile class has FX and sounds),
+	* so their defaults get requested as well once the class is loaded.
+	*/
+	void RequestSoftReferences(const UObject* Object) {
+		for (TFieldIterator<FSoftObjectProperty> It(Object->GetClass()); It; ++It) {
+			const FSoftObjectPath Path = It->GetPropertyValue_InContainer(Object).ToSoftObjectPath();
+			if (Path.IsNull() || Requested.Contains(Path)) continue;
+			if (It->IsA<FSoftClassProperty>()) {
+				RequestAsyncLoad(Path, FStreamableDelegate::CreateLambda([Path]() {
+					if (const UClass* Class = Cast<UClass>(Path.ResolveObject())) {
+						RequestSoftReferences(Class->GetDefaultObject());
+					}
+				}));
+			} else {
+				RequestAsyncLoad(Path);
+			}
+		}
+	}
+
+	int32 GetNumPending() {
+		return NumPending;
+	}
+
+	// Counts an asset that was needed before it was loaded
+	void RecordFallback(const FSoftObjectPath& Path, bool bLoadedSynchronously) {
+		Fallbacks++;
+		FallbackCounts.FindOrAdd(Path)++;
+		if (bLoadedSynchronously) {
+			SynchronousLoads++;
+			UE_LOG(LogTemp, Warning, TEXT("%s was needed before it was loaded, loading it synchronously"), *Path.ToString());
+		}
+	}
+
+	// Log the stats, along with the assets that were needed before being loaded
+	void DumpStats() {
+		UE_LOG(LogTemp, Display, TEXT("Soft assets: %d requested, %d pending, %d fallbacks, %d synchronous loads"),
+			Requests, NumPending, Fallbacks, SynchronousLoads);
+		for (const TPair<FSoftObjectPath, int32>& Fallback : FallbackCounts) {
+			UE_LOG(LogTemp, Display, TEXT("  %s: %d fallbacks"), *Fallback.Key.ToString(), Fallback.Value);
+		}
+	}
+
+	void ResetStats() {
+		Fallbacks = 0;
+		SynchronousLoads = 0;
+		FallbackCounts.Reset();
+	}
+}
+
+// Console commands to read and reset the stats
+static FAutoConsoleCommand SoftAssetsStatsCommand(
+	TEXT("ef.Assets.Stats"),
+	TEXT("Logs the soft asset requests and the assets that were needed before they were loaded."),
+	FConsoleCommandDelegate::CreateStatic(&SoftAssets::DumpStats)
+);
+
+static FAutoConsoleCommand SoftAssetsStatsResetCommand(
+	TEXT("ef.Assets.StatsReset"),
+	TEXT("Resets the soft asset fallback stats."),
+	FConsoleCommandDelegate::CreateStatic(&SoftAssets::ResetStats)
+);
@@ -0,0 +1,53 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+
+/**
+ * Background loading of the game's soft asset references, through the asset manager's streamable manager.
+ * FX, sounds and projectile classes are soft references so loading a character doesn't pull them in synchronously.
+ * They're preloaded from the menu (see UExtrasensoryFunGameInstance), and anything used before it's loaded falls back:
+ * cosmetic assets are skipped until they're in, gameplay classes are loaded right away.
+ * Requested assets stay loaded for the rest of the session.
+ */
+namespace SoftAssets {
+	// Start loading an asset in the background, once, and call Delegate when it's loaded
+	EXTRASENSORYFUN_API void RequestAsyncLoad(const FSoftObjectPath& Path, FStreamableDelegate Delegate = FStreamableDelegate());
+	// Load the assets in the background and call Delegate once they're all in, right away if they already are
+	EXTRASENSORYFUN_API void LoadThen(TArray<FSoftObjectPath> Paths, FStreamableDelegate Delegate);
+	// Request every soft reference of an object, and those of the classes it references once they're loaded
+	EXTRASENSORYFUN_API void RequestSoftReferences(const UObject* Object);
+
+	// Requests that haven't finished loading
+	EXTRASENSORYFUN_API int32 GetNumPending();
+	// Counts an asset that was needed before it was loaded
+	EXTRASENSORYFUN_API void RecordFallback(const FSoftObjectPath& Path, bool bLoadedSynchronously);
+
+	// The asset if it's loaded, otherwise null while it loads in the background
+	template<typename T>
+	T* Get(const TSoftObjectPtr<T>& Asset) {
+		T* Loaded = Asset.Get();
+		if (!Loaded && !Asset.IsNull()) {
+			RecordFallback(Asset.ToSoftObjectPath(), false);
+			RequestAsyncLoad(Asset.ToSoftObjectPath());
+		}
+		return Loaded;
+	}
+
+	// The class, loaded right away if it isn't yet, since gameplay can't skip it
+	template<typename T>
+	TSubclassOf<T> GetClass(const TSoftClassPtr<T>& Class) {
+		TSubclassOf<T> Loaded = Class.Get();
+		if (!Loaded && !Class.IsNull()) {
+			RecordFallback(Class.ToSoftObjectPath(), true);
+			Loaded = Class.LoadSynchronous();
+		}
+		return Loaded;
+	}
+
+	// Log and reset the stats
+	EXTRASENSORYFUN_API void DumpStats();
+	EXTRASENSORYFUN_API void ResetStats();
+}
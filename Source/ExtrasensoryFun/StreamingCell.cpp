@@ -0,0 +1,57 @@
+// by Jason Hilani
+
+
+#include "StreamingCell.h"
+#include "Components/BoxComponent.h"
+#include "Engine/LevelStreamingDynamic.h"
+
+// Default constructor
+AStreamingCell::AStreamingCell() {
+	PrimaryActorTick.bCanEverTick = false;
+
+	// Only used for its bounds, it doesn't collide with anything
+	Bounds = CreateDefaultSubobject<UBoxComponent>(TEXT("Bounds"));
+	SetRootComponent(Bounds);
+	Bounds->SetBoxExtent(FVector(5000.f, 5000.f, 2000.f));
+	Bounds->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Bounds->SetCanEverAffectNavigation(false);
+}
+
+/**
+* The first load creates the level instance. It's named after the cell rather than numbered,
+* so the server and clients agree on its package name.
+*/
+void AStreamingCell::Load() {
+	bWantsLoaded = true;
+	LoadRequestTime = FPlatformTime::Seconds();
+	if (!Streaming) {
+		bool bSuccess = false;
+		Streaming = ULevelStreamingDynamic::LoadLevelInstanceBySoftObjectPtr(this, Level, FVector::ZeroVector, FRotator::ZeroRotator, bSuccess, GetName());
+		if (!bSuccess) {
+			UE_LOG(LogTemp, Error, TEXT("%s: couldn't stream %s"), *GetName(), *Level.ToString());
+		}
+		return;
+	}
+	Streaming->SetShouldBeLoaded(true);
+	Streaming->SetShouldBeVisible(true);
+}
+
+void AStreamingCell::Unload() {
+	bWantsLoaded = false;
+	if (Streaming) {
+		Streaming->SetShouldBeVisible(false);
+		Streaming->SetShouldBeLoaded(false);
+	}
+}
+
+ULevel* AStreamingCell::GetLoadedLevel() const {
+	return Streaming ? Streaming->GetLoadedLevel() : nullptr;
+}
+
+bool AStreamingCell::IsVisible() const {
+	return Streaming && Streaming->IsLevelVisible();
+}
+
+FBox AStreamingCell::GetCellBounds() const {
+	return Bounds->Bounds.GetBox();
+}
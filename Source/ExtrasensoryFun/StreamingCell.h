@@ -0,0 +1,49 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "StreamingCell.generated.h"
+
+class UBoxComponent;
+class ULevelStreamingDynamic;
+
+/**
+ * A cell of the streaming layout, placed in the persistent level.
+ * Its content (props, enemies, effects) lives in its own level, authored in world space inside the cell's bounds,
+ * and is loaded asynchronously as a level instance when a player gets close (see UCellStreamingSubsystem).
+ * Unloaded cells keep their streaming level around so they load again without creating a new one.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API AStreamingCell : public AActor {
+	GENERATED_BODY()
+
+public:
+	// Default constructor
+	AStreamingCell();
+
+	// Start loading and showing the cell's level
+	void Load();
+	// Hide and unload the cell's level
+	void Unload();
+
+	// Whether the cell was asked to be loaded, it may still be loading
+	bool WantsLoaded() const { return bWantsLoaded; }
+	// The cell's level, once loaded
+	ULevel* GetLoadedLevel() const;
+	bool IsVisible() const;
+	FBox GetCellBounds() const;
+	double GetLoadRequestTime() const { return LoadRequestTime; }
+
+private:
+	UPROPERTY(VisibleAnywhere)
+	UBoxComponent* Bounds;
+	UPROPERTY(EditAnywhere, Category = "Streaming")
+	TSoftObjectPtr<UWorld> Level;
+
+	UPROPERTY()
+	ULevelStreamingDynamic* Streaming;
+	bool bWantsLoaded = false;
+	double LoadRequestTime = 0.0;
+};
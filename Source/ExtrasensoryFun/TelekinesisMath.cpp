@@ -0,0 +1,210 @@
+// by Jason Hilani
+
+
+#include "TelekinesisMath.h"
+#include "Math/RandomStream.h"
+
+namespace TelekinesisMath {
+
+/**
+* Set the physics handle target of each grabbed object.
+* Targets are always the relative positions recorded during grabbing, except for the Z axis.
+* With a target, the objects line up in height between the character and the target proportionally to how far forward they are.
+* Without one, they follow the camera's pitch.
+*/
+void ComputeHandleTargets(const FCharacterFrame& Frame, TArrayView<const FVector> CurrentPosFromChar, TArrayView<const FVector> GrabPosFromChar, TArrayView<FVector> OutTargets) {
+	check(CurrentPosFromChar.Num() == GrabPosFromChar.Num() && OutTargets.Num() == GrabPosFromChar.Num());
+
+	if (Frame.bHasTarget) {
+		const FVector& TargetPos = Frame.TargetPosFromChar;
+		for (int32 i = 0; i < GrabPosFromChar.Num(); i++) {
+			// Component's relative position X from the character divided by the Target's
+			const float PosFromCharXRatio = CurrentPosFromChar[i].X / TargetPos.X;
+			// Will become Location's Z axis
+			float CompPosZ = FMath::Clamp(PosFromCharXRatio, PosFromCharXRatio, 1.f) * TargetPos.Z;
+			// CompPosZ calculation changes depending on if it's negative or not
+			if (CompPosZ < 0) {
+				CompPosZ = Frame.Location.Z + 90 - FMath::Clamp<double>(-CompPosZ, TargetPos.Z, Frame.Location.Z);
+			} else {
+				CompPosZ = FMath::Clamp<double>(CompPosZ + 192.f, Frame.Location.Z + 90.f, TargetPos.Z + 192.f);
+			}
+			const FVector Location(Frame.Location.X, Frame.Location.Y, CompPosZ);
+			OutTargets[i] = Location
+				+ Frame.Forward * FMath::Clamp<double>(GrabPosFromChar[i].X, 100, GrabPosFromChar[i].X)
+				+ Frame.Right * GrabPosFromChar[i].Y;
+		}
+	} else {
+		const FVector Location = Frame.Location + FVector(0.f, 0.f, 90.f);
+		const FVector FwdVector(Frame.Forward.X, Frame.Forward.Y, Frame.CameraForward.Z);
+		for (int32 i = 0; i < GrabPosFromChar.Num(); i++) {
+			OutTargets[i] = Location
+				+ FwdVector * FMath::Clamp<double>(GrabPosFromChar[i].X, 100, GrabPosFromChar[i].X)
+				+ Frame.Right * GrabPosFromChar[i].Y;
+		}
+	}
+}
+
+/**
+* Start the sweep from the front of the character instead of within.
+* Without a target, the sweep follows the camera and adds the CapsuleHalfHeight in proportion to how far we aim up or down,
+* so it starts from the top of our head when aiming upwards, from our feet when aiming downwards, and anything in-between.
+* With a target, it's raised or lowered towards the target instead.
+*/
+FSweepSegment ComputeGrabSweep(const FCharacterFrame& Frame, float CapsuleHalfHeight, float GrabRadius, float GrabRange) {
+	FSweepSegment Segment;
+	if (Frame.bHasTarget) {
+		const FVector& TargetPos = Frame.TargetPosFromChar;
+		// GrabRadius divided by Target's Position's X axis
+		const float XRatio = GrabRadius / TargetPos.X;
+		// Will become Location's Z axis
+		float PosZ = FMath::Clamp(XRatio, XRatio, 1.f) * TargetPos.Z;
+		// PosZ calculation changes depending on if it's negative or not
+		if (PosZ < 0) {
+			PosZ = Frame.Location.Z - FMath::Clamp<double>(-PosZ, TargetPos.Z, Frame.Location.Z);
+		} else {
+			PosZ = FMath::Clamp<double>(PosZ, Frame.Location.Z, TargetPos.Z);
+		}
+		const FVector Location(Frame.Location.X, Frame.Location.Y, PosZ);
+		// The capsule term used to be scaled by FVector::ForwardVector.Z, which is always 0, so it's left out
+		Segment.Start = Location + Frame.Forward * GrabRadius;
+		Segment.End = Location + Frame.Forward * GrabRange;
+	} else {
+		const float CapsuleOffset = CapsuleHalfHeight * FMath::Abs(Frame.CameraForward.Z);
+		Segment.Start = Frame.Location + Frame.CameraForward * (GrabRadius + CapsuleOffset);
+		Segment.End = Frame.Location + Frame.CameraForward * (GrabRange + CapsuleOffset);
+	}
+	return Segment;
+}
+
+// Index of the location closest to Point, INDEX_NONE if there are none
+int32 FindClosest(TArrayView<const FVector> Locations, const FVector& Point) {
+	int32 Index = INDEX_NONE;
+	double BestDistSquared = TNumericLimits<double>::Max();
+	for (int32 i = 0; i < Locations.Num(); i++) {
+		const double DistSquared = FVector::DistSquared(Locations[i], Point);
+		if (DistSquared < BestDistSquared) {
+			BestDistSquared = DistSquared;
+			Index = i;
+		}
+	}
+	return Index;
+}
+
+// Index of the relative position farthest forward from the character's aim, INDEX_NONE if there are none
+int32 FindFarthestForward(TArrayView<const FVector> PositionsFromChar) {
+	int32 Index = INDEX_NONE;
+	double BestForward = -TNumericLimits<double>::Max();
+	for (int32 i = 0; i < PositionsFromChar.Num(); i++) {
+		// Forward distance, penalized by how far to the side the object is
+		const double Forward = PositionsFromChar[i].X - FMath::Abs(PositionsFromChar[i].Y);
+		if (Forward > BestForward) {
+			BestForward = Forward;
+			Index = i;
+		}
+	}
+	return Index;
+}
+
+/**
+* Triple jump rules, like the Triple Jump from Super Mario 64:
+* - After the first jump, jumping again before JumpTimer runs out performs the second jump, which allows a longer hold.
+* - After the second jump, jumping again before JumpTimer runs out with enough speed performs the third jump,
+* which has no height control but goes much higher.
+* - Otherwise, perform the first jump.
+*/
+FJumpResult ComputeJump(const FJumpInput& Input, const FJumpRules& Rules) {
+	FJumpResult Result;
+	if (Input.JumpCount == 1 && Input.JumpTimer > 0.f) {
+		Result.Stage = EJumpStage::Second;
+		Result.JumpCount = 2;
+		Result.JumpMaxHoldTime = Rules.SecondJumpMaxHoldTime;
+		Result.bSetJumpZVelocity = false;
+		Result.JumpZVelocity = 0.f;
+	} else if (Input.JumpCount == 2 && Input.JumpTimer > 0.f && FMath::Abs(Input.RelativeVelocity.X) + FMath::Abs(Input.RelativeVelocity.Y) >= Rules.ThirdJumpMinSpeed) {
+		Result.Stage = EJumpStage::Third;
+		// Back to the first jump after this one
+		Result.JumpCount = 0;
+		Result.JumpMaxHoldTime = 0.f;
+		Result.bSetJumpZVelocity = true;
+		Result.JumpZVelocity = Rules.ThirdJumpZVelocity;
+	} else {
+		Result.Stage = EJumpStage::First;
+		Result.JumpCount = 1;
+		Result.JumpMaxHoldTime = Rules.FirstJumpMaxHoldTime;
+		Result.bSetJumpZVelocity = true;
+		Result.JumpZVelocity = Rules.FirstJumpZVelocity;
+	}
+	return Result;
+}
+
+void ComputeJumps(TArrayView<const FJumpInput> Inputs, TArrayView<FJumpResult> OutResults, const FJumpRules& Rules) {
+	check(Inputs.Num() == OutResults.Num());
+	for (int32 i = 0; i < Inputs.Num(); i++) {
+		OutResults[i] = ComputeJump(Inputs[i], Rules);
+	}
+}
+
+}
+
+// -----Benchmarks-----
+// Run without a world, the known cases are automation tests in TelekinesisMathTest.cpp
+
+// Time each kernel over random batches the size of a full grab, in nanoseconds per element
+static void BenchTelekinesisMath(const TArray<FString>& Args) {
+	using namespace TelekinesisMath;
+	const int32 Iterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100000;
+	constexpr int32 BatchSize = 10;
+	FRandomStream Random(1234);
+
+	FCharacterFrame Frame;
+	Frame.Location = Random.VRand() * 1000.f;
+	Frame.TargetPosFromChar = FVector(2000.f, 100.f, 150.f);
+	TArray<FVector> Current, Grab, Targets;
+	TArray<FJumpInput> JumpInputs;
+	TArray<FJumpResult> JumpResults;
+	for (int32 i = 0; i < BatchSize; i++) {
+		Current.Add(Random.VRand() * 400.f);
+		Grab.Add(Random.VRand() * 400.f);
+		JumpInputs.Add({ Random.RandRange(0, 2), Random.FRandRange(-0.1f, 0.2f), Random.VRand() * 800.f });
+	}
+	Targets.SetNum(BatchSize);
+	JumpResults.SetNum(BatchSize);
+
+	// Keeps the results alive so the loops don't get optimized away
+	double Sink = 0.0;
+	auto Measure = [Iterations](const TCHAR* Name, int32 ElementsPerIteration, TFunctionRef<void(int32)> Kernel) {
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < Iterations; i++) {
+			Kernel(i);
+		}
+		const double Nanoseconds = (FPlatformTime::Seconds() - StartTime) * 1e9;
+		UE_LOG(LogTemp, Display, TEXT("%-24s %8.2f ns/element"), Name, Nanoseconds / ((double)Iterations * ElementsPerIteration));
+	};
+
+	Measure(TEXT("HandleTargets"), BatchSize, [&](int32 i) {
+		Frame.bHasTarget = (i & 1) != 0;
+		ComputeHandleTargets(Frame, Current, Grab, Targets);
+		Sink += Targets[i % BatchSize].Z;
+	});
+	Measure(TEXT("GrabSweep"), 1, [&](int32 i) {
+		Frame.bHasTarget = (i & 1) != 0;
+		Sink += ComputeGrabSweep(Frame, 90.f, 400.f, 401.f).End.Z;
+	});
+	Measure(TEXT("FindClosest"), BatchSize, [&](int32 i) {
+		Sink += FindClosest(Current, Grab[i % BatchSize]);
+	});
+	Measure(TEXT("FindFarthestForward"), BatchSize, [&](int32 i) {
+		Sink += FindFarthestForward(Current);
+	});
+	Measure(TEXT("Jumps"), BatchSize, [&](int32 i) {
+		ComputeJumps(JumpInputs, JumpResults);
+		Sink += JumpResults[i % BatchSize].JumpMaxHoldTime;
+	});
+	UE_LOG(LogTemp, Verbose, TEXT("TelekinesisMath bench sink %f"), Sink);
+}
+
+static FAutoConsoleCommandWithArgs BenchTelekinesisMathCommand(
+	TEXT("ef.TelekinesisMath.Bench"),
+	TEXT("Microbenchmarks the telekinesis and jump math. Usage: ef.TelekinesisMath.Bench [Iterations=100000]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchTelekinesisMath)
+);
@@ -0,0 +1,70 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Stateless telekinesis and jump math, over plain structs and batches.
+ * AESPCharacter gathers its state into these structs and applies the results,
+ * so the kernels can be benchmarked and checked without a world (see ef.TelekinesisMath.Bench and ef.TelekinesisMath.Check).
+ */
+namespace TelekinesisMath {
+	// Character state shared by every object of a batch
+	struct FCharacterFrame {
+		FVector Location = FVector::ZeroVector;
+		FVector Forward = FVector::ForwardVector;
+		FVector Right = FVector::RightVector;
+		FVector CameraForward = FVector::ForwardVector;
+		// Target's position relative to the character, only used if bHasTarget
+		FVector TargetPosFromChar = FVector::ZeroVector;
+		bool bHasTarget = false;
+	};
+
+	// Physics handle target locations for a batch of grabbed objects.
+	// CurrentPosFromChar are the objects' current positions relative to the character, GrabPosFromChar the ones recorded when grabbing them.
+	EXTRASENSORYFUN_API void ComputeHandleTargets(const FCharacterFrame& Frame, TArrayView<const FVector> CurrentPosFromChar, TArrayView<const FVector> GrabPosFromChar, TArrayView<FVector> OutTargets);
+
+	// Start and end of the grab sphere sweep
+	struct FSweepSegment {
+		FVector Start;
+		FVector End;
+	};
+	EXTRASENSORYFUN_API FSweepSegment ComputeGrabSweep(const FCharacterFrame& Frame, float CapsuleHalfHeight, float GrabRadius, float GrabRange);
+
+	// Index of the location closest to Point, INDEX_NONE if there are none
+	EXTRASENSORYFUN_API int32 FindClosest(TArrayView<const FVector> Locations, const FVector& Point);
+	// Index of the relative position farthest forward from the character's aim, INDEX_NONE if there are none
+	EXTRASENSORYFUN_API int32 FindFarthestForward(TArrayView<const FVector> PositionsFromChar);
+
+	// -----Triple jump-----
+	enum class EJumpStage : uint8 {
+		First,
+		Second,
+		Third
+	};
+	// Tuning of the triple jump
+	struct FJumpRules {
+		float FirstJumpZVelocity = 1260.f;
+		float FirstJumpMaxHoldTime = 0.3f;
+		float SecondJumpMaxHoldTime = 0.41f;
+		float ThirdJumpZVelocity = 4200.f;
+		// Minimum horizontal speed (|X| + |Y| relative to the character) for the third jump
+		float ThirdJumpMinSpeed = 600.f;
+	};
+	struct FJumpInput {
+		int32 JumpCount;
+		float JumpTimer;
+		FVector RelativeVelocity;
+	};
+	struct FJumpResult {
+		EJumpStage Stage;
+		int32 JumpCount;
+		float JumpMaxHoldTime;
+		// The second jump keeps the current jump velocity
+		bool bSetJumpZVelocity;
+		float JumpZVelocity;
+	};
+	EXTRASENSORYFUN_API FJumpResult ComputeJump(const FJumpInput& Input, const FJumpRules& Rules = FJumpRules());
+	EXTRASENSORYFUN_API void ComputeJumps(TArrayView<const FJumpInput> Inputs, TArrayView<FJumpResult> OutResults, const FJumpRules& Rules = FJumpRules());
+}
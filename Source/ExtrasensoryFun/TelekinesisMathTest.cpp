@@ -0,0 +1,118 @@
+// by Jason Hilani
+
+
+#include "TelekinesisMath.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+using namespace TelekinesisMath;
+
+// The math runs without a world, so these can run in any context, commandlets included
+static constexpr uint32 TelekinesisMathTestFlags = EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelekinesisMathHandleTargetsTest, "ExtrasensoryFun.TelekinesisMath.HandleTargets", TelekinesisMathTestFlags)
+
+bool FTelekinesisMathHandleTargetsTest::RunTest(const FString& Parameters) {
+	FCharacterFrame Frame;
+	Frame.Location = FVector(100.f, 200.f, 300.f);
+	const FVector Current[] = { FVector(150.f, 0.f, 0.f), FVector(50.f, -20.f, 0.f) };
+	const FVector Grab[] = { FVector(150.f, 10.f, 0.f), FVector(50.f, -20.f, 0.f) };
+	FVector Targets[2];
+	ComputeHandleTargets(Frame, Current, Grab, Targets);
+	TestEqual(TEXT("Handle target without a target"), Targets[0], FVector(250.f, 210.f, 390.f));
+	TestEqual(TEXT("Handle targets are held at least 100 forward"), Targets[1], FVector(200.f, 180.f, 390.f));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelekinesisMathHandleTargetsWithTargetTest, "ExtrasensoryFun.TelekinesisMath.HandleTargetsWithTarget", TelekinesisMathTestFlags)
+
+bool FTelekinesisMathHandleTargetsWithTargetTest::RunTest(const FString& Parameters) {
+	FCharacterFrame Frame;
+	Frame.Location = FVector(100.f, 200.f, 300.f);
+	Frame.bHasTarget = true;
+	FVector Targets[3];
+
+	// Above the character, heights go from the character's up to the target's in proportion to how far forward the objects are
+	Frame.TargetPosFromChar = FVector(1000.f, 0.f, 500.f);
+	const FVector CurrentAbove[] = { FVector(500.f, 0.f, 0.f), FVector(100.f, 0.f, 0.f), FVector(2000.f, 0.f, 0.f) };
+	const FVector GrabAbove[] = { FVector(500.f, 10.f, 0.f), FVector(150.f, 0.f, 0.f), FVector(50.f, -20.f, 0.f) };
+	ComputeHandleTargets(Frame, CurrentAbove, GrabAbove, Targets);
+	TestEqual(TEXT("Handle target halfway to a target above"), Targets[0], FVector(600.f, 210.f, 442.f));
+	TestEqual(TEXT("Handle target height is clamped to the character's"), Targets[1], FVector(250.f, 200.f, 390.f));
+	TestEqual(TEXT("Handle target height is clamped to the target's past it"), Targets[2], FVector(200.f, 180.f, 692.f));
+
+	// Below the character, they go down towards the target but not below the character's feet
+	Frame.TargetPosFromChar = FVector(1000.f, 0.f, -400.f);
+	const FVector CurrentBelow[] = { FVector(500.f, 0.f, 0.f), FVector(2000.f, 0.f, 0.f) };
+	const FVector GrabBelow[] = { FVector(500.f, 0.f, 0.f), FVector(200.f, 0.f, 0.f) };
+	ComputeHandleTargets(Frame, CurrentBelow, GrabBelow, TArrayView<FVector>(Targets, 2));
+	TestEqual(TEXT("Handle target halfway to a target below"), Targets[0], FVector(600.f, 200.f, 190.f));
+	TestEqual(TEXT("Handle target depth is clamped to the character's"), Targets[1], FVector(300.f, 200.f, 90.f));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelekinesisMathGrabSweepTest, "ExtrasensoryFun.TelekinesisMath.GrabSweep", TelekinesisMathTestFlags)
+
+bool FTelekinesisMathGrabSweepTest::RunTest(const FString& Parameters) {
+	FCharacterFrame Frame;
+	Frame.Location = FVector(100.f, 200.f, 300.f);
+	Frame.CameraForward = FVector(0.f, 0.f, -1.f);
+	const FSweepSegment Sweep = ComputeGrabSweep(Frame, 90.f, 400.f, 401.f);
+	TestEqual(TEXT("Grab sweep start follows the camera with the capsule offset"), Sweep.Start, FVector(100.f, 200.f, -190.f));
+	TestEqual(TEXT("Grab sweep end follows the camera with the capsule offset"), Sweep.End, FVector(100.f, 200.f, -191.f));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelekinesisMathGrabSweepWithTargetTest, "ExtrasensoryFun.TelekinesisMath.GrabSweepWithTarget", TelekinesisMathTestFlags)
+
+bool FTelekinesisMathGrabSweepWithTargetTest::RunTest(const FString& Parameters) {
+	FCharacterFrame Frame;
+	Frame.Location = FVector(100.f, 200.f, 300.f);
+	// The camera is ignored with a target, the sweep goes along the character's forward
+	Frame.CameraForward = FVector(0.f, 0.f, -1.f);
+	Frame.bHasTarget = true;
+
+	Frame.TargetPosFromChar = FVector(800.f, 0.f, 1600.f);
+	FSweepSegment Sweep = ComputeGrabSweep(Frame, 90.f, 400.f, 401.f);
+	TestEqual(TEXT("Grab sweep start is raised towards a target above"), Sweep.Start, FVector(500.f, 200.f, 800.f));
+	TestEqual(TEXT("Grab sweep end is raised towards a target above"), Sweep.End, FVector(501.f, 200.f, 800.f));
+
+	Frame.TargetPosFromChar = FVector(1000.f, 0.f, 500.f);
+	Sweep = ComputeGrabSweep(Frame, 90.f, 400.f, 401.f);
+	TestEqual(TEXT("Grab sweep height is clamped to the character's"), Sweep.Start, FVector(500.f, 200.f, 300.f));
+
+	Frame.TargetPosFromChar = FVector(1000.f, 0.f, -400.f);
+	Sweep = ComputeGrabSweep(Frame, 90.f, 400.f, 401.f);
+	TestEqual(TEXT("Grab sweep start is lowered towards a target below"), Sweep.Start, FVector(500.f, 200.f, 140.f));
+
+	Frame.TargetPosFromChar = FVector(400.f, 0.f, -1000.f);
+	Sweep = ComputeGrabSweep(Frame, 90.f, 400.f, 401.f);
+	TestEqual(TEXT("Grab sweep depth is clamped to the character's height"), Sweep.Start, FVector(500.f, 200.f, 0.f));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelekinesisMathSelectionTest, "ExtrasensoryFun.TelekinesisMath.Selection", TelekinesisMathTestFlags)
+
+bool FTelekinesisMathSelectionTest::RunTest(const FString& Parameters) {
+	const FVector Locations[] = { FVector(0.f), FVector(10.f, 0.f, 0.f), FVector(3.f, 0.f, 0.f) };
+	TestEqual(TEXT("Closest location"), FindClosest(Locations, FVector(4.f, 0.f, 0.f)), 2);
+	TestEqual(TEXT("Closest of nothing"), FindClosest(TArrayView<const FVector>(), FVector(0.f)), (int32)INDEX_NONE);
+	const FVector Positions[] = { FVector(100.f, 0.f, 0.f), FVector(300.f, 250.f, 0.f), FVector(200.f, -50.f, 0.f) };
+	TestEqual(TEXT("Farthest forward penalizes sideways offset"), FindFarthestForward(Positions), 2);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelekinesisMathJumpsTest, "ExtrasensoryFun.TelekinesisMath.Jumps", TelekinesisMathTestFlags)
+
+bool FTelekinesisMathJumpsTest::RunTest(const FString& Parameters) {
+	TestTrue(TEXT("First jump"), ComputeJump({ 0, 0.f, FVector(0.f) }).Stage == EJumpStage::First);
+	TestTrue(TEXT("Second jump within the timer"), ComputeJump({ 1, 0.1f, FVector(0.f) }).Stage == EJumpStage::Second);
+	TestTrue(TEXT("Second jump needs the timer"), ComputeJump({ 1, 0.f, FVector(0.f) }).Stage == EJumpStage::First);
+	TestTrue(TEXT("Third jump with enough speed"), ComputeJump({ 2, 0.1f, FVector(400.f, 200.f, 0.f) }).Stage == EJumpStage::Third);
+	TestTrue(TEXT("Third jump needs speed"), ComputeJump({ 2, 0.1f, FVector(400.f, 100.f, 0.f) }).Stage == EJumpStage::First);
+	TestEqual(TEXT("Third jump resets the count"), ComputeJump({ 2, 0.1f, FVector(600.f, 0.f, 0.f) }).JumpCount, 0);
+	return true;
+}
+
+#endif
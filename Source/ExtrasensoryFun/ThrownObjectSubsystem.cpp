@@ -0,0 +1,294 @@
+// by Jason Hilani
+
+
+#include "ThrownObjectSubsystem.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMeshActor.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PhysicsActivitySubsystem.h"
+#include "ExtrasensoryFunStats.h"
+#include "PhysicsTickTimer.h"
+#include "TimerManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Thrown Objects Tick"), STAT_ThrownObjectsTick, STATGROUP_ExtrasensoryFun);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Thrown Objects In Flight"), STAT_ThrownObjectsInFlight, STATGROUP_ExtrasensoryFun);
+
+static TAutoConsoleVariable<int32> CVarThrownCCD(
+	TEXT("ef.Physics.ThrownCCD"),
+	1,
+	TEXT("Enable continuous collision on thrown objects while they're in flight."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarThrownFlightSpeed(
+	TEXT("ef.Physics.ThrownFlightSpeed"),
+	2000.f,
+	TEXT("Speed under which a thrown object is no longer considered in flight, even without an impact."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarThrownSleepSpeed(
+	TEXT("ef.Physics.ThrownSleepSpeed"),
+	20.f,
+	TEXT("Speed under which a thrown object that landed is put to sleep."),
+	ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarThrownMaxTrackTime(
+	TEXT("ef.Physics.ThrownMaxTrackTime"),
+	10.f,
+	TEXT("Seconds after which a thrown object stops being tracked, settled or not."),
+	ECVF_Default
+);
+
+// Start tracking a component that was just thrown
+void UThrownObjectSubsystem::TrackThrow(UPrimitiveComponent* Component) {
+	if (!Component || !Component->IsSimulatingPhysics()) return;
+	// Thrown again before it settled, keep the original settings
+	const int32 Index = FindIndex(Component);
+	if (Index != INDEX_NONE) {
+		ThrownObjects[Index].ThrowTime = GetWorld()->GetTimeSeconds();
+		ThrownObjects[Index].bInFlight = true;
+		if (CVarThrownCCD.GetValueOnGameThread() != 0) {
+			Component->SetUseCCD(true);
+		}
+		return;
+	}
+
+	FThrownObject& ThrownObject = ThrownObjects.AddDefaulted_GetRef();
+	ThrownObject.Component = Component;
+	ThrownObject.ThrowTime = GetWorld()->GetTimeSeconds();
+	ThrownObject.bInFlight = true;
+	ThrownObject.bPreviousUseCCD = Component->BodyInstance.bUseCCD;
+	ThrownObject.bPreviousNotifyRigidBodyCollision = Component->BodyInstance.bNotifyRigidBodyCollision;
+	if (CVarThrownCCD.GetValueOnGameThread() != 0) {
+		Component->SetUseCCD(true);
+	}
+	// The first impact ends the flight
+	Component->SetNotifyRigidBodyCollision(true);
+	Component->OnComponentHit.AddUniqueDynamic(this, &UThrownObjectSubsystem::OnThrownObjectHit);
+}
+
+// Stop tracking a component, the caller takes care of its collision settings
+void UThrownObjectSubsystem::StopTracking(UPrimitiveComponent* Component) {
+	const int32 Index = FindIndex(Component);
+	if (Index != INDEX_NONE) {
+		Restore(ThrownObjects[Index], false);
+		ThrownObjects.RemoveAtSwap(Index);
+	}
+}
+
+bool UThrownObjectSubsystem::IsTracked(const UPrimitiveComponent* Component) const {
+	return FindIndex(Component) != INDEX_NONE;
+}
+
+bool UThrownObjectSubsystem::IsInFlight(const UPrimitiveComponent* Component) const {
+	const int32 Index = FindIndex(Component);
+	return Index != INDEX_NONE && ThrownObjects[Index].bInFlight;
+}
+
+// Every tracked component, for lookups over many contacts
+void UThrownObjectSubsystem::GetTrackedComponents(TSet<const UPrimitiveComponent*>& OutComponents) const {
+	OutComponents.Reset();
+	for (const FThrownObject& ThrownObject : ThrownObjects) {
+		if (const UPrimitiveComponent* Component = ThrownObject.Component.Get()) {
+			OutComponents.Add(Component);
+		}
+	}
+}
+
+int32 UThrownObjectSubsystem::FindIndex(const UPrimitiveComponent* Component) const {
+	return ThrownObjects.IndexOfByPredicate([Component](const FThrownObject& ThrownObject) {
+		return ThrownObject.Component.Get() == Component;
+	});
+}
+
+// Continuous collision off, the object is now only settling
+void UThrownObjectSubsystem::EndFlight(FThrownObject& ThrownObject) {
+	ThrownObject.bInFlight = false;
+	if (UPrimitiveComponent* Component = ThrownObject.Component.Get()) {
+		Component->SetUseCCD(ThrownObject.bPreviousUseCCD);
+	}
+}
+
+// Settled objects also go back to their collision settings from before their first grab
+void UThrownObjectSubsystem::Restore(FThrownObject& ThrownObject, bool bRestoreCollision) {
+	UPrimitiveComponent* Component = ThrownObject.Component.Get();
+	if (!Component) return;
+	Component->SetUseCCD(ThrownObject.bPreviousUseCCD);
+	Component->OnComponentHit.RemoveDynamic(this, &UThrownObjectSubsystem::OnThrownObjectHit);
+	if (!bRestoreCollision) return;
+
+	const UPhysicsActivitySubsystem* PhysicsActivity = GetWorld()->GetSubsystem<UPhysicsActivitySubsystem>();
+	if (const CollisionProfiles::FSavedCollision* Saved = PhysicsActivity ? PhysicsActivity->GetSavedCollision(Component) : nullptr) {
+		CollisionProfiles::Restore(Component, *Saved);
+	} else if (!ThrownObject.bPreviousNotifyRigidBodyCollision) {
+		Component->SetNotifyRigidBodyCollision(false);
+	}
+}
+
+// The first impact ends the flight
+void UThrownObjectSubsystem::OnThrownObjectHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit) {
+	const int32 Index = FindIndex(HitComp);
+	if (Index != INDEX_NONE && ThrownObjects[Index].bInFlight) {
+		EndFlight(ThrownObjects[Index]);
+	}
+}
+
+/**
+* End flights that slowed down, put settled objects to sleep and stop tracking them.
+* Objects that are destroyed or stop simulating drop out of the list.
+*/
+void UThrownObjectSubsystem::Tick(float DeltaTime) {
+	EF_SCOPE_CYCLE_COUNTER(STAT_ThrownObjectsTick);
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float FlightSpeedSquared = FMath::Square(CVarThrownFlightSpeed.GetValueOnGameThread());
+	const float SleepSpeedSquared = FMath::Square(CVarThrownSleepSpeed.GetValueOnGameThread());
+	const float MaxTrackTime = CVarThrownMaxTrackTime.GetValueOnGameThread();
+	int32 InFlight = 0;
+
+	for (int32 i = ThrownObjects.Num() - 1; i >= 0; i--) {
+		FThrownObject& ThrownObject = ThrownObjects[i];
+		UPrimitiveComponent* Component = ThrownObject.Component.Get();
+		if (!Component || !Component->IsSimulatingPhysics()) {
+			Restore(ThrownObject, true);
+			ThrownObjects.RemoveAtSwap(i);
+			continue;
+		}
+		const float SpeedSquared = Component->GetPhysicsLinearVelocity().SizeSquared();
+		if (ThrownObject.bInFlight && SpeedSquared < FlightSpeedSquared) {
+			EndFlight(ThrownObject);
+		}
+		if (ThrownObject.bInFlight) {
+			InFlight++;
+			continue;
+		}
+		const bool bSettled = SpeedSquared < SleepSpeedSquared && Component->GetPhysicsAngularVelocityInDegrees().SizeSquared() < SleepSpeedSquared;
+		if (bSettled || !Component->IsAnyRigidBodyAwake() || Now - ThrownObject.ThrowTime > MaxTrackTime) {
+			if (bSettled) {
+				Component->PutAllRigidBodiesToSleep();
+			}
+			Restore(ThrownObject, true);
+			ThrownObjects.RemoveAtSwap(i);
+		}
+	}
+	SET_DWORD_STAT(STAT_ThrownObjectsInFlight, InFlight);
+}
+
+TStatId UThrownObjectSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UThrownObjectSubsystem, STATGROUP_Tickables);
+}
+
+// -----Console commands-----
+
+// State of a tunnelling test run, shared between its phases
+struct FTunnellingTest {
+	TWeakObjectPtr<UWorld> World;
+	int32 NumProps;
+	float Speed;
+	int32 Phase = 0;
+	bool bPreviousUseFixedTimeStep;
+	double PreviousFixedDeltaTime;
+	int32 PreviousThrownCCD;
+	TArray<TWeakObjectPtr<AStaticMeshActor>> Actors;
+	FPhysicsTickTimer PhysicsTimer;
+};
+
+static const float TunnellingTestFPS[] = { 30.f, 60.f, 120.f };
+static const TCHAR* TunnellingTestModes[] = { TEXT("No CCD"), TEXT("Flight CCD"), TEXT("Always-on CCD") };
+static constexpr int32 TunnellingTestModeCount = UE_ARRAY_COUNT(TunnellingTestModes);
+static constexpr int32 TunnellingTestPhases = UE_ARRAY_COUNT(TunnellingTestFPS) * TunnellingTestModeCount;
+
+// Launch the props of a phase at a 5 cm thick wall, far above the level
+static void StartTunnellingPhase(TSharedRef<FTunnellingTest> Test) {
+	UWorld* World = Test->World.Get();
+	UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!World || !Cube) return;
+	const float FPS = TunnellingTestFPS[Test->Phase / TunnellingTestModeCount];
+	const int32 Mode = Test->Phase % TunnellingTestModeCount;
+	FApp::SetFixedDeltaTime(1.0 / FPS);
+	IConsoleManager::Get().FindConsoleVariable(TEXT("ef.Physics.ThrownCCD"))->Set(Mode == 1 ? 1 : 0);
+
+	const FVector WallLocation(0.f, 0.f, 50000.f);
+	auto SpawnCube = [World, Cube, Test](const FVector& Location, const FVector& Scale, bool bSimulate) {
+		AStaticMeshActor* Actor = World->SpawnActor<AStaticMeshActor>(Location, FRotator::ZeroRotator);
+		UStaticMeshComponent* Mesh = Actor->GetStaticMeshComponent();
+		Mesh->SetMobility(EComponentMobility::Movable);
+		Mesh->SetStaticMesh(Cube);
+		Actor->SetActorScale3D(Scale);
+		Mesh->SetCollisionProfileName(bSimulate ? TEXT("PhysicsActor") : TEXT("BlockAll"));
+		Mesh->SetSimulatePhysics(bSimulate);
+		Mesh->SetEnableGravity(false);
+		Test->Actors.Add(Actor);
+		return Mesh;
+	};
+	SpawnCube(WallLocation, FVector(0.05f, 40.f, 40.f), false);
+
+	// 20 cm cubes on a grid, 1000 units in front of the wall
+	UThrownObjectSubsystem* ThrownObjects = World->GetSubsystem<UThrownObjectSubsystem>();
+	const int32 Side = FMath::CeilToInt(FMath::Sqrt((float)Test->NumProps));
+	const float Spacing = 3600.f / Side;
+	for (int32 i = 0; i < Test->NumProps; i++) {
+		const FVector Location = WallLocation + FVector(-1000.f, (i % Side - Side / 2) * Spacing, (i / Side - Side / 2) * Spacing);
+		UStaticMeshComponent* Prop = SpawnCube(Location, FVector(0.2f), true);
+		Prop->SetUseCCD(Mode == 2);
+		Prop->SetPhysicsLinearVelocity(FVector(Test->Speed, 0.f, 0.f));
+		if (Mode == 1 && ThrownObjects) {
+			ThrownObjects->TrackThrow(Prop);
+		}
+	}
+	Test->PhysicsTimer.Reset();
+
+	// Count the props past the wall once they had time to fly twice the distance
+	FTimerHandle Unused;
+	World->GetTimerManager().SetTimer(Unused, [Test, FPS, Mode, WallLocation]() {
+		int32 Tunnelled = 0;
+		for (const TWeakObjectPtr<AStaticMeshActor>& Actor : Test->Actors) {
+			if (Actor.IsValid() && Actor->GetStaticMeshComponent()->IsSimulatingPhysics() && Actor->GetActorLocation().X > WallLocation.X) {
+				Tunnelled++;
+			}
+			if (Actor.IsValid()) {
+				Actor->Destroy();
+			}
+		}
+		Test->Actors.Reset();
+		UE_LOG(LogTemp, Display, TEXT("  %3.0f FPS, %-14s %4d/%d tunnelled, %.3f ms physics per frame"), FPS, TunnellingTestModes[Mode], Tunnelled, Test->NumProps, Test->PhysicsTimer.GetAverageMs());
+
+		Test->Phase++;
+		if (Test->Phase < TunnellingTestPhases) {
+			StartTunnellingPhase(Test);
+			return;
+		}
+		// Done, put everything back
+		FApp::SetUseFixedTimeStep(Test->bPreviousUseFixedTimeStep);
+		FApp::SetFixedDeltaTime(Test->PreviousFixedDeltaTime);
+		IConsoleManager::Get().FindConsoleVariable(TEXT("ef.Physics.ThrownCCD"))->Set(Test->PreviousThrownCCD);
+		Test->PhysicsTimer.Stop();
+	}, 2000.f / Test->Speed + 0.25f, false);
+}
+
+/**
+* Fire Props cubes at Speed into a 5 cm wall, without continuous collision, with it only in flight and with it always on,
+* at 30, 60 and 120 fixed FPS. Reports how many went through and the physics tick time.
+*/
+static void TunnellingTest(const TArray<FString>& Args, UWorld* World) {
+	TSharedRef<FTunnellingTest> Test = MakeShared<FTunnellingTest>();
+	if (!Test->PhysicsTimer.Start(World)) return;
+	Test->World = World;
+	Test->NumProps = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100;
+	Test->Speed = Args.Num() > 1 ? FMath::Max(FCString::Atof(*Args[1]), 100.f) : 12000.f;
+	Test->bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+	Test->PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	Test->PreviousThrownCCD = CVarThrownCCD.GetValueOnGameThread();
+	FApp::SetUseFixedTimeStep(true);
+
+	UE_LOG(LogTemp, Display, TEXT("Tunnelling test: %d props at %.0f units/s"), Test->NumProps, Test->Speed);
+	StartTunnellingPhase(Test);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs TunnellingTestCommand(
+	TEXT("ef.Physics.TunnellingTest"),
+	TEXT("Fires props at a thin wall at several frame rates and reports tunnelling and physics time with and without continuous collision. Usage: ef.Physics.TunnellingTest [Props=100] [Speed=12000]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&TunnellingTest)
+);
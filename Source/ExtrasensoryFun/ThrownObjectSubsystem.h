@@ -0,0 +1,55 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ThrownObjectSubsystem.generated.h"
+
+/**
+ * Tracks thrown objects from the throw until they settle, so the expensive physics settings only apply while they're needed.
+ * Throws are fast enough to tunnel through thin geometry, so continuous collision is on from the throw until the first impact
+ * or until the object slows down below ef.Physics.ThrownFlightSpeed.
+ * After that the object settles with continuous collision off, and is put to sleep as soon as it's slow enough
+ * instead of waiting for the solver's sleep counter.
+ * Each object gets its original settings back once it's done, including its collision settings from before it was first grabbed.
+ */
+UCLASS()
+class EXTRASENSORYFUN_API UThrownObjectSubsystem : public UTickableWorldSubsystem {
+	GENERATED_BODY()
+
+public:
+	// Start tracking a component that was just thrown
+	void TrackThrow(UPrimitiveComponent* Component);
+	// Stop tracking a component and restore its continuous collision, e.g. when it's grabbed again
+	void StopTracking(UPrimitiveComponent* Component);
+
+	bool IsTracked(const UPrimitiveComponent* Component) const;
+	bool IsInFlight(const UPrimitiveComponent* Component) const;
+	int32 GetNumTracked() const { return ThrownObjects.Num(); }
+	// Every tracked component, for lookups over many contacts
+	void GetTrackedComponents(TSet<const UPrimitiveComponent*>& OutComponents) const;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	// A thrown object and the settings to restore
+	struct FThrownObject {
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		double ThrowTime;
+		// Until the first impact or until it slows down
+		bool bInFlight;
+		bool bPreviousUseCCD;
+		bool bPreviousNotifyRigidBodyCollision;
+	};
+	TArray<FThrownObject> ThrownObjects;
+
+	int32 FindIndex(const UPrimitiveComponent* Component) const;
+	// Switch from flight to settling
+	void EndFlight(FThrownObject& ThrownObject);
+	void Restore(FThrownObject& ThrownObject, bool bRestoreCollision);
+
+	UFUNCTION()
+	void OnThrownObjectHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+};
@@ -0,0 +1,18 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class ExtrasensoryFunLoadingScreen : ModuleRules
+{
+	public ExtrasensoryFunLoadingScreen(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		// The game module includes the module interface
+		PublicIncludePaths.Add(ModuleDirectory);
+
+		PublicDependencyModuleNames.AddRange(new string[] { "Core" });
+
+		PrivateDependencyModuleNames.AddRange(new string[] { "CoreUObject", "Engine", "MoviePlayer", "Slate", "SlateCore" });
+	}
+}
@@ -0,0 +1,76 @@
+// by Jason Hilani
+
+#include "ExtrasensoryFunLoadingScreen.h"
+#include "MoviePlayer.h"
+#include "Misc/PackageName.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/Layout/SBorder.h"
+#include "Widgets/SBoxPanel.h"
+#include "Widgets/Text/STextBlock.h"
+#include "Widgets/Images/SThrobber.h"
+#include "Styling/CoreStyle.h"
+
+/**
+ * The loading screen's widget.
+ * It's drawn on the loading thread, so it only uses Slate's core style and no UObjects or assets.
+ */
+class SExtrasensoryFunLoadingScreen : public SCompoundWidget {
+public:
+	SLATE_BEGIN_ARGS(SExtrasensoryFunLoadingScreen) {}
+		SLATE_ARGUMENT(FString, MapName)
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs) {
+		ChildSlot
+		[
+			SNew(SBorder)
+			.BorderImage(FCoreStyle::Get().GetBrush("BlackBrush"))
+			.HAlign(HAlign_Right)
+			.VAlign(VAlign_Bottom)
+			.Padding(FMargin(60.f))
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.VAlign(VAlign_Center)
+				.Padding(FMargin(0.f, 0.f, 20.f, 0.f))
+				[
+					SNew(STextBlock)
+					.Text(FText::FromString(FString::Printf(TEXT("Loading %s"), *FPackageName::GetShortName(InArgs._MapName))))
+					.Font(FCoreStyle::GetDefaultFontStyle("Regular", 24))
+				]
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.VAlign(VAlign_Center)
+				[
+					SNew(SThrobber)
+				]
+			]
+		];
+	}
+};
+
+// Loading screen module, see IExtrasensoryFunLoadingScreenModule
+class FExtrasensoryFunLoadingScreenModule : public IExtrasensoryFunLoadingScreenModule {
+public:
+	virtual bool IsGameModule() const override {
+		return true;
+	}
+
+	virtual bool IsAvailable() const override {
+		return !IsRunningDedicatedServer() && IsMoviePlayerEnabled() && GetMoviePlayer() && GetMoviePlayer()->IsInitialized();
+	}
+
+	// Hand the widget to the movie player, which plays it when the map load starts and stops it once it's done
+	virtual void StartLoadingScreen(const FString& MapName, float MinimumDisplayTime) override {
+		if (!IsAvailable()) return;
+		FLoadingScreenAttributes LoadingScreen;
+		LoadingScreen.bAutoCompleteWhenLoadingCompletes = true;
+		LoadingScreen.bMoviesAreSkippable = false;
+		LoadingScreen.MinimumLoadingScreenDisplayTime = MinimumDisplayTime;
+		LoadingScreen.WidgetLoadingScreen = SNew(SExtrasensoryFunLoadingScreen).MapName(MapName);
+		GetMoviePlayer()->SetupLoadingScreen(LoadingScreen);
+	}
+};
+
+IMPLEMENT_GAME_MODULE(FExtrasensoryFunLoadingScreenModule, ExtrasensoryFunLoadingScreen);
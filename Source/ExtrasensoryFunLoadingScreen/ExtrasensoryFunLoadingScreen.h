@@ -0,0 +1,25 @@
+// by Jason Hilani
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Modules/ModuleInterface.h"
+#include "Modules/ModuleManager.h"
+
+/**
+ * Loading screen shown during map transitions.
+ * It's a plain Slate widget played by the movie player, which draws it on the loading thread
+ * while the game thread is blocked loading the map, and takes it down once the map is loaded.
+ * Loaded before the engine starts, so the movie player is ready by the first transition.
+ */
+class IExtrasensoryFunLoadingScreenModule : public IModuleInterface {
+public:
+	static IExtrasensoryFunLoadingScreenModule& Get() {
+		return FModuleManager::LoadModuleChecked<IExtrasensoryFunLoadingScreenModule>("ExtrasensoryFunLoadingScreen");
+	}
+
+	// Whether there's a movie player to show the loading screen, there's none on dedicated servers or with -nullrhi
+	virtual bool IsAvailable() const = 0;
+	// Show the loading screen for the next map load, call before it starts (on PreLoadMap)
+	virtual void StartLoadingScreen(const FString& MapName, float MinimumDisplayTime) = 0;
+};
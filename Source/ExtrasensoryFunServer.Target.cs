@@ -0,0 +1,16 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+public class ExtrasensoryFunServerTarget : TargetRules
+{
+	public ExtrasensoryFunServerTarget( TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Server;
+		DefaultBuildSettings = BuildSettingsVersion.V2;
+		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_1;
+		ExtraModuleNames.Add("ExtrasensoryFun");
+		ExtraModuleNames.Add("ExtrasensoryFunLoadingScreen");
+	}
+}